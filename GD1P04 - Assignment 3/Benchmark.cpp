@@ -0,0 +1,320 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Benchmark.cpp
+// Description    : argument parsing, offscreen target and the json report of the benchmark mode
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "Benchmark.h"
+#include "GLState.h"
+#include "ProgramCache.h"
+#include "ShaderLoader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// nearest rank percentile of sorted values
+static float Percentile(const std::vector<float>& Sorted, int Percent)
+{
+	if (Sorted.empty())
+	{
+		return 0.0f;
+	}
+	size_t Rank = (Sorted.size() * Percent + 99) / 100;
+	return Sorted[std::max(Rank, (size_t)1) - 1];
+}
+
+// {"min":..,"avg":..,"p50":..,"p90":..,"p95":..,"p99":..,"max":..}
+static std::string SummaryJson(std::vector<float> Values)
+{
+	std::sort(Values.begin(), Values.end());
+	double Sum = 0.0;
+	for (size_t i = 0; i < Values.size(); i++)
+	{
+		Sum += Values[i];
+	}
+
+	std::ostringstream Out;
+	Out << "{\"samples\":" << Values.size()
+		<< ",\"min\":" << (Values.empty() ? 0.0f : Values.front())
+		<< ",\"avg\":" << (Values.empty() ? 0.0 : Sum / Values.size())
+		<< ",\"p50\":" << Percentile(Values, 50)
+		<< ",\"p90\":" << Percentile(Values, 90)
+		<< ",\"p95\":" << Percentile(Values, 95)
+		<< ",\"p99\":" << Percentile(Values, 99)
+		<< ",\"max\":" << (Values.empty() ? 0.0f : Values.back()) << "}";
+	return Out.str();
+}
+
+static std::string JsonString(const char* Text)
+{
+	std::string Result = "\"";
+	for (const char* c = (Text != nullptr) ? Text : ""; *c != '\0'; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			Result += '\\';
+		}
+		Result += *c;
+	}
+	return Result + "\"";
+}
+
+bool Benchmark::ParseArguments(int ArgCount, char** Args, BenchmarkSettings& Settings)
+{
+	for (int i = 1; i < ArgCount; i++)
+	{
+		bool HasValue = (i + 1 < ArgCount);
+		if (strcmp(Args[i], "--benchmark") == 0)
+		{
+			Settings.Enabled = true;
+		}
+		else if (strcmp(Args[i], "--frames") == 0 && HasValue)
+		{
+			Settings.Frames = std::max(atoi(Args[++i]), 1);
+		}
+		else if (strcmp(Args[i], "--warmup") == 0 && HasValue)
+		{
+			Settings.WarmupFrames = std::max(atoi(Args[++i]), 0);
+		}
+		else if (strcmp(Args[i], "--width") == 0 && HasValue)
+		{
+			Settings.Width = std::max(atoi(Args[++i]), 1);
+		}
+		else if (strcmp(Args[i], "--height") == 0 && HasValue)
+		{
+			Settings.Height = std::max(atoi(Args[++i]), 1);
+		}
+		else if (strcmp(Args[i], "--samples") == 0 && HasValue)
+		{
+			Settings.Samples = std::max(atoi(Args[++i]), 0);
+		}
+		else if (strcmp(Args[i], "--step") == 0 && HasValue)
+		{
+			// at least a millisecond, the frame count of a path run is its duration over the step (minimum first so nan is caught too)
+			Settings.Step = std::max(0.001f, (float)atof(Args[++i]));
+		}
+		else if (strcmp(Args[i], "--output") == 0 && HasValue)
+		{
+			Settings.OutputPath = Args[++i];
+		}
+		else if (strcmp(Args[i], "--path") == 0 && HasValue)
+		{
+			Settings.PathFile = Args[++i];
+		}
+		else if (strcmp(Args[i], "--defines") == 0 && HasValue)
+		{
+			Settings.ShaderDefines = Args[++i];
+		}
+		else if (strcmp(Args[i], "--shading-sweep") == 0)
+		{
+			Settings.ShadingSweep = true;
+		}
+		else
+		{
+			std::cout << "Unknown argument: " << Args[i] << std::endl;
+			std::cout << "Usage: --benchmark [--frames N] [--warmup N] [--width W] [--height H] [--samples S] [--step SECONDS] [--output FILE] [--path FILE] [--defines \"A B=1\"] [--shading-sweep]" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+Benchmark::Benchmark(const BenchmarkSettings& Settings)
+{
+	this->Settings = Settings;
+
+	// without a frame count the run is as long as the path
+	if (this->Settings.PathFile.empty() == false)
+	{
+		Path.Load(this->Settings.PathFile);
+	}
+	if (this->Settings.Frames <= 0)
+	{
+		this->Settings.Frames = Path.IsEmpty() ? 600 : (int)ceil(Path.GetDuration() / this->Settings.Step) + 1;
+	}
+	CPUTimes.reserve(this->Settings.Frames);
+	CPUSegments.reserve(this->Settings.Frames);
+
+	// renderbuffers are enough, the result is never read back
+	glGenRenderbuffers(1, &ColorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, ColorBuffer);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, Settings.Samples, GL_RGBA8, Settings.Width, Settings.Height);
+	glGenRenderbuffers(1, &DepthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, DepthBuffer);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, Settings.Samples, GL_DEPTH24_STENCIL8, Settings.Width, Settings.Height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &FBO);
+	GLState::BindFramebuffer(FBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ColorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, DepthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Benchmark target is incomplete (" << Settings.Width << "x" << Settings.Height << ", "
+			<< Settings.Samples << " samples)" << std::endl;
+	}
+	GLState::BindFramebuffer(0);
+
+	std::cout << "Benchmark: " << this->Settings.Frames << " frames (+" << Settings.WarmupFrames << " warmup) at "
+		<< Settings.Width << "x" << Settings.Height << ", step " << Settings.Step << " s, on " << glGetString(GL_RENDERER) << std::endl;
+}
+
+Benchmark::~Benchmark()
+{
+	// deleting the bound framebuffer would put 0 back without the shadow knowing
+	GLState::BindFramebuffer(0);
+	glDeleteFramebuffers(1, &FBO);
+	glDeleteRenderbuffers(1, &ColorBuffer);
+	glDeleteRenderbuffers(1, &DepthBuffer);
+}
+
+const BenchmarkSettings& Benchmark::GetSettings() const
+{
+	return Settings;
+}
+
+GLuint Benchmark::GetFramebuffer() const
+{
+	return FBO;
+}
+
+float Benchmark::GetTime() const
+{
+	return Frame * Settings.Step;
+}
+
+bool Benchmark::IsWarmup() const
+{
+	return Frame < Settings.WarmupFrames;
+}
+
+bool Benchmark::IsFinished() const
+{
+	return Frame >= Settings.WarmupFrames + Settings.Frames;
+}
+
+bool Benchmark::UpdateCamera(camera& Camera, uint8_t& Flags)
+{
+	// the warmup runs on the start of the path
+	if (Path.IsEmpty() == false)
+	{
+		Path.Apply(IsWarmup() ? 0.0f : (Frame - Settings.WarmupFrames) * Settings.Step, Camera, Flags, Segment);
+		return true;
+	}
+
+	float Angle = GetTime() * 0.2f;
+	glm::vec3 Position = glm::vec3(cos(Angle) * 60.0f, 25.0f, sin(Angle) * 60.0f);
+	Camera.SetView(Position, glm::vec3(0.0f, 5.0f, 0.0f) - Position);
+	return false;
+}
+
+const char* Benchmark::GetFrameName() const
+{
+	return Path.IsEmpty() ? "Frame" : Path.GetSegmentName(Segment);
+}
+
+void Benchmark::BindTarget() const
+{
+	GLState::BindFramebuffer(FBO);
+	GLState::Viewport(0, 0, Settings.Width, Settings.Height);
+}
+
+void Benchmark::EndFrame(double CPUMilliseconds)
+{
+	if (IsWarmup() == false)
+	{
+		CPUTimes.push_back((float)CPUMilliseconds);
+		CPUSegments.push_back(Segment);
+	}
+	Frame++;
+}
+
+void Benchmark::AddShadingSample(const ShadingSample& Sample)
+{
+	ShadingSamples.push_back(Sample);
+}
+
+bool Benchmark::WriteReport(const GPUProfiler* Profiler) const
+{
+	std::ostringstream Report;
+	Report << "{" << std::endl;
+	Report << "  \"renderer\": " << JsonString((const char*)glGetString(GL_RENDERER)) << "," << std::endl;
+	Report << "  \"version\": " << JsonString((const char*)glGetString(GL_VERSION)) << "," << std::endl;
+	Report << "  \"width\": " << Settings.Width << ", \"height\": " << Settings.Height << ", \"samples\": " << Settings.Samples << "," << std::endl;
+	Report << "  \"frames\": " << Settings.Frames << ", \"warmup_frames\": " << Settings.WarmupFrames << ", \"step\": " << Settings.Step << "," << std::endl;
+	Report << "  \"shader_startup_ms\": " << ShaderLoader::GetStartupTime() << ", \"program_cache_hits\": " << ProgramCache::GetHits()
+		<< ", \"program_cache_rejected\": " << ProgramCache::GetRejected() << "," << std::endl;
+	// every root scope is a whole frame (one per path segment)
+	std::vector<GPUScopeStats> Scopes = Profiler->GetStats();
+	std::vector<float> GPUTimes;
+	for (size_t i = 0; i < Scopes.size(); i++)
+	{
+		if (Scopes[i].Depth == 0)
+		{
+			std::vector<float> Samples = Profiler->GetSamples(Scopes[i].Path);
+			GPUTimes.insert(GPUTimes.end(), Samples.begin(), Samples.end());
+		}
+	}
+
+	Report << "  \"path\": " << JsonString(Settings.PathFile.c_str()) << "," << std::endl;
+	Report << "  \"shader_defines\": " << JsonString(Settings.ShaderDefines.c_str()) << "," << std::endl;
+	Report << "  \"cpu_ms\": " << SummaryJson(CPUTimes) << "," << std::endl;
+	Report << "  \"gpu_ms\": " << SummaryJson(GPUTimes) << "," << std::endl;
+	Report << "  \"gpu_dropped_frames\": " << Profiler->GetDroppedFrames() << "," << std::endl;
+
+	// the same per path segment, a regression usually belongs to one part of the flythrough
+	Report << "  \"segments\": {";
+	for (int s = 0; s < Path.GetSegmentCount(); s++)
+	{
+		std::vector<float> SegmentTimes;
+		for (size_t i = 0; i < CPUTimes.size(); i++)
+		{
+			if (CPUSegments[i] == s)
+			{
+				SegmentTimes.push_back(CPUTimes[i]);
+			}
+		}
+		Report << (s == 0 ? "" : ",") << std::endl << "    " << JsonString(Path.GetSegmentName(s)) << ": {\"cpu_ms\": "
+			<< SummaryJson(SegmentTimes) << ", \"gpu_ms\": " << SummaryJson(Profiler->GetSamples(Path.GetSegmentName(s))) << "}";
+	}
+	Report << std::endl << "  }," << std::endl;
+
+	// forward against deferred, empty without --shading-sweep
+	Report << "  \"shading_sweep\": [";
+	for (size_t i = 0; i < ShadingSamples.size(); i++)
+	{
+		Report << (i == 0 ? "" : ",") << std::endl << "    {\"lights\": " << ShadingSamples[i].Lights << ", \"layers\": " << ShadingSamples[i].Layers
+			<< ", \"forward_ms\": " << ShadingSamples[i].ForwardMs << ", \"deferred_ms\": " << ShadingSamples[i].DeferredMs << "}";
+	}
+	Report << std::endl << "  ]," << std::endl;
+
+	// every pass and object scope, for finding which one regressed
+	Report << "  \"gpu_scopes\": {";
+	for (size_t i = 0; i < Scopes.size(); i++)
+	{
+		Report << (i == 0 ? "" : ",") << std::endl << "    " << JsonString(Scopes[i].Path.c_str()) << ": "
+			<< SummaryJson(Profiler->GetSamples(Scopes[i].Path));
+	}
+	Report << std::endl << "  }" << std::endl << "}" << std::endl;
+
+	std::cout << Report.str();
+	std::ofstream File(Settings.OutputPath, std::ios::out | std::ios::trunc);
+	if (!File.good())
+	{
+		std::cout << "Cannot write file:  " << Settings.OutputPath << std::endl;
+		return false;
+	}
+	File << Report.str();
+	std::cout << "Benchmark written to " << Settings.OutputPath << std::endl;
+	return true;
+}
@@ -0,0 +1,94 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Benchmark.h
+// Description    : class file for the benchmark mode, fixed step offscreen frames reported as json
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glm.hpp>
+#include <string>
+#include <vector>
+#include "camera.h"
+#include "GPUProfiler.h"
+#include "CameraPath.h"
+
+// read from the command line, e.g. --benchmark --path Resources/CameraPaths/Valley.campath --width 1920 --height 1080
+struct BenchmarkSettings
+{
+	bool Enabled = false;
+	int Frames = 0;			// 0 runs the whole camera path, or 600 frames without one
+	int WarmupFrames = 60;	// not measured, caches and the upload ring settle first
+	int Width = 1280;
+	int Height = 720;
+	int Samples = 4;		// same as the window
+	float Step = 1.0f / 60.0f;
+	std::string OutputPath = "Benchmark.json";
+	std::string PathFile;	// recorded camera path, the built in orbit without one
+	std::string ShaderDefines;	// added to every program, e.g. VERTEX_NORMAL_MATRIX to time the old vertex path
+	bool ShadingSweep = false;	// forward against deferred shading over light counts and overdraw before the run
+};
+
+// gpu time of one point of the shading sweep, in milliseconds
+struct ShadingSample
+{
+	int Lights;
+	int Layers;		// walls of spheres behind each other, about the depth complexity of every pixel
+	float ForwardMs;
+	float DeferredMs;
+};
+
+class Benchmark
+{
+public:
+	// false (after printing the usage) when an argument is unknown or has no value
+	static bool ParseArguments(int ArgCount, char** Args, BenchmarkSettings& Settings);
+
+	Benchmark(const BenchmarkSettings& Settings);
+	~Benchmark();
+
+	const BenchmarkSettings& GetSettings() const;
+	GLuint GetFramebuffer() const;
+
+	// simulation time of the current frame, advances by the fixed step only
+	float GetTime() const;
+	bool IsWarmup() const;
+	bool IsFinished() const;
+
+	// same camera every run, the recorded path (true, Flags holds its render toggles) or a slow orbit over the terrain
+	bool UpdateCamera(camera& Camera, uint8_t& Flags);
+
+	// root scope name for the gpu profiler, the current path segment
+	const char* GetFrameName() const;
+
+	// binds the offscreen target, everything of the frame is drawn into it
+	void BindTarget() const;
+	void EndFrame(double CPUMilliseconds);
+
+	// written to the report next to the frame times
+	void AddShadingSample(const ShadingSample& Sample);
+
+	// cpu and gpu frame time percentiles plus the gpu time of every profiler scope
+	bool WriteReport(const GPUProfiler* Profiler) const;
+
+private:
+	BenchmarkSettings Settings;
+	int Frame = 0;
+	std::vector<float> CPUTimes;
+	std::vector<int> CPUSegments;
+	std::vector<ShadingSample> ShadingSamples;
+
+	CameraPath Path;
+	int Segment = 0;
+
+	GLuint FBO = 0;
+	GLuint ColorBuffer = 0;
+	GLuint DepthBuffer = 0;
+};
@@ -0,0 +1,192 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : BinaryCache.cpp
+// Description    : hashing, file writing and memory mapping used by the derived-data caches
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "BinaryCache.h"
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+uint64_t BinaryCache::Hash(const void* Data, size_t Size, uint64_t Seed)
+{
+	const unsigned char* Bytes = static_cast<const unsigned char*>(Data);
+	uint64_t Result = Seed;
+	for (size_t i = 0; i < Size; i++)
+	{
+		Result ^= Bytes[i];
+		Result *= 1099511628211ull;
+	}
+	return Result;
+}
+
+bool BinaryCache::EnsureDirectory(const char* Path)
+{
+#ifdef _WIN32
+	return (_mkdir(Path) == 0 || errno == EEXIST);
+#else
+	return (mkdir(Path, 0755) == 0 || errno == EEXIST);
+#endif
+}
+
+std::string BinaryCache::MakePath(const char* Prefix, uint64_t Key, const char* Extension)
+{
+	std::ostringstream Path;
+	Path << CacheDirectory << Prefix << std::hex << std::setw(16) << std::setfill('0') << Key << Extension;
+	return Path.str();
+}
+
+bool BinaryCache::WriteFile(const std::string& Path, const std::vector<Block>& Blocks)
+{
+	EnsureDirectory(CacheDirectory);
+
+	std::string TempPath = Path + ".tmp";
+	std::ofstream File(TempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!File.good())
+	{
+		std::cout << "Cannot write cache file: " << TempPath << std::endl;
+		return false;
+	}
+
+	for (size_t i = 0; i < Blocks.size(); i++)
+	{
+		File.write(static_cast<const char*>(Blocks[i].Data), Blocks[i].Size);
+	}
+	File.close();
+	if (File.fail())
+	{
+		std::remove(TempPath.c_str());
+		return false;
+	}
+
+	// rename does not replace an existing file on every platform
+	std::remove(Path.c_str());
+	return (std::rename(TempPath.c_str(), Path.c_str()) == 0);
+}
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& Path)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+	{
+		CloseHandle(File);
+		return false;
+	}
+
+	HANDLE Mapping = CreateFileMappingA(File, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (Mapping == NULL)
+	{
+		CloseHandle(File);
+		return false;
+	}
+
+	void* View = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (View == NULL)
+	{
+		CloseHandle(Mapping);
+		CloseHandle(File);
+		return false;
+	}
+
+	FileHandle = File;
+	MappingHandle = Mapping;
+	Data = static_cast<const unsigned char*>(View);
+	Size = (size_t)FileSize.QuadPart;
+#else
+	int File = open(Path.c_str(), O_RDONLY);
+	if (File < 0)
+	{
+		return false;
+	}
+
+	struct stat FileInfo;
+	if (fstat(File, &FileInfo) != 0 || FileInfo.st_size == 0)
+	{
+		close(File);
+		return false;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	void* View = mmap(nullptr, (size_t)FileInfo.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+	close(File);
+	if (View == MAP_FAILED)
+	{
+		return false;
+	}
+
+	Data = static_cast<const unsigned char*>(View);
+	Size = (size_t)FileInfo.st_size;
+#endif
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (Data == nullptr)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(Data);
+	CloseHandle(MappingHandle);
+	CloseHandle(FileHandle);
+	MappingHandle = nullptr;
+	FileHandle = nullptr;
+#else
+	munmap(const_cast<unsigned char*>(Data), Size);
+#endif
+	Data = nullptr;
+	Size = 0;
+}
+
+const unsigned char* MappedFile::GetData() const
+{
+	return Data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return Size;
+}
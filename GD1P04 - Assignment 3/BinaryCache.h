@@ -0,0 +1,67 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : BinaryCache.h
+// Description    : helpers for derived-data caches (content hashing, writing and memory mapping cache files)
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace BinaryCache
+{
+	// root folder for every derived-data cache
+	const char* const CacheDirectory = "Resources/Cache/";
+
+	// a block of memory to be written to a cache file
+	struct Block
+	{
+		const void* Data;
+		size_t Size;
+	};
+
+	// 64 bit FNV-1a hash, pass the previous result as the seed to hash several inputs together
+	uint64_t Hash(const void* Data, size_t Size, uint64_t Seed = 14695981039346656037ull);
+
+	// creates the directory if it is missing (single level)
+	bool EnsureDirectory(const char* Path);
+
+	// builds the full path of a cache file from a prefix and a key
+	std::string MakePath(const char* Prefix, uint64_t Key, const char* Extension);
+
+	// writes the blocks one after another, through a temporary file so a crash never leaves half a cache file
+	bool WriteFile(const std::string& Path, const std::vector<Block>& Blocks);
+}
+
+// read only memory mapping of a cache file, the data is used in place without copying
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+	bool Open(const std::string& Path);
+	void Close();
+	const unsigned char* GetData() const;
+	size_t GetSize() const;
+
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const unsigned char* Data = nullptr;
+	size_t Size = 0;
+
+#ifdef _WIN32
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#endif
+};
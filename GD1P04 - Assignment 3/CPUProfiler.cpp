@@ -0,0 +1,186 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : CPUProfiler.cpp
+// Description    : per thread event rings for the profile macros and the chrome trace writer
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "CPUProfiler.h"
+
+#ifdef ENABLE_PROFILING
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+// every ring ever handed out, rings of finished threads are reused so short lived workers do not add new ones
+// the tracks are not reused, each thread keeps its own name in the trace
+struct RingRegistry
+{
+	std::mutex Lock;
+	std::vector<CPUProfiler::ThreadRing*> Rings;
+	std::vector<const char*> TrackNames;	// track - 1, null until the thread names itself
+};
+
+static RingRegistry& GetRegistry()
+{
+	static RingRegistry Registry;
+	return Registry;
+}
+
+// gives the thread's ring back when the thread ends
+struct ThreadRingOwner
+{
+	CPUProfiler::ThreadRing* Ring = nullptr;
+	~ThreadRingOwner()
+	{
+		if (Ring != nullptr)
+		{
+			CPUProfiler::ReleaseRing(Ring);
+		}
+	}
+};
+
+static thread_local ThreadRingOwner LocalRing;
+
+uint64_t CPUProfiler::Now()
+{
+	static const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+CPUProfiler::ThreadRing* CPUProfiler::AcquireRing()
+{
+	RingRegistry& Registry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(Registry.Lock);
+	Registry.TrackNames.push_back(nullptr);
+	int Track = (int)Registry.TrackNames.size();
+
+	for (size_t i = 0; i < Registry.Rings.size(); i++)
+	{
+		if (Registry.Rings[i]->InUse.load() == false)
+		{
+			Registry.Rings[i]->InUse.store(true);
+			Registry.Rings[i]->Track = Track;
+			return Registry.Rings[i];
+		}
+	}
+
+	ThreadRing* Ring = new ThreadRing();
+	Ring->Head.store(0);
+	Ring->InUse.store(true);
+	Ring->Track = Track;
+	Registry.Rings.push_back(Ring);
+	return Ring;
+}
+
+void CPUProfiler::ReleaseRing(ThreadRing* Ring)
+{
+	std::lock_guard<std::mutex> Guard(GetRegistry().Lock);
+	Ring->InUse.store(false);
+}
+
+// the lock is only taken the first time a thread records something
+CPUProfiler::ThreadRing* CPUProfiler::GetThreadRing()
+{
+	if (LocalRing.Ring == nullptr)
+	{
+		LocalRing.Ring = AcquireRing();
+	}
+	return LocalRing.Ring;
+}
+
+void CPUProfiler::Record(const char* Name, uint64_t Begin, uint64_t End)
+{
+	ThreadRing* Ring = GetThreadRing();
+	uint64_t Head = Ring->Head.load(std::memory_order_relaxed);
+	Event& Slot = Ring->Events[Head & (RingSize - 1)];
+	Slot.Name = Name;
+	Slot.Begin = Begin;
+	Slot.End = End;
+	Slot.Track = Ring->Track;
+	Ring->Head.store(Head + 1, std::memory_order_release);
+}
+
+void CPUProfiler::SetThreadName(const char* Name)
+{
+	ThreadRing* Ring = GetThreadRing();
+	RingRegistry& Registry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(Registry.Lock);
+	Registry.TrackNames[Ring->Track - 1] = Name;
+}
+
+// names are function names and literals, only quotes and backslashes need escaping
+static void WriteJsonString(std::ofstream& File, const char* Text)
+{
+	File << '"';
+	for (const char* c = Text; *c != '\0'; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			File << '\\';
+		}
+		File << *c;
+	}
+	File << '"';
+}
+
+bool CPUProfiler::WriteChromeTrace(const std::string& FilePath)
+{
+	std::ofstream File(FilePath, std::ios::out | std::ios::trunc);
+	if (!File.good())
+	{
+		std::cout << "Cannot write file:  " << FilePath << std::endl;
+		return false;
+	}
+
+	RingRegistry& Registry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(Registry.Lock);
+
+	size_t EventCount = 0;
+	bool First = true;
+	File << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+	File.setf(std::ios::fixed);
+	File.precision(3);
+	// one track per thread, named by PROFILE_THREAD_NAME
+	for (size_t t = 0; t < Registry.TrackNames.size(); t++)
+	{
+		std::string TrackName = (Registry.TrackNames[t] != nullptr) ? Registry.TrackNames[t] : "Thread " + std::to_string(t + 1);
+		File << (First ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << (t + 1) << ",\"args\":{\"name\":";
+		WriteJsonString(File, TrackName.c_str());
+		File << "}}";
+		First = false;
+	}
+
+	for (size_t r = 0; r < Registry.Rings.size(); r++)
+	{
+		ThreadRing* Ring = Registry.Rings[r];
+
+		// complete events on the track of the thread that recorded them, timestamps in microseconds
+		uint64_t Head = Ring->Head.load(std::memory_order_acquire);
+		uint64_t Oldest = (Head > RingSize) ? Head - RingSize : 0;
+		for (uint64_t i = Oldest; i < Head; i++)
+		{
+			const Event& Current = Ring->Events[i & (RingSize - 1)];
+			File << ",\n{\"name\":";
+			WriteJsonString(File, Current.Name);
+			File << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << Current.Track << ",\"ts\":" << (Current.Begin / 1000.0)
+				<< ",\"dur\":" << ((Current.End - Current.Begin) / 1000.0) << "}";
+			EventCount++;
+		}
+	}
+	File << "\n]}" << std::endl;
+
+	std::cout << "CPU trace written to " << FilePath << " (" << EventCount << " events, " << Registry.TrackNames.size() << " tracks)" << std::endl;
+	return true;
+}
+
+#endif
@@ -0,0 +1,98 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : CPUProfiler.h
+// Description    : scope macros recording cpu timings per thread, exported as a chrome trace
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+
+// ENABLE_PROFILING is set in the Debug configurations only, without it (Release) every macro is empty
+#ifdef ENABLE_PROFILING
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define PROFILE_CONCAT_INNER(A, B) A##B
+#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INNER(A, B)
+
+// Name must outlive the trace (a string literal), only the pointer is stored
+#define PROFILE_SCOPE(Name) CPUProfileScope PROFILE_CONCAT(ProfileScope_, __LINE__)(Name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_THREAD_NAME(Name) CPUProfiler::SetThreadName(Name)
+#define PROFILE_EXPORT(FilePath) CPUProfiler::WriteChromeTrace(FilePath)
+
+class CPUProfiler
+{
+public:
+	// one finished scope, times in nanoseconds since the profiler started
+	struct Event
+	{
+		const char* Name;
+		uint64_t Begin;
+		uint64_t End;
+		int Track;		// thread that recorded it, a reused ring holds events of several threads
+	};
+
+	static uint64_t Now();
+	static void Record(const char* Name, uint64_t Begin, uint64_t End);
+	static void SetThreadName(const char* Name);
+
+	// writes every event still in the rings as trace_event json (chrome://tracing, perfetto), call it while the workers are idle
+	static bool WriteChromeTrace(const std::string& FilePath);
+
+private:
+	// events per thread before the oldest are overwritten, a power of two
+	static const uint32_t RingSize = 1 << 16;
+
+	// written by its own thread only, Head is published after the event so the exporter never reads a half written one
+	struct ThreadRing
+	{
+		Event Events[RingSize];
+		std::atomic<uint64_t> Head;
+		std::atomic<bool> InUse;
+		int Track;		// of the thread using the ring now, every thread gets a new one
+	};
+
+	static ThreadRing* AcquireRing();
+	static void ReleaseRing(ThreadRing* Ring);
+	static ThreadRing* GetThreadRing();
+
+	friend struct RingRegistry;
+	friend struct ThreadRingOwner;
+};
+
+// times its own lifetime
+class CPUProfileScope
+{
+public:
+	CPUProfileScope(const char* Name)
+	{
+		this->Name = Name;
+		Begin = CPUProfiler::Now();
+	}
+	~CPUProfileScope()
+	{
+		CPUProfiler::Record(Name, Begin, CPUProfiler::Now());
+	}
+
+private:
+	const char* Name;
+	uint64_t Begin;
+};
+
+#else
+
+#define PROFILE_SCOPE(Name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME(Name)
+#define PROFILE_EXPORT(FilePath)
+
+#endif
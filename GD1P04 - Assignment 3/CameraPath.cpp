@@ -0,0 +1,217 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : CameraPath.cpp
+// Description    : camera path recording, the binary path file and interpolated replay
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "CameraPath.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// file layout: "CPTH", version, key count (uint32 each), then the keys
+#define PATH_MAGIC "CPTH"
+#define PATH_VERSION 1
+#define PATH_KEY_BYTES 24
+
+CameraPath::CameraPath()
+{
+}
+
+CameraPath::~CameraPath()
+{
+}
+
+void CameraPath::BeginRecording()
+{
+	Keys.clear();
+	SegmentNames.clear();
+	RecordTime = 0.0f;
+	RecordSegment = 0;
+	Recording = true;
+}
+
+void CameraPath::Record(float DeltaTime, camera& Camera, uint8_t Flags)
+{
+	if (Recording == false)
+	{
+		return;
+	}
+
+	CameraKey Key;
+	Key.Time = RecordTime;
+	Key.Position = Camera.GetPosition();
+	Key.LookDir = Camera.GetLookDir();
+	Key.Flags = Flags;
+	Key.Segment = RecordSegment;
+	Keys.push_back(Key);
+	RecordTime += DeltaTime;
+}
+
+void CameraPath::MarkSegment()
+{
+	if (Recording == true && RecordSegment < 255)
+	{
+		RecordSegment++;
+	}
+}
+
+void CameraPath::EndRecording()
+{
+	Recording = false;
+	BuildSegmentNames();
+}
+
+bool CameraPath::IsRecording() const
+{
+	return Recording;
+}
+
+bool CameraPath::Save(const std::string& FilePath) const
+{
+	std::ofstream File(FilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!File.good())
+	{
+		std::cout << "Cannot write file:  " << FilePath << std::endl;
+		return false;
+	}
+
+	uint32_t Header[2] = { PATH_VERSION, (uint32_t)Keys.size() };
+	File.write(PATH_MAGIC, 4);
+	File.write((const char*)Header, sizeof(Header));
+
+	// little endian like every target of the project, fields are copied one by one so padding never reaches the file
+	unsigned char Buffer[PATH_KEY_BYTES];
+	for (size_t i = 0; i < Keys.size(); i++)
+	{
+		int16_t Look[3];
+		for (int c = 0; c < 3; c++)
+		{
+			Look[c] = (int16_t)glm::round(glm::clamp(Keys[i].LookDir[c], -1.0f, 1.0f) * 32767.0f);
+		}
+		memcpy(Buffer, &Keys[i].Time, 4);
+		memcpy(Buffer + 4, &Keys[i].Position[0], 12);
+		memcpy(Buffer + 16, Look, 6);
+		Buffer[22] = Keys[i].Flags;
+		Buffer[23] = Keys[i].Segment;
+		File.write((const char*)Buffer, PATH_KEY_BYTES);
+	}
+
+	std::cout << "Camera path saved to " << FilePath << " (" << Keys.size() << " keys, " << GetDuration() << " s)" << std::endl;
+	return File.good();
+}
+
+bool CameraPath::Load(const std::string& FilePath)
+{
+	std::ifstream File(FilePath, std::ios::in | std::ios::binary);
+	char Magic[4];
+	uint32_t Header[2];
+	if (!File.good() || !File.read(Magic, 4) || memcmp(Magic, PATH_MAGIC, 4) != 0
+		|| !File.read((char*)Header, sizeof(Header)) || Header[0] != PATH_VERSION)
+	{
+		std::cout << "Cannot read camera path:  " << FilePath << std::endl;
+		return false;
+	}
+
+	Keys.resize(Header[1]);
+	unsigned char Buffer[PATH_KEY_BYTES];
+	for (size_t i = 0; i < Keys.size(); i++)
+	{
+		if (!File.read((char*)Buffer, PATH_KEY_BYTES))
+		{
+			std::cout << "Camera path is truncated:  " << FilePath << std::endl;
+			Keys.clear();
+			SegmentNames.clear();
+			return false;
+		}
+
+		int16_t Look[3];
+		memcpy(&Keys[i].Time, Buffer, 4);
+		memcpy(&Keys[i].Position[0], Buffer + 4, 12);
+		memcpy(Look, Buffer + 16, 6);
+		Keys[i].LookDir = glm::vec3(Look[0], Look[1], Look[2]) / 32767.0f;
+		Keys[i].Flags = Buffer[22];
+		Keys[i].Segment = Buffer[23];
+	}
+	BuildSegmentNames();
+
+	std::cout << "Camera path " << FilePath << ": " << Keys.size() << " keys, " << GetDuration() << " s, "
+		<< SegmentNames.size() << " segments" << std::endl;
+	return true;
+}
+
+bool CameraPath::IsEmpty() const
+{
+	return Keys.empty();
+}
+
+float CameraPath::GetDuration() const
+{
+	return Keys.empty() ? 0.0f : Keys.back().Time;
+}
+
+int CameraPath::GetSegmentCount() const
+{
+	return Keys.empty() ? 0 : (int)Keys.back().Segment + 1;
+}
+
+// the names are handed out as c strings (profiler frame names), they are built once per path
+void CameraPath::BuildSegmentNames()
+{
+	SegmentNames.clear();
+	for (int i = 0; i < GetSegmentCount(); i++)
+	{
+		SegmentNames.push_back("Segment " + std::to_string(i));
+	}
+}
+
+const char* CameraPath::GetSegmentName(int Segment) const
+{
+	return (Segment >= 0 && Segment < (int)SegmentNames.size()) ? SegmentNames[Segment].c_str() : "Frame";
+}
+
+void CameraPath::Apply(float Time, camera& Camera, uint8_t& Flags, int& Segment) const
+{
+	if (Keys.empty())
+	{
+		return;
+	}
+
+	// key before Time, the path holds its last key after the end
+	Time = glm::clamp(Time, 0.0f, GetDuration());
+	size_t Next = std::upper_bound(Keys.begin(), Keys.end(), Time, [](float Value, const CameraKey& Key) { return Value < Key.Time; }) - Keys.begin();
+	size_t i1 = (Next == 0) ? 0 : Next - 1;
+	size_t i2 = std::min(i1 + 1, Keys.size() - 1);
+	size_t i0 = (i1 == 0) ? 0 : i1 - 1;
+	size_t i3 = std::min(i2 + 1, Keys.size() - 1);
+
+	float Span = Keys[i2].Time - Keys[i1].Time;
+	float t = (Span > 0.0f) ? (Time - Keys[i1].Time) / Span : 0.0f;
+
+	// catmull-rom through the neighbouring keys, sparse hand made paths stay smooth
+	glm::vec3 P0 = Keys[i0].Position;
+	glm::vec3 P1 = Keys[i1].Position;
+	glm::vec3 P2 = Keys[i2].Position;
+	glm::vec3 P3 = Keys[i3].Position;
+	float t2 = t * t;
+	float t3 = t2 * t;
+	glm::vec3 Position = 0.5f * ((2.0f * P1) + (-P0 + P2) * t + (2.0f * P0 - 5.0f * P1 + 4.0f * P2 - P3) * t2 + (-P0 + 3.0f * P1 - 3.0f * P2 + P3) * t3);
+
+	glm::vec3 LookDir = glm::mix(Keys[i1].LookDir, Keys[i2].LookDir, t);
+	if (glm::length(LookDir) < 0.001f)
+	{
+		LookDir = Keys[i2].LookDir;
+	}
+
+	Camera.SetView(Position, LookDir);
+	Flags = Keys[i1].Flags;
+	Segment = Keys[i1].Segment;
+}
@@ -0,0 +1,70 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : CameraPath.h
+// Description    : class file for recording the camera (and the render toggles) per frame and replaying it
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "camera.h"
+
+// render toggles from KeyInput that change the cost of a frame, stored with every key
+#define PATH_FLAG_WIREFRAME 0x01
+#define PATH_FLAG_STENCIL 0x02
+#define PATH_FLAG_SCISSOR 0x04
+#define PATH_FLAG_FACECULL 0x08
+#define PATH_FLAG_DEFERRED 0x10
+
+// one recorded frame, 24 bytes on disk (the look direction is stored as snorm16)
+struct CameraKey
+{
+	float Time;
+	glm::vec3 Position;
+	glm::vec3 LookDir;
+	uint8_t Flags;
+	uint8_t Segment;	// benchmark results are broken down by segment
+};
+
+class CameraPath
+{
+public:
+	CameraPath();
+	~CameraPath();
+
+	// keys are appended every frame until EndRecording, MarkSegment starts the next segment
+	void BeginRecording();
+	void Record(float DeltaTime, camera& Camera, uint8_t Flags);
+	void MarkSegment();
+	void EndRecording();
+	bool IsRecording() const;
+
+	bool Save(const std::string& FilePath) const;
+	bool Load(const std::string& FilePath);
+
+	bool IsEmpty() const;
+	float GetDuration() const;
+	int GetSegmentCount() const;
+	const char* GetSegmentName(int Segment) const;
+
+	// moves the camera to the path at Time (positions on a catmull-rom curve), flags and segment come from the key before Time
+	void Apply(float Time, camera& Camera, uint8_t& Flags, int& Segment) const;
+
+private:
+	void BuildSegmentNames();
+
+	std::vector<CameraKey> Keys;
+	std::vector<std::string> SegmentNames;
+	bool Recording = false;
+	float RecordTime = 0.0f;
+	uint8_t RecordSegment = 0;
+};
@@ -0,0 +1,159 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : DeferredRenderer.cpp
+// Description    : g-buffer setup, geometry pass and fullscreen lighting pass of the deferred renderer
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "DeferredRenderer.h"
+#include "ProgramRegistry.h"
+#include <iostream>
+
+// creates a screen sized texture for one g-buffer attachment
+static GLuint CreateTarget(GLint InternalFormat, GLenum Format, GLenum Type, int Width, int Height)
+{
+	GLuint Texture;
+	glGenTextures(1, &Texture);
+	GLState::BindTexture(0, GL_TEXTURE_2D, Texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, Width, Height, 0, Format, Type, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	return Texture;
+}
+
+DeferredRenderer::DeferredRenderer(int Width, int Height, std::map<std::string, GLuint>& ShaderMap)
+{
+	this->Width = Width;
+	this->Height = Height;
+
+	glGenFramebuffers(1, &FBO);
+	CreateTargets();
+
+	// the fullscreen triangle is generated from gl_VertexID, the vertex array only has to exist
+	glGenVertexArrays(1, &EmptyVAO);
+
+	GeometryProgram = ProgramRegistry::Get(PROGRAM_GBUFFER, ShaderMap);
+	LightingProgram = ProgramRegistry::Get(PROGRAM_DEFERRED_LIGHTING, ShaderMap);
+
+	AlbedoHandle = LightingProgram->GetUniform("GAlbedo");
+	NormalHandle = LightingProgram->GetUniform("GNormal");
+	DepthHandle = LightingProgram->GetUniform("GDepth");
+	InverseViewProjHandle = LightingProgram->GetUniform("InverseViewProj");
+}
+
+DeferredRenderer::~DeferredRenderer()
+{
+	GLState::BindFramebuffer(0);
+	glDeleteFramebuffers(1, &FBO);
+	glDeleteVertexArrays(1, &EmptyVAO);
+	DeleteTargets();
+	// the programs belong to the shader loader
+}
+
+void DeferredRenderer::Resize(int Width, int Height)
+{
+	if (Width == this->Width && Height == this->Height)
+	{
+		return;
+	}
+	this->Width = Width;
+	this->Height = Height;
+
+	// storage of a texture cannot change size, the attachments are created again
+	DeleteTargets();
+	CreateTargets();
+}
+
+int DeferredRenderer::GetWidth() const
+{
+	return Width;
+}
+
+int DeferredRenderer::GetHeight() const
+{
+	return Height;
+}
+
+ShaderProgram* DeferredRenderer::GetGeometryProgram() const
+{
+	return GeometryProgram;
+}
+
+void DeferredRenderer::BeginGeometryPass()
+{
+	const GLenum DrawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	GLState::BindFramebuffer(FBO);
+	glDrawBuffers(2, DrawBuffers);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+}
+
+void DeferredRenderer::EndGeometryPass()
+{
+	GLState::BindFramebuffer(OutputFramebuffer);
+}
+
+void DeferredRenderer::SetOutputFramebuffer(GLuint Framebuffer)
+{
+	OutputFramebuffer = Framebuffer;
+}
+
+void DeferredRenderer::LightingPass(const glm::mat4& CameraPV)
+{
+	// every pixel is written once, the depth test is only on so gl_FragDepth reaches the depth buffer
+	GLState::DepthFunc(GL_ALWAYS);
+	GLState::Disable(GL_CULL_FACE);
+	GLState::PolygonMode(GL_FILL);
+
+	GLState::UseProgram(LightingProgram->GetID());
+	GLState::BindTexture(0, GL_TEXTURE_2D, AlbedoTexture);
+	LightingProgram->SetInt(AlbedoHandle, 0);
+	GLState::BindTexture(1, GL_TEXTURE_2D, NormalTexture);
+	LightingProgram->SetInt(NormalHandle, 1);
+	GLState::BindTexture(2, GL_TEXTURE_2D, DepthTexture);
+	LightingProgram->SetInt(DepthHandle, 2);
+	LightingProgram->SetMat4(InverseViewProjHandle, glm::inverse(CameraPV));
+
+	GLState::BindVertexArray(EmptyVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	GLState::DepthFunc(GL_LESS);
+}
+
+void DeferredRenderer::CreateTargets()
+{
+	// albedo stays 8 bit, normals need the sign and precision of a float target
+	AlbedoTexture = CreateTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, Width, Height);
+	NormalTexture = CreateTarget(GL_RGBA16F, GL_RGBA, GL_FLOAT, Width, Height);
+	DepthTexture = CreateTarget(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, Width, Height);
+
+	GLState::BindFramebuffer(FBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, AlbedoTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, NormalTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, DepthTexture, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Deferred renderer: g-buffer is incomplete" << std::endl;
+	}
+	GLState::BindFramebuffer(OutputFramebuffer);
+}
+
+void DeferredRenderer::DeleteTargets()
+{
+	glDeleteTextures(1, &AlbedoTexture);
+	glDeleteTextures(1, &NormalTexture);
+	glDeleteTextures(1, &DepthTexture);
+	// the deleted names were still bound on units 0-2, and glGenTextures can hand them straight back
+	GLState::Invalidate();
+	AlbedoTexture = 0;
+	NormalTexture = 0;
+	DepthTexture = 0;
+}
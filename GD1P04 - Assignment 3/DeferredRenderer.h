@@ -0,0 +1,68 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : DeferredRenderer.h
+// Description    : class file for the deferred shading path, g-buffer plus a fullscreen lighting pass
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <map>
+#include <string>
+#include "ShaderLoader.h"
+#include "GLState.h"
+
+// albedo, normal and depth are written once per pixel, the lights are then applied in screen space
+class DeferredRenderer
+{
+public:
+	DeferredRenderer(int Width, int Height, std::map<std::string, GLuint>& ShaderMap);
+	~DeferredRenderer();
+
+	// the g-buffer has to match the framebuffer it is lit into, called when the window changes size
+	void Resize(int Width, int Height);
+	int GetWidth() const;
+	int GetHeight() const;
+
+	// program the objects of the geometry pass are drawn with (3D_Instanced.vs + GBuffer.fs)
+	ShaderProgram* GetGeometryProgram() const;
+
+	// binds and clears the g-buffer, everything drawn until EndGeometryPass lands in it
+	void BeginGeometryPass();
+	void EndGeometryPass();
+
+	// framebuffer the frame is drawn into after the geometry pass, 0 (the window) unless rendering offscreen
+	void SetOutputFramebuffer(GLuint Framebuffer);
+
+	// lights the g-buffer into the bound framebuffer and writes its depth, needs LightManager and LightClusters bound
+	void LightingPass(const glm::mat4& CameraPV);
+
+private:
+	void CreateTargets();
+	void DeleteTargets();
+
+	int Width;
+	int Height;
+
+	GLuint FBO = 0;
+	GLuint AlbedoTexture = 0;
+	GLuint NormalTexture = 0;
+	GLuint DepthTexture = 0;
+	GLuint EmptyVAO = 0;
+	GLuint OutputFramebuffer = 0;
+
+	ShaderProgram* GeometryProgram;
+	ShaderProgram* LightingProgram;
+	UniformHandle AlbedoHandle;
+	UniformHandle NormalHandle;
+	UniformHandle DepthHandle;
+	UniformHandle InverseViewProjHandle;
+};
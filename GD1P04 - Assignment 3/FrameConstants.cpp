@@ -0,0 +1,58 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : FrameConstants.cpp
+// Description    : fills the per frame uniform block once and binds it for every program
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "FrameConstants.h"
+#include <cstring>
+
+FrameConstants::FrameConstants(RingBuffer* Ring)
+{
+	this->Ring = Ring;
+
+	glGenBuffers(1, &UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+FrameConstants::~FrameConstants()
+{
+	glDeleteBuffers(1, &UBO);
+}
+
+void FrameConstants::Update(camera& Camera, float Time, glm::vec2 Viewport)
+{
+	FrameBlock Block;
+	Block.ViewProj = Camera.GetMatrixPV();
+	Block.View = Camera.ViewMat;
+	Block.Proj = Camera.ProjectionMat;
+	Block.CameraPos = Camera.GetPosition();
+	Block.Time = Time;
+	Block.Viewport = glm::vec4(Viewport, 1.0f / Viewport.x, 1.0f / Viewport.y);
+
+	// the ring keeps last frame's block alive for the gpu, the own buffer is only the fallback
+	if (Ring != nullptr)
+	{
+		RingAllocation Range = Ring->Allocate(sizeof(Block), Ring->GetUniformAlignment());
+		if (Range.Data != nullptr)
+		{
+			memcpy(Range.Data, &Block, sizeof(Block));
+			glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, Ring->GetBufferID(), Range.Offset, Range.Size);
+			return;
+		}
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &Block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, UBO);
+}
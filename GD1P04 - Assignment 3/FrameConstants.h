@@ -0,0 +1,46 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : FrameConstants.h
+// Description    : class file for the per frame uniform block (camera, time, viewport) shared by every program
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glm.hpp>
+#include "camera.h"
+#include "RingBuffer.h"
+
+// ShaderLoader binds the FrameBlock of every program it links to this point
+#define FRAME_BLOCK_BINDING 2		// uniform buffer (0 and 1 are the light and cluster blocks)
+
+class FrameConstants
+{
+public:
+	FrameConstants(RingBuffer* Ring);
+	~FrameConstants();
+
+	// written once per frame, after the camera moved and before the first draw
+	void Update(camera& Camera, float Time, glm::vec2 Viewport);
+
+private:
+	// std140 layout of FrameBlock, copied as is
+	struct FrameBlock
+	{
+		glm::mat4 ViewProj;
+		glm::mat4 View;
+		glm::mat4 Proj;
+		glm::vec3 CameraPos;
+		float Time;
+		glm::vec4 Viewport;	// width, height, 1 / width, 1 / height
+	};
+
+	RingBuffer* Ring;
+	GLuint UBO = 0;
+};
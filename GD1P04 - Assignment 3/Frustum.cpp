@@ -0,0 +1,79 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Frustum.cpp
+// Description    : plane extraction from a projection matrix and box/sphere visibility tests
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "Frustum.h"
+
+Frustum::Frustum()
+{
+}
+
+Frustum::~Frustum()
+{
+}
+
+void Frustum::Extract(const glm::mat4& Matrix)
+{
+	// rows of the matrix (glm is column major)
+	glm::vec4 Row0 = glm::vec4(Matrix[0][0], Matrix[1][0], Matrix[2][0], Matrix[3][0]);
+	glm::vec4 Row1 = glm::vec4(Matrix[0][1], Matrix[1][1], Matrix[2][1], Matrix[3][1]);
+	glm::vec4 Row2 = glm::vec4(Matrix[0][2], Matrix[1][2], Matrix[2][2], Matrix[3][2]);
+	glm::vec4 Row3 = glm::vec4(Matrix[0][3], Matrix[1][3], Matrix[2][3], Matrix[3][3]);
+
+	Planes[0] = Row3 + Row0;
+	Planes[1] = Row3 - Row0;
+	Planes[2] = Row3 + Row1;
+	Planes[3] = Row3 - Row1;
+	Planes[4] = Row3 + Row2;
+	Planes[5] = Row3 - Row2;
+
+	// normalize so sphere tests can compare against a radius
+	for (int i = 0; i < 6; i++)
+	{
+		Planes[i] /= glm::length(glm::vec3(Planes[i]));
+	}
+}
+
+bool Frustum::IntersectsBox(const glm::vec3& BoxMin, const glm::vec3& BoxMax) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		// test the corner furthest along the plane normal
+		glm::vec3 Corner = glm::vec3(
+			(Planes[i].x >= 0.0f) ? BoxMax.x : BoxMin.x,
+			(Planes[i].y >= 0.0f) ? BoxMax.y : BoxMin.y,
+			(Planes[i].z >= 0.0f) ? BoxMax.z : BoxMin.z);
+
+		if (glm::dot(glm::vec3(Planes[i]), Corner) + Planes[i].w < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& Center, float Radius) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (glm::dot(glm::vec3(Planes[i]), Center) + Planes[i].w < -Radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+const glm::vec4* Frustum::GetPlanes() const
+{
+	return Planes;
+}
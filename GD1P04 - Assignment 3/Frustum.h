@@ -0,0 +1,32 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Frustum.h
+// Description    : class file for view frustum planes and culling tests
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glm.hpp>
+
+class Frustum
+{
+public:
+	Frustum();
+	~Frustum();
+
+	// planes are extracted in the space the matrix transforms from (world space for PV, model space for PVM)
+	void Extract(const glm::mat4& Matrix);
+	bool IntersectsBox(const glm::vec3& BoxMin, const glm::vec3& BoxMax) const;
+	bool IntersectsSphere(const glm::vec3& Center, float Radius) const;
+	const glm::vec4* GetPlanes() const;
+
+private:
+	// left, right, bottom, top, near, far (xyz = normal pointing inside, w = distance)
+	glm::vec4 Planes[6];
+};
@@ -0,0 +1,256 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : GLState.cpp
+// Description    : gl state cache, every setter compares against the shadow before calling the driver
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "GLState.h"
+#include <cstring>
+
+GLState::Shadow GLState::Current = {};
+int GLState::FrameIssuedCalls = 0;
+int GLState::FrameFilteredCalls = 0;
+
+bool GLState::Issue(bool& Known, bool Same)
+{
+	if (Known && Same)
+	{
+		FrameFilteredCalls++;
+		return false;
+	}
+	Known = true;
+	FrameIssuedCalls++;
+	return true;
+}
+
+int GLState::CapabilityIndex(GLenum Capability)
+{
+	switch (Capability)
+	{
+	case GL_CULL_FACE: return 0;
+	case GL_DEPTH_TEST: return 1;
+	case GL_STENCIL_TEST: return 2;
+	case GL_SCISSOR_TEST: return 3;
+	case GL_BLEND: return 4;
+	case GL_TEXTURE_CUBE_MAP_SEAMLESS: return 5;
+	default: return -1;
+	}
+}
+
+int GLState::TargetIndex(GLenum Target)
+{
+	switch (Target)
+	{
+	case GL_TEXTURE_2D: return 0;
+	case GL_TEXTURE_CUBE_MAP: return 1;
+	default: return -1;
+	}
+}
+
+void GLState::UseProgram(GLuint Program)
+{
+	if (Issue(Current.ProgramKnown, Current.Program == Program))
+	{
+		Current.Program = Program;
+		glUseProgram(Program);
+	}
+}
+
+void GLState::BindVertexArray(GLuint VAO)
+{
+	if (Issue(Current.VAOKnown, Current.VAO == VAO))
+	{
+		Current.VAO = VAO;
+		glBindVertexArray(VAO);
+	}
+}
+
+void GLState::ActiveTexture(GLuint Unit)
+{
+	if (Issue(Current.ActiveUnitKnown, Current.ActiveUnit == Unit))
+	{
+		Current.ActiveUnit = Unit;
+		glActiveTexture(GL_TEXTURE0 + Unit);
+	}
+}
+
+void GLState::BindTexture(GLuint Unit, GLenum Target, GLuint Texture)
+{
+	int Slot = TargetIndex(Target);
+
+	// targets that are not shadowed always go through
+	if (Slot < 0 || Unit >= GL_STATE_TEXTURE_UNITS)
+	{
+		ActiveTexture(Unit);
+		FrameIssuedCalls++;
+		glBindTexture(Target, Texture);
+		return;
+	}
+
+	if (Issue(Current.TexturesKnown[Unit][Slot], Current.Textures[Unit][Slot] == Texture))
+	{
+		Current.Textures[Unit][Slot] = Texture;
+		ActiveTexture(Unit);
+		glBindTexture(Target, Texture);
+	}
+}
+
+void GLState::BindFramebuffer(GLuint Framebuffer)
+{
+	if (Issue(Current.FramebufferKnown, Current.Framebuffer == Framebuffer))
+	{
+		Current.Framebuffer = Framebuffer;
+		glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer);
+	}
+}
+
+void GLState::Enable(GLenum Capability)
+{
+	SetEnabled(Capability, true);
+}
+
+void GLState::Disable(GLenum Capability)
+{
+	SetEnabled(Capability, false);
+}
+
+void GLState::SetEnabled(GLenum Capability, bool Enabled)
+{
+	int Index = CapabilityIndex(Capability);
+	if (Index < 0)
+	{
+		FrameIssuedCalls++;
+		Enabled ? glEnable(Capability) : glDisable(Capability);
+		return;
+	}
+
+	if (Issue(Current.CapabilitiesKnown[Index], Current.Capabilities[Index] == Enabled))
+	{
+		Current.Capabilities[Index] = Enabled;
+		Enabled ? glEnable(Capability) : glDisable(Capability);
+	}
+}
+
+void GLState::CullFace(GLenum Face)
+{
+	if (Issue(Current.CullFaceKnown, Current.CullFace == Face))
+	{
+		Current.CullFace = Face;
+		glCullFace(Face);
+	}
+}
+
+void GLState::DepthFunc(GLenum Func)
+{
+	if (Issue(Current.DepthFuncKnown, Current.DepthFunc == Func))
+	{
+		Current.DepthFunc = Func;
+		glDepthFunc(Func);
+	}
+}
+
+void GLState::DepthMask(GLboolean Write)
+{
+	if (Issue(Current.DepthMaskKnown, Current.DepthMask == Write))
+	{
+		Current.DepthMask = Write;
+		glDepthMask(Write);
+	}
+}
+
+void GLState::ColorMask(GLboolean Write)
+{
+	if (Issue(Current.ColorMaskKnown, Current.ColorMask == Write))
+	{
+		Current.ColorMask = Write;
+		glColorMask(Write, Write, Write, Write);
+	}
+}
+
+void GLState::StencilFunc(GLenum Func, GLint Ref, GLuint Mask)
+{
+	if (Issue(Current.StencilFuncKnown, Current.StencilFunc == Func && Current.StencilRef == Ref && Current.StencilFuncMask == Mask))
+	{
+		Current.StencilFunc = Func;
+		Current.StencilRef = Ref;
+		Current.StencilFuncMask = Mask;
+		glStencilFunc(Func, Ref, Mask);
+	}
+}
+
+void GLState::StencilOp(GLenum StencilFail, GLenum DepthFail, GLenum DepthPass)
+{
+	if (Issue(Current.StencilOpKnown, Current.StencilOp[0] == StencilFail && Current.StencilOp[1] == DepthFail && Current.StencilOp[2] == DepthPass))
+	{
+		Current.StencilOp[0] = StencilFail;
+		Current.StencilOp[1] = DepthFail;
+		Current.StencilOp[2] = DepthPass;
+		glStencilOp(StencilFail, DepthFail, DepthPass);
+	}
+}
+
+void GLState::StencilMask(GLuint Mask)
+{
+	if (Issue(Current.StencilMaskKnown, Current.StencilMask == Mask))
+	{
+		Current.StencilMask = Mask;
+		glStencilMask(Mask);
+	}
+}
+
+void GLState::PolygonMode(GLenum Mode)
+{
+	if (Issue(Current.PolygonModeKnown, Current.PolygonMode == Mode))
+	{
+		Current.PolygonMode = Mode;
+		glPolygonMode(GL_FRONT_AND_BACK, Mode);
+	}
+}
+
+void GLState::Scissor(GLint X, GLint Y, GLsizei Width, GLsizei Height)
+{
+	const GLint Box[4] = { X, Y, Width, Height };
+	if (Issue(Current.ScissorBoxKnown, memcmp(Current.ScissorBox, Box, sizeof(Box)) == 0))
+	{
+		memcpy(Current.ScissorBox, Box, sizeof(Box));
+		glScissor(X, Y, Width, Height);
+	}
+}
+
+void GLState::Viewport(GLint X, GLint Y, GLsizei Width, GLsizei Height)
+{
+	const GLint Box[4] = { X, Y, Width, Height };
+	if (Issue(Current.ViewportKnown, memcmp(Current.ViewportBox, Box, sizeof(Box)) == 0))
+	{
+		memcpy(Current.ViewportBox, Box, sizeof(Box));
+		glViewport(X, Y, Width, Height);
+	}
+}
+
+void GLState::Invalidate()
+{
+	Current = Shadow();
+}
+
+int GLState::GetFrameIssuedCalls()
+{
+	return FrameIssuedCalls;
+}
+
+int GLState::GetFrameFilteredCalls()
+{
+	return FrameFilteredCalls;
+}
+
+void GLState::ResetFrameStats()
+{
+	FrameIssuedCalls = 0;
+	FrameFilteredCalls = 0;
+}
@@ -0,0 +1,108 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : GLState.h
+// Description    : class file for the gl state cache, shadows the bound objects and render state and drops redundant calls
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+
+#define GL_STATE_TEXTURE_UNITS 16
+
+// every render path goes through these instead of the raw gl calls, so the shadow always matches the context.
+// code that still changes one of these states directly has to call Invalidate() afterwards
+class GLState
+{
+public:
+	// bound objects
+	static void UseProgram(GLuint Program);
+	static void BindVertexArray(GLuint VAO);
+	static void ActiveTexture(GLuint Unit);						// unit index, not GL_TEXTURE0 + index
+	static void BindTexture(GLuint Unit, GLenum Target, GLuint Texture);	// selects the unit only when the binding changes
+	static void BindFramebuffer(GLuint Framebuffer);	// GL_FRAMEBUFFER, draw and read
+
+	// fixed function state
+	static void Enable(GLenum Capability);
+	static void Disable(GLenum Capability);
+	static void SetEnabled(GLenum Capability, bool Enabled);
+	static void CullFace(GLenum Face);
+	static void DepthFunc(GLenum Func);
+	static void DepthMask(GLboolean Write);
+	static void ColorMask(GLboolean Write);
+	static void StencilFunc(GLenum Func, GLint Ref, GLuint Mask);
+	static void StencilOp(GLenum StencilFail, GLenum DepthFail, GLenum DepthPass);
+	static void StencilMask(GLuint Mask);
+	static void PolygonMode(GLenum Mode);	// front and back
+	static void Scissor(GLint X, GLint Y, GLsizei Width, GLsizei Height);
+	static void Viewport(GLint X, GLint Y, GLsizei Width, GLsizei Height);
+
+	// forget the shadow, the next call of every kind goes to the driver
+	static void Invalidate();
+
+	// driver calls made and calls dropped since the last reset
+	static int GetFrameIssuedCalls();
+	static int GetFrameFilteredCalls();
+	static void ResetFrameStats();
+
+private:
+	GLState(void);
+	~GLState(void);
+
+	static int CapabilityIndex(GLenum Capability);
+	static int TargetIndex(GLenum Target);
+
+	// counts the call and tells the caller whether it has to reach the driver
+	static bool Issue(bool& Known, bool Same);
+
+	// shadowed values, each one only counts once its Known flag is set
+	struct Shadow
+	{
+		GLuint Program;
+		GLuint VAO;
+		GLuint ActiveUnit;
+		GLuint Textures[GL_STATE_TEXTURE_UNITS][2];	// 2D, cube map
+		GLuint Framebuffer;
+		bool Capabilities[6];
+		GLenum CullFace;
+		GLenum DepthFunc;
+		GLboolean DepthMask;
+		GLboolean ColorMask;
+		GLenum StencilFunc;
+		GLint StencilRef;
+		GLuint StencilFuncMask;
+		GLenum StencilOp[3];
+		GLuint StencilMask;
+		GLenum PolygonMode;
+		GLint ScissorBox[4];
+		GLint ViewportBox[4];
+
+		bool ProgramKnown;
+		bool VAOKnown;
+		bool ActiveUnitKnown;
+		bool TexturesKnown[GL_STATE_TEXTURE_UNITS][2];
+		bool FramebufferKnown;
+		bool CapabilitiesKnown[6];
+		bool CullFaceKnown;
+		bool DepthFuncKnown;
+		bool DepthMaskKnown;
+		bool ColorMaskKnown;
+		bool StencilFuncKnown;
+		bool StencilOpKnown;
+		bool StencilMaskKnown;
+		bool PolygonModeKnown;
+		bool ScissorBoxKnown;
+		bool ViewportKnown;
+	};
+
+	static Shadow Current;
+
+	static int FrameIssuedCalls;
+	static int FrameFilteredCalls;
+};
@@ -0,0 +1,243 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : GPUProfiler.cpp
+// Description    : records GL_TIMESTAMP queries around named scopes and reads them back a few frames later
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "GPUProfiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+GPUProfiler::GPUProfiler(int FrameLatency, int HistorySize)
+{
+	Slots.resize(FrameLatency < 2 ? 2 : FrameLatency);
+	this->HistorySize = HistorySize;
+}
+
+GPUProfiler::~GPUProfiler()
+{
+	for (size_t i = 0; i < Slots.size(); i++)
+	{
+		if (Slots[i].Queries.empty() == false)
+		{
+			glDeleteQueries((GLsizei)Slots[i].Queries.size(), Slots[i].Queries.data());
+		}
+	}
+}
+
+void GPUProfiler::BeginFrame(const char* Name)
+{
+	// the slot being reused was recorded FrameLatency frames ago
+	Current = &Slots[Frame % Slots.size()];
+	Collect(*Current);
+
+	Current->UsedQueries = 0;
+	Current->Scopes.clear();
+	Current->Pending = true;
+	OpenScopes.clear();
+	BeginScope(Name);
+}
+
+void GPUProfiler::EndFrame()
+{
+	while (OpenScopes.empty() == false)
+	{
+		EndScope();
+	}
+	Current = nullptr;
+	Frame++;
+}
+
+void GPUProfiler::BeginScope(const char* Name)
+{
+	if (Current == nullptr)
+	{
+		return;
+	}
+
+	ScopeRecord Scope;
+	Scope.Path = OpenScopes.empty() ? std::string(Name) : Current->Scopes[OpenScopes.back()].Path + "/" + Name;
+	Scope.Depth = (int)OpenScopes.size();
+	Scope.BeginQuery = WriteTimestamp();
+	Scope.EndQuery = -1;
+	OpenScopes.push_back((int)Current->Scopes.size());
+	Current->Scopes.push_back(Scope);
+}
+
+void GPUProfiler::EndScope()
+{
+	if (Current == nullptr || OpenScopes.empty())
+	{
+		return;
+	}
+	Current->Scopes[OpenScopes.back()].EndQuery = WriteTimestamp();
+	OpenScopes.pop_back();
+}
+
+// the timestamp is taken when the gpu reaches this point of the command stream, not when the cpu calls it
+int GPUProfiler::WriteTimestamp()
+{
+	if (Current->UsedQueries == (int)Current->Queries.size())
+	{
+		GLuint Query = 0;
+		glGenQueries(1, &Query);
+		Current->Queries.push_back(Query);
+	}
+	int Index = Current->UsedQueries++;
+	glQueryCounter(Current->Queries[Index], GL_TIMESTAMP);
+	return Index;
+}
+
+void GPUProfiler::Collect(FrameSlot& Slot)
+{
+	if (Slot.Pending == false || Slot.UsedQueries == 0)
+	{
+		return;
+	}
+	Slot.Pending = false;
+
+	// the last query finishes last, if even that is not ready the frame is dropped instead of waiting on it
+	GLint Available = 0;
+	glGetQueryObjectiv(Slot.Queries[Slot.UsedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &Available);
+	if (Available == GL_FALSE)
+	{
+		DroppedFrames++;
+		return;
+	}
+
+	for (size_t i = 0; i < Slot.Scopes.size(); i++)
+	{
+		const ScopeRecord& Scope = Slot.Scopes[i];
+		if (Scope.EndQuery < 0)
+		{
+			continue;
+		}
+
+		GLuint64 BeginTime = 0;
+		GLuint64 EndTime = 0;
+		glGetQueryObjectui64v(Slot.Queries[Scope.BeginQuery], GL_QUERY_RESULT, &BeginTime);
+		glGetQueryObjectui64v(Slot.Queries[Scope.EndQuery], GL_QUERY_RESULT, &EndTime);
+
+		std::map<std::string, ScopeHistory>::iterator Found = History.find(Scope.Path);
+		if (Found == History.end())
+		{
+			Found = History.insert(std::make_pair(Scope.Path, ScopeHistory())).first;
+			Found->second.Depth = Scope.Depth;
+			Found->second.Samples.reserve(HistorySize);
+			PathOrder.push_back(Scope.Path);
+		}
+
+		ScopeHistory& Entry = Found->second;
+		float Milliseconds = (EndTime > BeginTime) ? (float)((EndTime - BeginTime) / 1000000.0) : 0.0f;
+		if ((int)Entry.Samples.size() < HistorySize)
+		{
+			Entry.Samples.push_back(Milliseconds);
+		}
+		else
+		{
+			Entry.Samples[Entry.Next] = Milliseconds;
+		}
+		Entry.Next = (Entry.Next + 1) % HistorySize;
+	}
+}
+
+void GPUProfiler::Flush()
+{
+	glFinish();
+	for (size_t i = 0; i < Slots.size(); i++)
+	{
+		Collect(Slots[i]);
+	}
+}
+
+void GPUProfiler::ResetStats()
+{
+	History.clear();
+	PathOrder.clear();
+	DroppedFrames = 0;
+}
+
+std::vector<float> GPUProfiler::GetSamples(const std::string& Path) const
+{
+	std::map<std::string, ScopeHistory>::const_iterator Found = History.find(Path);
+	return (Found != History.end()) ? Found->second.Samples : std::vector<float>();
+}
+
+std::vector<GPUScopeStats> GPUProfiler::GetStats() const
+{
+	std::vector<GPUScopeStats> Result;
+	std::vector<float> Sorted;
+	for (size_t i = 0; i < PathOrder.size(); i++)
+	{
+		const ScopeHistory& Entry = History.find(PathOrder[i])->second;
+		Sorted.assign(Entry.Samples.begin(), Entry.Samples.end());
+		std::sort(Sorted.begin(), Sorted.end());
+
+		float Sum = 0.0f;
+		for (size_t s = 0; s < Sorted.size(); s++)
+		{
+			Sum += Sorted[s];
+		}
+
+		// nearest rank, with fewer than 100 samples this is the maximum
+		size_t Rank = (size_t)((Sorted.size() * 99 + 99) / 100);
+
+		GPUScopeStats Stats;
+		Stats.Path = PathOrder[i];
+		Stats.Depth = Entry.Depth;
+		Stats.Samples = Sorted.size();
+		Stats.Min = Sorted.front();
+		Stats.Avg = Sum / Sorted.size();
+		Stats.Max = Sorted.back();
+		Stats.P99 = Sorted[Rank - 1];
+		Result.push_back(Stats);
+	}
+	return Result;
+}
+
+int GPUProfiler::GetDroppedFrames() const
+{
+	return DroppedFrames;
+}
+
+void GPUProfiler::PrintStats() const
+{
+	std::vector<GPUScopeStats> Stats = GetStats();
+	std::cout << "GPU profile (ms, last " << HistorySize << " frames, min / avg / max / p99):" << std::endl;
+	for (size_t i = 0; i < Stats.size(); i++)
+	{
+		// only the last part of the path, indented by depth
+		std::string Name = Stats[i].Path.substr(Stats[i].Path.rfind('/') + 1);
+		std::cout << "  " << std::string(Stats[i].Depth * 2, ' ') << Name << ": " << Stats[i].Min << " / " << Stats[i].Avg
+			<< " / " << Stats[i].Max << " / " << Stats[i].P99 << std::endl;
+	}
+}
+
+bool GPUProfiler::WriteCSV(const std::string& FilePath) const
+{
+	std::ofstream File(FilePath, std::ios::out | std::ios::trunc);
+	if (!File.good())
+	{
+		std::cout << "Cannot write file:  " << FilePath << std::endl;
+		return false;
+	}
+
+	std::vector<GPUScopeStats> Stats = GetStats();
+	File << "scope,depth,samples,min_ms,avg_ms,max_ms,p99_ms" << std::endl;
+	for (size_t i = 0; i < Stats.size(); i++)
+	{
+		File << Stats[i].Path << "," << Stats[i].Depth << "," << Stats[i].Samples << "," << Stats[i].Min << ","
+			<< Stats[i].Avg << "," << Stats[i].Max << "," << Stats[i].P99 << std::endl;
+	}
+	std::cout << "GPU profile written to " << FilePath << " (" << Stats.size() << " scopes, " << Frame << " frames, "
+		<< DroppedFrames << " dropped)" << std::endl;
+	return true;
+}
@@ -0,0 +1,98 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : GPUProfiler.h
+// Description    : class file for the gpu frame profiler, named scopes are timed with timestamp queries
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// rolling statistics of one scope, in milliseconds
+struct GPUScopeStats
+{
+	std::string Path;	// nested scopes are joined with '/', e.g. "Frame/Opaque/Terrain"
+	int Depth;
+	size_t Samples;		// in the window
+	float Min;
+	float Avg;
+	float Max;
+	float P99;
+};
+
+class GPUProfiler
+{
+public:
+	// results are read FrameLatency frames after they were recorded, by then the gpu has finished them
+	GPUProfiler(int FrameLatency, int HistorySize);
+	~GPUProfiler();
+
+	// collects the oldest frame in flight and opens the root scope, EndFrame closes whatever is still open
+	// (a benchmark names the root after the camera path segment, so every segment gets its own statistics)
+	void BeginFrame(const char* Name = "Frame");
+	void EndFrame();
+
+	// scopes nest, every BeginScope needs an EndScope in the same frame
+	void BeginScope(const char* Name);
+	void EndScope();
+
+	// waits for the gpu and collects every frame still in flight, for the end of a run
+	void Flush();
+	void ResetStats();
+
+	// one entry per scope path, in the order the paths were first seen
+	std::vector<GPUScopeStats> GetStats() const;
+	std::vector<float> GetSamples(const std::string& Path) const;
+	int GetDroppedFrames() const;
+
+	void PrintStats() const;
+	bool WriteCSV(const std::string& FilePath) const;
+
+private:
+	struct ScopeRecord
+	{
+		std::string Path;
+		int Depth;
+		int BeginQuery;
+		int EndQuery;
+	};
+
+	// queries and scopes of one frame in flight
+	struct FrameSlot
+	{
+		std::vector<GLuint> Queries;
+		int UsedQueries = 0;
+		std::vector<ScopeRecord> Scopes;
+		bool Pending = false;
+	};
+
+	// the last HistorySize samples of one path, written round robin
+	struct ScopeHistory
+	{
+		int Depth;
+		std::vector<float> Samples;
+		size_t Next = 0;
+	};
+
+	int WriteTimestamp();
+	void Collect(FrameSlot& Slot);
+
+	std::vector<FrameSlot> Slots;
+	FrameSlot* Current = nullptr;
+	std::vector<int> OpenScopes;	// indices into Current->Scopes
+	int Frame = 0;
+
+	int HistorySize;
+	std::map<std::string, ScopeHistory> History;
+	std::vector<std::string> PathOrder;
+	int DroppedFrames = 0;
+};
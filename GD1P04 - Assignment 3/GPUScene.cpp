@@ -0,0 +1,223 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : GPUScene.cpp
+// Description    : shared mesh buffers, per object buffer and indirect commands of the gpu driven scene
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "GPUScene.h"
+#include "ProgramRegistry.h"
+
+GPUScene::GPUScene(std::map<std::string, GLuint>& ShaderMap)
+{
+	// one VAO over the shared buffers, every mesh is a range of them
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+	GLState::BindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+	// Vertex Information (Position, Texture Coords and Normals)
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(5 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(2);
+	GLState::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenBuffers(1, &ObjectBuffer);
+	glGenBuffers(1, &CommandBuffer);
+
+	Program = ProgramRegistry::Get(PROGRAM_GPU_SCENE, ShaderMap);
+	TextureHandle = Program->GetUniform("ImageTexture0");
+	DrawOffsetHandle = Program->GetUniform("DrawOffset");
+}
+
+GPUScene::~GPUScene()
+{
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glDeleteBuffers(1, &ObjectBuffer);
+	glDeleteBuffers(1, &CommandBuffer);
+	GLState::Invalidate();
+	// the program belongs to the shader loader
+}
+
+int GPUScene::AddMesh(const std::vector<GLfloat>& Vertices, const std::vector<GLuint>& Indices)
+{
+	MeshRange Range;
+	Range.FirstIndex = (GLuint)this->Indices.size();
+	Range.IndexCount = (GLuint)Indices.size();
+	Range.BaseVertex = (GLint)(this->Vertices.size() / 8);
+
+	this->Vertices.insert(this->Vertices.end(), Vertices.begin(), Vertices.end());
+	this->Indices.insert(this->Indices.end(), Indices.begin(), Indices.end());
+	Meshes.push_back(Range);
+	MeshesDirty = true;
+	return (int)Meshes.size() - 1;
+}
+
+int GPUScene::AddMaterial(GLuint TextureID)
+{
+	MaterialTextures.push_back(TextureID);
+	CommandsDirty = true;
+	return (int)MaterialTextures.size() - 1;
+}
+
+int GPUScene::AddObject(int Mesh, int Material, const glm::mat4& ModelMat)
+{
+	Object NewObject;
+	NewObject.Mesh = Mesh;
+	NewObject.Material = Material;
+	Objects.push_back(NewObject);
+	Transforms.push_back(ModelMat);
+	CommandsDirty = true;
+	return (int)Objects.size() - 1;
+}
+
+void GPUScene::SetTransform(int Object, const glm::mat4& ModelMat)
+{
+	Transforms[Object] = ModelMat;
+	if (CommandsDirty == false)
+	{
+		SlotTransforms[Slots[Object]].Model = ModelMat;
+		TransformsDirty = true;
+	}
+}
+
+void GPUScene::ClearObjects()
+{
+	Objects.clear();
+	Transforms.clear();
+	CommandsDirty = true;
+}
+
+size_t GPUScene::GetObjectCount() const
+{
+	return Objects.size();
+}
+
+int GPUScene::GetDrawCalls() const
+{
+	return DrawCalls;
+}
+
+void GPUScene::UploadMeshes()
+{
+	// static data, the whole buffer is replaced when a mesh is added
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(GLfloat), Vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::BindVertexArray(VAO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size() * sizeof(GLuint), Indices.data(), GL_STATIC_DRAW);
+	MeshesDirty = false;
+}
+
+void GPUScene::BuildCommands()
+{
+	// counting sort of the objects by material, each material becomes one contiguous run of commands
+	size_t MaterialTotal = MaterialTextures.size();
+	MaterialFirst.assign(MaterialTotal, 0);
+	MaterialCount.assign(MaterialTotal, 0);
+	for (size_t i = 0; i < Objects.size(); i++)
+	{
+		MaterialCount[Objects[i].Material]++;
+	}
+	for (size_t m = 1; m < MaterialTotal; m++)
+	{
+		MaterialFirst[m] = MaterialFirst[m - 1] + MaterialCount[m - 1];
+	}
+
+	std::vector<GLuint> Next(MaterialFirst);
+	std::vector<DrawElementsIndirectCommand> Commands(Objects.size());
+	Slots.resize(Objects.size());
+	SlotTransforms.resize(Objects.size());
+	for (size_t i = 0; i < Objects.size(); i++)
+	{
+		GLuint Slot = Next[Objects[i].Material]++;
+		const MeshRange& Range = Meshes[Objects[i].Mesh];
+		Commands[Slot].Count = Range.IndexCount;
+		Commands[Slot].InstanceCount = 1;
+		Commands[Slot].FirstIndex = Range.FirstIndex;
+		Commands[Slot].BaseVertex = Range.BaseVertex;
+		Commands[Slot].BaseInstance = Slot;
+		Slots[i] = Slot;
+		SlotTransforms[Slot].Model = Transforms[i];
+	}
+
+	// both buffers are sized for the objects, they only grow
+	if (Objects.size() > ObjectCapacity)
+	{
+		ObjectCapacity = Objects.size() * 2;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, ObjectBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, ObjectCapacity * sizeof(InstanceTransform), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, CommandBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, ObjectCapacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STATIC_DRAW);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, CommandBuffer);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, Commands.size() * sizeof(DrawElementsIndirectCommand), Commands.data());
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	CommandsDirty = false;
+	TransformsDirty = true;
+}
+
+void GPUScene::Render()
+{
+	DrawCalls = 0;
+	if (Objects.empty())
+	{
+		return;
+	}
+
+	if (MeshesDirty == true)
+	{
+		UploadMeshes();
+	}
+	if (CommandsDirty == true)
+	{
+		BuildCommands();
+	}
+	if (TransformsDirty == true)
+	{
+		// every normal matrix in one batch, the vertex shader only reads them
+		NormalMatrix::ComputeBatch(SlotTransforms.data(), SlotTransforms.size());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, ObjectBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, SlotTransforms.size() * sizeof(InstanceTransform), SlotTransforms.data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		TransformsDirty = false;
+	}
+
+	GLState::UseProgram(Program->GetID());
+	Program->SetInt(TextureHandle, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_SCENE_OBJECT_BINDING, ObjectBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, CommandBuffer);
+
+	GLState::Disable(GL_CULL_FACE);
+	GLState::BindVertexArray(VAO);
+
+	// gl_DrawID restarts at zero in every multi draw, the offset points it at the material's first object
+	for (size_t m = 0; m < MaterialTextures.size(); m++)
+	{
+		if (MaterialCount[m] == 0)
+		{
+			continue;
+		}
+		GLState::BindTexture(0, GL_TEXTURE_2D, MaterialTextures[m]);
+		Program->SetInt(DrawOffsetHandle, (GLint)MaterialFirst[m]);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(MaterialFirst[m] * sizeof(DrawElementsIndirectCommand)), (GLsizei)MaterialCount[m], 0);
+		DrawCalls++;
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
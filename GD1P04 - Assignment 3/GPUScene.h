@@ -0,0 +1,108 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : GPUScene.h
+// Description    : class file for the gpu driven scene, static meshes in shared buffers drawn with multi draw indirect
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include "ShaderLoader.h"
+#include "GLState.h"
+#include "NormalMatrix.h"
+
+// must match the object buffer in GPUScene.vs
+#define GPU_SCENE_OBJECT_BINDING 5
+
+// layout glMultiDrawElementsIndirect reads
+struct DrawElementsIndirectCommand
+{
+	GLuint Count;
+	GLuint InstanceCount;
+	GLuint FirstIndex;
+	GLint BaseVertex;
+	GLuint BaseInstance;
+};
+
+// multi draw indirect path for static objects in the sphere vertex layout, lit by Lit.fs (LIGHTING_POINT), used by the sphere field
+// the terrain (own vertex layout and cached meshes), the skybox (cubemap program) and the scene spheres
+// (stencil outlines, program switched for deferred) keep their own draws
+class GPUScene
+{
+public:
+	GPUScene(std::map<std::string, GLuint>& ShaderMap);
+	~GPUScene();
+
+	// meshes use the interleaved sphere layout (position, texture coords, normal), returns the mesh index
+	int AddMesh(const std::vector<GLfloat>& Vertices, const std::vector<GLuint>& Indices);
+
+	// a material is the texture its objects are drawn with, one multi draw per material
+	int AddMaterial(GLuint TextureID);
+
+	// returns the object index, transforms can be changed later without rebuilding the commands
+	int AddObject(int Mesh, int Material, const glm::mat4& ModelMat);
+	void SetTransform(int Object, const glm::mat4& ModelMat);
+	void ClearObjects();
+	size_t GetObjectCount() const;
+
+	// uploads what changed and issues one glMultiDrawElementsIndirect per material
+	void Render();
+	int GetDrawCalls() const;
+
+private:
+	struct MeshRange
+	{
+		GLuint FirstIndex;
+		GLuint IndexCount;
+		GLint BaseVertex;
+	};
+
+	struct Object
+	{
+		int Mesh;
+		int Material;
+	};
+
+	void UploadMeshes();
+	void BuildCommands();
+
+	// shared vertex and index data of every mesh
+	std::vector<GLfloat> Vertices;
+	std::vector<GLuint> Indices;
+	std::vector<MeshRange> Meshes;
+	bool MeshesDirty = false;
+
+	// objects and their transforms, Slots maps an object to its command / buffer entry (grouped by material)
+	std::vector<Object> Objects;
+	std::vector<glm::mat4> Transforms;
+	std::vector<GLuint> Slots;
+	std::vector<InstanceTransform> SlotTransforms;	// object buffer contents, normal matrices filled in before the upload
+	std::vector<GLuint> MaterialFirst;
+	std::vector<GLuint> MaterialCount;
+	std::vector<GLuint> MaterialTextures;
+	bool CommandsDirty = false;
+	bool TransformsDirty = false;
+
+	GLuint VAO = 0;
+	GLuint VBO = 0;
+	GLuint EBO = 0;
+	GLuint ObjectBuffer = 0;
+	GLuint CommandBuffer = 0;
+	size_t ObjectCapacity = 0;
+	int DrawCalls = 0;
+
+	ShaderProgram* Program;
+	UniformHandle TextureHandle;
+	UniformHandle DrawOffsetHandle;
+};
@@ -0,0 +1,127 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Grass.cpp
+// Description    : generates visible grass blades every frame in a compute shader and draws them indirectly
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "Grass.h"
+#include "Frustum.h"
+#include "ProgramRegistry.h"
+
+// matches the layout glDrawArraysIndirect reads
+struct DrawArraysIndirectCommand
+{
+	GLuint Count;
+	GLuint InstanceCount;
+	GLuint First;
+	GLuint BaseInstance;
+};
+
+Grass::Grass(Terrain* Ground, GLuint DensityTextureID, std::map<std::string, GLuint>& ShaderMap)
+{
+	this->Ground = Ground;
+	this->DensityTextureID = DensityTextureID;
+
+	// create the programs
+	Program_Generate = ProgramRegistry::Get(PROGRAM_GRASS_GENERATE, ShaderMap);
+	Program_Render = ProgramRegistry::Get(PROGRAM_GRASS, ShaderMap);
+	CameraPosHandle = Program_Generate->GetUniform("CameraPos");
+	FrustumPlanesHandle = Program_Generate->GetUniform("FrustumPlanes");
+	RadiusHandle = Program_Generate->GetUniform("Radius");
+	SpacingHandle = Program_Generate->GetUniform("Spacing");
+	HalfExtentHandle = Program_Generate->GetUniform("HalfExtent");
+	GenerateBladeHeightHandle = Program_Generate->GetUniform("BladeHeight");
+	GridSideHandle = Program_Generate->GetUniform("GridSide");
+	HeightMapHandle = Program_Generate->GetUniform("HeightMap");
+	DensityMapHandle = Program_Generate->GetUniform("DensityMap");
+	ModelHandle = Program_Render->GetUniform("Model");
+	BladeHeightHandle = Program_Render->GetUniform("BladeHeight");
+	BladeWidthHandle = Program_Render->GetUniform("BladeWidth");
+
+	// every grid point can become a blade, so the buffer never overflows
+	GridSide = (int)ceil((2.0f * Radius) / Spacing);
+	glGenBuffers(1, &InstanceBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, InstanceBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, GetCandidateCount() * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	DrawArraysIndirectCommand Command = { 3, 0, 0, 0 };
+	glGenBuffers(1, &CommandBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, CommandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(Command), &Command, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	glGenVertexArrays(1, &VAO);
+}
+
+Grass::~Grass()
+{
+}
+
+void Grass::Render(const glm::mat4& CameraPV, glm::vec3 CameraPos)
+{
+	// everything is generated in terrain space
+	glm::mat4 ModelMat = Ground->GetModelMatrix();
+	Frustum ViewFrustum;
+	ViewFrustum.Extract(CameraPV * ModelMat);
+	glm::vec3 LocalCameraPos = glm::vec3(glm::inverse(ModelMat) * glm::vec4(CameraPos, 1.0f));
+
+	// reset the blade counter, the compute shader appends to it
+	DrawArraysIndirectCommand Command = { 3, 0, 0, 0 };
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, CommandBuffer);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(Command), &Command);
+
+	// generate and cull the blades
+	GLState::UseProgram(Program_Generate->GetID());
+	Program_Generate->SetVec3(CameraPosHandle, LocalCameraPos);
+	Program_Generate->SetVec4Array(FrustumPlanesHandle, ViewFrustum.GetPlanes(), 6);
+	Program_Generate->SetFloat(RadiusHandle, Radius);
+	Program_Generate->SetFloat(SpacingHandle, Spacing);
+	Program_Generate->SetFloat(HalfExtentHandle, Ground->GetHalfExtent());
+	Program_Generate->SetFloat(GenerateBladeHeightHandle, BladeHeight);
+	Program_Generate->SetInt(GridSideHandle, GridSide);
+
+	GLState::BindTexture(0, GL_TEXTURE_2D, Ground->GetHeightTexture());
+	Program_Generate->SetInt(HeightMapHandle, 0);
+	GLState::BindTexture(1, GL_TEXTURE_2D, DensityTextureID);
+	Program_Generate->SetInt(DensityMapHandle, 1);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, InstanceBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, CommandBuffer);
+	glDispatchCompute((GridSide + 7) / 8, (GridSide + 7) / 8, 1);
+
+	// the draw reads the count from the command buffer and the blades from the storage buffer
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// draw the blades, no cpu read back of the count
+	GLState::UseProgram(Program_Render->GetID());
+	Program_Render->SetMat4(ModelHandle, ModelMat);
+	Program_Render->SetFloat(BladeHeightHandle, BladeHeight);
+	Program_Render->SetFloat(BladeWidthHandle, BladeWidth);
+
+	GLState::BindVertexArray(VAO);
+	glDrawArraysIndirect(GL_TRIANGLES, 0);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+GLuint Grass::ReadInstanceCount()
+{
+	DrawArraysIndirectCommand Command;
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, CommandBuffer);
+	glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(Command), &Command);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	return Command.InstanceCount;
+}
+
+int Grass::GetCandidateCount() const
+{
+	return GridSide * GridSide;
+}
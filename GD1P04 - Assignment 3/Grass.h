@@ -0,0 +1,67 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Grass.h
+// Description    : class file for gpu generated grass (compute shader + indirect draw)
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glfw3.h>
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <gtc/type_ptr.hpp>
+#include <map>
+#include <string>
+#include "ShaderProgram.h"
+#include "GLState.h"
+#include "Terrain.h"
+
+class Grass
+{
+public:
+	Grass(Terrain* Ground, GLuint DensityTextureID, std::map<std::string, GLuint>& ShaderMap);
+	~Grass();
+	void Render(const glm::mat4& CameraPV, glm::vec3 CameraPos);
+
+	// reads the blade count back from the gpu, this waits for the frame so only use it for stats
+	GLuint ReadInstanceCount();
+	int GetCandidateCount() const;
+
+private:
+	Terrain* Ground;
+	GLuint DensityTextureID;
+	ShaderProgram* Program_Generate;
+	ShaderProgram* Program_Render;
+
+	// uniform handles, looked up once when the programs are created
+	UniformHandle CameraPosHandle;
+	UniformHandle FrustumPlanesHandle;
+	UniformHandle RadiusHandle;
+	UniformHandle SpacingHandle;
+	UniformHandle HalfExtentHandle;
+	UniformHandle GenerateBladeHeightHandle;
+	UniformHandle GridSideHandle;
+	UniformHandle HeightMapHandle;
+	UniformHandle DensityMapHandle;
+	UniformHandle ModelHandle;
+	UniformHandle BladeHeightHandle;
+	UniformHandle BladeWidthHandle;
+
+	GLuint VAO;	// no vertex data, the blades are built from gl_VertexID and gl_InstanceID
+	GLuint InstanceBuffer;
+	GLuint CommandBuffer;
+
+	// blades are generated on a grid of this spacing within the radius around the camera (terrain space)
+	float Radius = 60.0f;
+	float Spacing = 0.25f;
+	int GridSide;
+	float BladeHeight = 0.8f;
+	float BladeWidth = 0.12f;
+};
@@ -0,0 +1,304 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : LightClusters.cpp
+// Description    : builds the per cluster light lists on worker threads and uploads them for the lit shaders
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "LightClusters.h"
+#include "CPUProfiler.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+
+// true when the sphere touches the box
+static bool SphereTouchesBox(glm::vec3 Center, float Radius, glm::vec3 BoxMin, glm::vec3 BoxMax)
+{
+	glm::vec3 Closest = glm::clamp(Center, BoxMin, BoxMax);
+	glm::vec3 Offset = Center - Closest;
+	return glm::dot(Offset, Offset) <= (Radius * Radius);
+}
+
+LightClusters::LightClusters(int GridX, int GridY, int GridZ, RingBuffer* Ring)
+{
+	this->Ring = Ring;
+	this->GridX = GridX;
+	this->GridY = GridY;
+	this->GridZ = GridZ;
+	SliceLights.resize(GridZ);
+
+	glGenBuffers(1, &UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(ClusterBlock), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// the cluster table has a fixed size, the index list grows with the lights
+	glGenBuffers(1, &ClusterBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ClusterBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, GridX * GridY * GridZ * sizeof(glm::uvec2), nullptr, GL_DYNAMIC_DRAW);
+	glGenBuffers(1, &IndexBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+LightClusters::~LightClusters()
+{
+	glDeleteBuffers(1, &UBO);
+	glDeleteBuffers(1, &ClusterBuffer);
+	glDeleteBuffers(1, &IndexBuffer);
+}
+
+void LightClusters::Build(const glm::mat4& View, const glm::mat4& Projection, float Near, float Far, glm::vec2 ScreenSize, const std::vector<PointLight>& Lights)
+{
+	PROFILE_FUNCTION();
+	std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+
+	if (ClusterMin.empty() || Projection != BoundsProjection || Near != BoundsNear || Far != BoundsFar)
+	{
+		BuildBounds(Projection, Near, Far);
+	}
+
+	// move the lights into view space and sort them into the depth slices they reach
+	float SliceScale = GridZ / log(Far / Near);
+	std::vector<glm::vec4> ViewLights(Lights.size());
+	for (int k = 0; k < GridZ; k++)
+	{
+		SliceLights[k].clear();
+	}
+	for (size_t i = 0; i < Lights.size(); i++)
+	{
+		glm::vec3 Center = glm::vec3(View * glm::vec4(Lights[i].Position, 1.0f));
+		float Radius = Lights[i].Radius;
+		ViewLights[i] = glm::vec4(Center, Radius);
+
+		float MinDepth = -Center.z - Radius;
+		float MaxDepth = -Center.z + Radius;
+		if (MaxDepth < Near || MinDepth > Far)
+		{
+			continue;
+		}
+		int FirstSlice = (MinDepth <= Near) ? 0 : (int)(log(MinDepth / Near) * SliceScale);
+		int LastSlice = (MaxDepth >= Far) ? (GridZ - 1) : (int)(log(MaxDepth / Near) * SliceScale);
+		FirstSlice = glm::clamp(FirstSlice, 0, GridZ - 1);
+		LastSlice = glm::clamp(LastSlice, 0, GridZ - 1);
+		for (int k = FirstSlice; k <= LastSlice; k++)
+		{
+			SliceLights[k].push_back((GLuint)i);
+		}
+	}
+
+	// every slice is independent, the workers write to their own index list and their own part of the range table
+	int ClustersPerSlice = GridX * GridY;
+	std::vector<glm::uvec2> Ranges(ClustersPerSlice * GridZ);
+	std::vector<std::vector<GLuint>> SliceIndices(GridZ);
+	auto AssignJob = [&](int k)
+	{
+		PROFILE_SCOPE("Assign slice");
+		AssignSlice(k, ViewLights, SliceIndices[k], &Ranges[k * ClustersPerSlice]);
+	};
+	WorkerPool::ParallelFor(GridZ, AssignJob);
+
+	// join the slices into one index list
+	std::vector<GLuint> Indices;
+	for (int k = 0; k < GridZ; k++)
+	{
+		GLuint Base = (GLuint)Indices.size();
+		for (int c = 0; c < ClustersPerSlice; c++)
+		{
+			Ranges[(k * ClustersPerSlice) + c].x += Base;
+		}
+		Indices.insert(Indices.end(), SliceIndices[k].begin(), SliceIndices[k].end());
+	}
+	IndexCount = Indices.size();
+
+	// upload and bind for the lit programs
+	ClusterBlock Block;
+	Block.View = View;
+	Block.GridSize = glm::uvec4(GridX, GridY, GridZ, 0);
+	Block.Params = glm::vec4(Near, Far, SliceScale, 0.0f);
+	Block.ScreenSize = glm::vec4(ScreenSize, 0.0f, 0.0f);
+	if (Ring == nullptr || UploadToRing(Block, Ranges, Indices) == false)
+	{
+		UploadToBuffers(Block, Ranges, Indices);
+	}
+
+	BuildTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+void LightClusters::AssignSlice(int Slice, const std::vector<glm::vec4>& ViewLights, std::vector<GLuint>& Indices, glm::uvec2* Ranges) const
+{
+	int ClustersPerSlice = GridX * GridY;
+	int SliceStart = Slice * ClustersPerSlice;
+
+	// find every (cluster, light) pair in the slice, rows that miss the light are skipped whole
+	std::vector<glm::uvec2> Pairs;
+	const std::vector<GLuint>& Candidates = SliceLights[Slice];
+	for (size_t i = 0; i < Candidates.size(); i++)
+	{
+		glm::vec4 Light = ViewLights[Candidates[i]];
+		glm::vec3 Center = glm::vec3(Light);
+		for (int y = 0; y < GridY; y++)
+		{
+			int Row = (Slice * GridY) + y;
+			if (!SphereTouchesBox(Center, Light.w, RowMin[Row], RowMax[Row]))
+			{
+				continue;
+			}
+			for (int x = 0; x < GridX; x++)
+			{
+				int Cluster = SliceStart + (y * GridX) + x;
+				if (SphereTouchesBox(Center, Light.w, ClusterMin[Cluster], ClusterMax[Cluster]))
+				{
+					Pairs.push_back(glm::uvec2((y * GridX) + x, Candidates[i]));
+				}
+			}
+		}
+	}
+
+	// counting sort by cluster so each cluster's lights are contiguous
+	for (int c = 0; c < ClustersPerSlice; c++)
+	{
+		Ranges[c] = glm::uvec2(0);
+	}
+	for (size_t p = 0; p < Pairs.size(); p++)
+	{
+		Ranges[Pairs[p].x].y++;
+	}
+	GLuint Offset = 0;
+	for (int c = 0; c < ClustersPerSlice; c++)
+	{
+		Ranges[c].x = Offset;
+		Offset += Ranges[c].y;
+	}
+
+	Indices.resize(Pairs.size());
+	std::vector<GLuint> Fill(ClustersPerSlice, 0);
+	for (size_t p = 0; p < Pairs.size(); p++)
+	{
+		GLuint Cluster = Pairs[p].x;
+		Indices[Ranges[Cluster].x + Fill[Cluster]++] = Pairs[p].y;
+	}
+}
+
+// writes the three tables into this frame's part of the ring and binds the ranges, false when they do not fit
+bool LightClusters::UploadToRing(const ClusterBlock& Block, const std::vector<glm::uvec2>& Ranges, const std::vector<GLuint>& Indices)
+{
+	GLsizeiptr RangeBytes = Ranges.size() * sizeof(glm::uvec2);
+	GLsizeiptr IndexBytes = glm::max(Indices.size(), (size_t)1) * sizeof(GLuint);
+	RingAllocation BlockRange = Ring->Allocate(sizeof(Block), Ring->GetUniformAlignment());
+	RingAllocation TableRange = Ring->Allocate(RangeBytes, Ring->GetStorageAlignment());
+	RingAllocation IndexRange = Ring->Allocate(IndexBytes, Ring->GetStorageAlignment());
+	if (BlockRange.Data == nullptr || TableRange.Data == nullptr || IndexRange.Data == nullptr)
+	{
+		return false;
+	}
+
+	memcpy(BlockRange.Data, &Block, sizeof(Block));
+	memcpy(TableRange.Data, Ranges.data(), RangeBytes);
+	memcpy(IndexRange.Data, Indices.data(), Indices.size() * sizeof(GLuint));
+
+	glBindBufferRange(GL_UNIFORM_BUFFER, CLUSTER_BLOCK_BINDING, Ring->GetBufferID(), BlockRange.Offset, BlockRange.Size);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, CLUSTER_BUFFER_BINDING, Ring->GetBufferID(), TableRange.Offset, TableRange.Size);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, LIGHT_INDEX_BUFFER_BINDING, Ring->GetBufferID(), IndexRange.Offset, IndexRange.Size);
+	return true;
+}
+
+// fallback when there is no ring (or it is full), the buffers are updated in place
+void LightClusters::UploadToBuffers(const ClusterBlock& Block, const std::vector<glm::uvec2>& Ranges, const std::vector<GLuint>& Indices)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &Block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ClusterBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, Ranges.size() * sizeof(glm::uvec2), Ranges.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, IndexBuffer);
+	if (Indices.size() > IndexCapacity || IndexCapacity == 0)
+	{
+		IndexCapacity = glm::max(IndexCapacity, (size_t)1024);
+		while (IndexCapacity < Indices.size())
+		{
+			IndexCapacity *= 2;
+		}
+		glBufferData(GL_SHADER_STORAGE_BUFFER, IndexCapacity * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+	}
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, Indices.size() * sizeof(GLuint), Indices.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, CLUSTER_BLOCK_BINDING, UBO);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_BUFFER_BINDING, ClusterBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_INDEX_BUFFER_BINDING, IndexBuffer);
+}
+
+void LightClusters::BuildBounds(const glm::mat4& Projection, float Near, float Far)
+{
+	BoundsProjection = Projection;
+	BoundsNear = Near;
+	BoundsFar = Far;
+
+	int ClusterCount = GridX * GridY * GridZ;
+	ClusterMin.resize(ClusterCount);
+	ClusterMax.resize(ClusterCount);
+	RowMin.resize(GridY * GridZ);
+	RowMax.resize(GridY * GridZ);
+
+	for (int k = 0; k < GridZ; k++)
+	{
+		// exponential slices keep the clusters roughly cube shaped
+		float SliceNear = Near * pow(Far / Near, (float)k / GridZ);
+		float SliceFar = Near * pow(Far / Near, (float)(k + 1) / GridZ);
+		float Depths[2] = { SliceNear, SliceFar };
+
+		for (int y = 0; y < GridY; y++)
+		{
+			int Row = (k * GridY) + y;
+			RowMin[Row] = glm::vec3(FLT_MAX);
+			RowMax[Row] = glm::vec3(-FLT_MAX);
+
+			for (int x = 0; x < GridX; x++)
+			{
+				// corners of the screen tile pushed out to both depths (inverse of the projection for a point at that depth)
+				glm::vec2 TileMin = glm::vec2(-1.0f + ((2.0f * x) / GridX), -1.0f + ((2.0f * y) / GridY));
+				glm::vec2 TileMax = glm::vec2(-1.0f + ((2.0f * (x + 1)) / GridX), -1.0f + ((2.0f * (y + 1)) / GridY));
+				glm::vec3 BoxMin = glm::vec3(FLT_MAX);
+				glm::vec3 BoxMax = glm::vec3(-FLT_MAX);
+				for (int d = 0; d < 2; d++)
+				{
+					for (int c = 0; c < 4; c++)
+					{
+						glm::vec2 Ndc = glm::vec2((c & 1) ? TileMax.x : TileMin.x, (c & 2) ? TileMax.y : TileMin.y);
+						glm::vec3 Corner;
+						Corner.x = Depths[d] * (Ndc.x + Projection[2][0]) / Projection[0][0];
+						Corner.y = Depths[d] * (Ndc.y + Projection[2][1]) / Projection[1][1];
+						Corner.z = -Depths[d];
+						BoxMin = glm::min(BoxMin, Corner);
+						BoxMax = glm::max(BoxMax, Corner);
+					}
+				}
+
+				int Cluster = (Row * GridX) + x;
+				ClusterMin[Cluster] = BoxMin;
+				ClusterMax[Cluster] = BoxMax;
+				RowMin[Row] = glm::min(RowMin[Row], BoxMin);
+				RowMax[Row] = glm::max(RowMax[Row], BoxMax);
+			}
+		}
+	}
+}
+
+size_t LightClusters::GetIndexCount() const
+{
+	return IndexCount;
+}
+
+double LightClusters::GetBuildTime() const
+{
+	return BuildTime;
+}
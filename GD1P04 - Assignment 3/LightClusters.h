@@ -0,0 +1,79 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : LightClusters.h
+// Description    : class file for the clustered light grid, lights are assigned to view space clusters every frame
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <vector>
+#include "LightManager.h"
+#include "RingBuffer.h"
+
+// injected into every shader by ShaderLoader, Lit.fs declares its blocks with these
+#define CLUSTER_BLOCK_BINDING 1			// uniform buffer
+#define CLUSTER_BUFFER_BINDING 3		// shader storage buffer, offset and count per cluster
+#define LIGHT_INDEX_BUFFER_BINDING 4	// shader storage buffer, light indices of all clusters
+
+// screen tiles in x and y, exponential depth slices in z
+class LightClusters
+{
+public:
+	// the per frame tables go through the upload ring when one is given
+	LightClusters(int GridX, int GridY, int GridZ, RingBuffer* Ring);
+	~LightClusters();
+
+	// assigns the lights to clusters on the shared worker pool, uploads the result and binds the buffers
+	void Build(const glm::mat4& View, const glm::mat4& Projection, float Near, float Far, glm::vec2 ScreenSize, const std::vector<PointLight>& Lights);
+
+	size_t GetIndexCount() const;
+	double GetBuildTime() const;
+
+private:
+	// contents of the uniform buffer, copied as is
+	struct ClusterBlock
+	{
+		glm::mat4 View;
+		glm::uvec4 GridSize;
+		glm::vec4 Params;	// near, far, slices / log(far / near), unused
+		glm::vec4 ScreenSize;
+	};
+
+	void BuildBounds(const glm::mat4& Projection, float Near, float Far);
+	void AssignSlice(int Slice, const std::vector<glm::vec4>& ViewLights, std::vector<GLuint>& Indices, glm::uvec2* Ranges) const;
+	bool UploadToRing(const ClusterBlock& Block, const std::vector<glm::uvec2>& Ranges, const std::vector<GLuint>& Indices);
+	void UploadToBuffers(const ClusterBlock& Block, const std::vector<glm::uvec2>& Ranges, const std::vector<GLuint>& Indices);
+
+	int GridX;
+	int GridY;
+	int GridZ;
+
+	// view space bounds of every cluster, rebuilt when the projection changes
+	glm::mat4 BoundsProjection;
+	float BoundsNear = 0.0f;
+	float BoundsFar = 0.0f;
+	std::vector<glm::vec3> ClusterMin;
+	std::vector<glm::vec3> ClusterMax;
+	std::vector<glm::vec3> RowMin;		// union of the clusters in one row of a slice
+	std::vector<glm::vec3> RowMax;
+
+	// lights touching each slice, filled before the slices are handed to the workers
+	std::vector<std::vector<GLuint>> SliceLights;
+
+	RingBuffer* Ring;
+	GLuint UBO = 0;
+	GLuint ClusterBuffer = 0;
+	GLuint IndexBuffer = 0;
+	size_t IndexCapacity = 0;
+	size_t IndexCount = 0;
+	double BuildTime = 0.0;
+};
@@ -12,63 +12,150 @@
 //
 
 #include "LightManager.h"
+#include <cfloat>
 
 LightManager::LightManager()
 {
 	// light source arrays
-	PointLights[0].Position = glm::vec3(-4.0f, 4.0f, 5.0f);
-	PointLights[0].Color = glm::vec3(0.0f, 1.0f, 0.0f);
-	PointLights[0].AmbientStrength = 0.03f;
-	PointLights[0].LightSpecularStrength = 1.0f;
-	PointLights[0].AttenuationConstant = 1.0f;
-	PointLights[0].AttenuationLinear = 0.045f;
-	PointLights[0].AttenuationExponent = 0.0075f;
-
-	PointLights[1].Position = glm::vec3(4.0f, -4.0f, 5.0f);
-	PointLights[1].Color = glm::vec3(1.0f, 0.0f, 0.0f);
-	PointLights[1].AmbientStrength = 0.03f;
-	PointLights[1].LightSpecularStrength = 1.0f;
-	PointLights[1].AttenuationConstant = 1.0f;
-	PointLights[1].AttenuationLinear = 0.022f;
-	PointLights[1].AttenuationExponent = 0.0019f;
+	PointLight Light;
+	Light.Position = glm::vec3(-4.0f, 4.0f, 5.0f);
+	Light.Color = glm::vec3(0.0f, 1.0f, 0.0f);
+	Light.AmbientStrength = 0.03f;
+	Light.LightSpecularStrength = 1.0f;
+	Light.AttenuationConstant = 1.0f;
+	Light.AttenuationLinear = 0.045f;
+	Light.AttenuationExponent = 0.0075f;
+	AddPointLight(Light);
+
+	Light.Position = glm::vec3(4.0f, -4.0f, 5.0f);
+	Light.Color = glm::vec3(1.0f, 0.0f, 0.0f);
+	Light.AmbientStrength = 0.03f;
+	Light.LightSpecularStrength = 1.0f;
+	Light.AttenuationConstant = 1.0f;
+	Light.AttenuationLinear = 0.022f;
+	Light.AttenuationExponent = 0.0019f;
+	AddPointLight(Light);
 
 	// directional light
-	DirLight.Direction = glm::vec3(-1.0f, -1.0f, 0.0f);
-	DirLight.Color = glm::vec3(1.0f, 1.0f, 1.0f);
-	DirLight.AmbientStrength = 0.02f;
-	DirLight.LightSpecularStrength = 1.0f;
+	Lights.DirLight.Direction = glm::vec3(-1.0f, -1.0f, 0.0f);
+	Lights.DirLight.Color = glm::vec3(1.0f, 1.0f, 1.0f);
+	Lights.DirLight.AmbientStrength = 0.02f;
+	Lights.DirLight.LightSpecularStrength = 1.0f;
+
+	Lights.Shininess = 32.0f;
+	Lights.Padding[0] = 0.0f;
+	Lights.Padding[1] = 0.0f;
 
+	glGenBuffers(1, &UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlock), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glGenBuffers(1, &LightBuffer);
 }
 
 LightManager::~LightManager()
 {
+	glDeleteBuffers(1, &UBO);
+	glDeleteBuffers(1, &LightBuffer);
+}
+
+void LightManager::Bind()
+{
+	if (PointLightsDirty)
+	{
+		// grow the storage buffer in powers of two so adding lights one by one does not reallocate every time
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, LightBuffer);
+		if (PointLights.size() > LightBufferCapacity || LightBufferCapacity == 0)
+		{
+			LightBufferCapacity = glm::max(LightBufferCapacity, (size_t)16);
+			while (LightBufferCapacity < PointLights.size())
+			{
+				LightBufferCapacity *= 2;
+			}
+			glBufferData(GL_SHADER_STORAGE_BUFFER, LightBufferCapacity * sizeof(PointLight), nullptr, GL_DYNAMIC_DRAW);
+		}
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, PointLights.size() * sizeof(PointLight), PointLights.data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		PointLightsDirty = false;
+		Dirty = true;
+	}
+
+	if (Dirty)
+	{
+		Lights.PointLightCount = (GLint)PointLights.size();
+		glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightBlock), &Lights);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		Dirty = false;
+		UploadCount++;
+	}
+	glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, UBO);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_BUFFER_BINDING, LightBuffer);
+}
+
+int LightManager::AddPointLight(const PointLight& Light)
+{
+	PointLights.push_back(Light);
+	PointLights.back().Radius = CalculateRadius(Light);
+	PointLightsDirty = true;
+	return (int)PointLights.size() - 1;
+}
+
+void LightManager::SetPointLight(int Index, const PointLight& Light)
+{
+	PointLights[Index] = Light;
+	PointLights[Index].Radius = CalculateRadius(Light);
+	PointLightsDirty = true;
+}
+
+void LightManager::ClearPointLights()
+{
+	PointLights.clear();
+	PointLightsDirty = true;
 }
 
-void LightManager::Render(GLuint program)
-{	
-	glUniform1f(glGetUniformLocation(program, "Shininess"), Shininess);
-
-	// accessed point lights (first)
-	glUniform3fv(glGetUniformLocation(program, "PointLights[0].Position"), 1, glm::value_ptr(PointLights[0].Position));
-	glUniform3fv(glGetUniformLocation(program, "PointLights[0].Color"), 1, glm::value_ptr(PointLights[0].Color));
-	glUniform1f(glGetUniformLocation(program, "PointLights[0].AmbientStrength"), PointLights[0].AmbientStrength);
-	glUniform1f(glGetUniformLocation(program, "PointLights[0].LightSpecularStrength"), PointLights[0].LightSpecularStrength);
-	glUniform1f(glGetUniformLocation(program, "PointLights[0].AttenuationConstant"), PointLights[0].AttenuationConstant);
-	glUniform1f(glGetUniformLocation(program, "PointLights[0].AttenuationLinear"), PointLights[0].AttenuationLinear);
-	glUniform1f(glGetUniformLocation(program, "PointLights[0].AttenuationExponent"), PointLights[0].AttenuationExponent);
-
-	// accessed point lights (second)
-	glUniform3fv(glGetUniformLocation(program, "PointLights[1].Position"), 1, glm::value_ptr(PointLights[1].Position));
-	glUniform3fv(glGetUniformLocation(program, "PointLights[1].Color"), 1, glm::value_ptr(PointLights[1].Color));
-	glUniform1f(glGetUniformLocation(program, "PointLights[1].AmbientStrength"), PointLights[1].AmbientStrength);
-	glUniform1f(glGetUniformLocation(program, "PointLights[1].LightSpecularStrength"), PointLights[1].LightSpecularStrength);
-	glUniform1f(glGetUniformLocation(program, "PointLights[1].AttenuationConstant"), PointLights[1].AttenuationConstant);
-	glUniform1f(glGetUniformLocation(program, "PointLights[1].AttenuationLinear"), PointLights[1].AttenuationLinear);
-	glUniform1f(glGetUniformLocation(program, "PointLights[1].AttenuationExponent"), PointLights[1].AttenuationExponent);
-
-	// accessed directional lights
-	glUniform3fv(glGetUniformLocation(program, "DirLight.Direction"), 1, glm::value_ptr(DirLight.Direction));
-	glUniform3fv(glGetUniformLocation(program, "DirLight.Color"), 1, glm::value_ptr(DirLight.Color));
-	glUniform1f(glGetUniformLocation(program, "DirLight.AmbientStrength"), DirLight.AmbientStrength);
-	glUniform1f(glGetUniformLocation(program, "DirLightLightSpecularStrength"), DirLight.LightSpecularStrength);
+void LightManager::SetDirectionalLight(const DirectionalLight& Light)
+{
+	Lights.DirLight = Light;
+	Dirty = true;
+}
+
+void LightManager::SetShininess(float Shininess)
+{
+	Lights.Shininess = Shininess;
+	Dirty = true;
+}
+
+const std::vector<PointLight>& LightManager::GetPointLights() const
+{
+	return PointLights;
+}
+
+int LightManager::GetPointLightCount() const
+{
+	return (int)PointLights.size();
+}
+
+int LightManager::GetUploadCount() const
+{
+	return UploadCount;
+}
+
+float LightManager::CalculateRadius(const PointLight& Light)
+{
+	// solve constant + linear * d + exponent * d^2 = 256 * brightness, past that the light adds less than one step of colour
+	float Brightness = glm::max(glm::max(Light.Color.r, Light.Color.g), Light.Color.b)
+		* (1.0f + Light.AmbientStrength + Light.LightSpecularStrength);
+	float Target = (256.0f * Brightness) - Light.AttenuationConstant;
+	if (Target <= 0.0f)
+	{
+		return 0.0f;
+	}
+	if (Light.AttenuationExponent <= 0.0f)
+	{
+		return (Light.AttenuationLinear > 0.0f) ? (Target / Light.AttenuationLinear) : FLT_MAX;
+	}
+	float Linear = Light.AttenuationLinear;
+	return (-Linear + sqrt((Linear * Linear) + (4.0f * Light.AttenuationExponent * Target))) / (2.0f * Light.AttenuationExponent);
 }
@@ -17,40 +17,72 @@
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <gtc/type_ptr.hpp>
-#define MAX_POINT_LIGHTS 4
+#include <vector>
 
-// creating struct for light manager
+// injected into every shader by ShaderLoader, Lit.fs declares its blocks with these
+#define LIGHT_BLOCK_BINDING 0		// uniform buffer
+#define LIGHT_BUFFER_BINDING 2		// shader storage buffer (0 and 1 are used by the grass)
+
+// creating struct for light manager (std140/std430 layout, vec3 members are followed by a float to fill the slot)
 struct PointLight
 {
 	glm::vec3 Position;
-	glm::vec3 Color;
 	float AmbientStrength;
+	glm::vec3 Color;
 	float LightSpecularStrength;
 
 	float AttenuationConstant;
 	float AttenuationLinear;
 	float AttenuationExponent;
+	float Radius;		// distance where the light falls below 1/256, filled in by the light manager
 };
 
 // creating struct for directional lights
 struct DirectionalLight
 {
 	glm::vec3 Direction;
-	glm::vec3 Color;
 	float AmbientStrength;
+	glm::vec3 Color;
 	float LightSpecularStrength;
 };
 
+// contents of the uniform buffer, copied as is (the point lights live in their own storage buffer)
+struct LightBlock
+{
+	DirectionalLight DirLight;
+	GLint PointLightCount;
+	float Shininess;
+	float Padding[2];
+};
+static_assert(sizeof(PointLight) == 48 && sizeof(DirectionalLight) == 32, "light structs must follow the std140 layout");
+
 class LightManager
 {
 public:
 	LightManager();
 	~LightManager();
-	void Render(GLuint program);
+
+	// uploads the lights if anything changed and binds them for every lit program, once per frame
+	void Bind();
+
+	int AddPointLight(const PointLight& Light);
+	void SetPointLight(int Index, const PointLight& Light);
+	void ClearPointLights();
+	void SetDirectionalLight(const DirectionalLight& Light);
+	void SetShininess(float Shininess);
+	const std::vector<PointLight>& GetPointLights() const;
+	int GetPointLightCount() const;
+	int GetUploadCount() const;
 
 private:
-	PointLight PointLights[MAX_POINT_LIGHTS];
-	DirectionalLight DirLight;
-	float Shininess = 32.0f;
-};
+	static float CalculateRadius(const PointLight& Light);
 
+	LightBlock Lights;
+	std::vector<PointLight> PointLights;
+	GLuint UBO = 0;
+	GLuint LightBuffer = 0;
+	size_t LightBufferCapacity = 0;
+	bool Dirty = true;
+	bool PointLightsDirty = true;
+	int UploadCount = 0;
+};
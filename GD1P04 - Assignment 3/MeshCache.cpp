@@ -0,0 +1,123 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : MeshCache.cpp
+// Description    : builds and uploads each primitive once and hands out the shared buffers
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "MeshCache.h"
+#include "GLState.h"
+#include "Sphere.h"
+#include <glm.hpp>
+#include <vector>
+
+#define MESH_PRIMITIVE_SPHERE 0
+
+std::map<MeshCache::MeshKey, CachedMesh> MeshCache::Meshes;
+int MeshCache::RequestCount = 0;
+
+bool MeshCache::MeshKey::operator<(const MeshKey& Other) const
+{
+	if (Primitive != Other.Primitive)
+	{
+		return Primitive < Other.Primitive;
+	}
+	if (Radius != Other.Radius)
+	{
+		return Radius < Other.Radius;
+	}
+	return Fidelity < Other.Fidelity;
+}
+
+const CachedMesh& MeshCache::GetSphere(float Radius, int Fidelity)
+{
+	RequestCount++;
+
+	MeshKey Key = { MESH_PRIMITIVE_SPHERE, Radius, Fidelity };
+	std::map<MeshKey, CachedMesh>::const_iterator Found = Meshes.find(Key);
+	if (Found != Meshes.end())
+	{
+		return Found->second;
+	}
+
+	std::vector<GLfloat> Vertices;
+	std::vector<GLuint> Indices;
+	Sphere::BuildGeometry(Radius, Fidelity, Vertices, Indices);
+	return Meshes[Key] = Upload(Vertices.data(), Vertices.size(), Indices.data(), Indices.size());
+}
+
+CachedMesh MeshCache::Upload(const float* Vertices, size_t VertexFloatCount, const unsigned int* Indices, size_t IndexCount)
+{
+	CachedMesh Mesh;
+	Mesh.IndexCount = (int)IndexCount;
+
+	// Create the Vertex Array and associated buffers
+	glGenVertexArrays(1, &Mesh.VAO);
+	GLState::BindVertexArray(Mesh.VAO);
+	glGenBuffers(1, &Mesh.VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, Mesh.VBO);
+	glBufferData(GL_ARRAY_BUFFER, VertexFloatCount * sizeof(GLfloat), Vertices, GL_STATIC_DRAW);
+	glGenBuffers(1, &Mesh.EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Mesh.EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, IndexCount * sizeof(GLuint), Indices, GL_STATIC_DRAW);
+	SetVertexLayout();
+
+	return Mesh;
+}
+
+// Vertex Information (Position, Texture Coords and Normals), reads the bound GL_ARRAY_BUFFER
+void MeshCache::SetVertexLayout()
+{
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(5 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(2);
+}
+
+GLuint MeshCache::CreateInstancedVAO(const CachedMesh& Mesh, GLuint InstanceVBO)
+{
+	GLuint VAO;
+	glGenVertexArrays(1, &VAO);
+	GLState::BindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, Mesh.VBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Mesh.EBO);
+	SetVertexLayout();
+
+	// per instance model matrix, one column per attribute location (3 - 6)
+	glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+	for (int i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (void*)(offsetof(InstanceTransform, Model) + (i * sizeof(glm::vec4))));
+		glEnableVertexAttribArray(3 + i);
+		glVertexAttribDivisor(3 + i, 1);
+	}
+
+	// and its normal matrix, three vec4 columns read as a mat3 (7 - 9)
+	for (int i = 0; i < 3; i++)
+	{
+		glVertexAttribPointer(7 + i, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (void*)(offsetof(InstanceTransform, Normal) + (i * sizeof(glm::vec4))));
+		glEnableVertexAttribArray(7 + i);
+		glVertexAttribDivisor(7 + i, 1);
+	}
+	GLState::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return VAO;
+}
+
+size_t MeshCache::GetMeshCount()
+{
+	return Meshes.size();
+}
+
+int MeshCache::GetRequestCount()
+{
+	return RequestCount;
+}
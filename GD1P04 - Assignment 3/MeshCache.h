@@ -0,0 +1,58 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : MeshCache.h
+// Description    : class file for the shared mesh cache, identical primitives are built and uploaded once
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <map>
+#include "NormalMatrix.h"
+
+// gpu buffers of one primitive, the VAO uses attribute locations 0 - 2 (position, texture coords, normal)
+struct CachedMesh
+{
+	GLuint VAO;
+	GLuint VBO;
+	GLuint EBO;
+	int IndexCount;
+};
+
+class MeshCache
+{
+public:
+	// returns the shared mesh, it is built the first time these parameters are asked for
+	static const CachedMesh& GetSphere(float Radius, int Fidelity);
+
+	// new VAO over the shared buffers reading an InstanceTransform per instance, model matrix at locations 3 - 6, normal matrix at 7 - 9
+	static GLuint CreateInstancedVAO(const CachedMesh& Mesh, GLuint InstanceVBO);
+
+	static size_t GetMeshCount();
+	static int GetRequestCount();
+
+private:
+	MeshCache(void);
+	~MeshCache(void);
+
+	// primitive parameters, every field takes part in the comparison
+	struct MeshKey
+	{
+		int Primitive;
+		float Radius;
+		int Fidelity;
+		bool operator<(const MeshKey& Other) const;
+	};
+
+	static CachedMesh Upload(const float* Vertices, size_t VertexFloatCount, const unsigned int* Indices, size_t IndexCount);
+	static void SetVertexLayout();
+
+	static std::map<MeshKey, CachedMesh> Meshes;
+	static int RequestCount;
+};
@@ -0,0 +1,121 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : NormalMatrix.cpp
+// Description    : normal matrices (inverse transpose of the model matrix) computed on the cpu with sse
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "NormalMatrix.h"
+#include <gtc/type_ptr.hpp>
+
+// sse2 is part of every x64 target, other targets use the scalar version
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define NORMAL_MATRIX_SSE 1
+#else
+#define NORMAL_MATRIX_SSE 0
+#endif
+
+#if NORMAL_MATRIX_SSE
+// a x b, the w lane stays 0 when both w lanes are 0
+static inline __m128 Cross(__m128 A, __m128 B)
+{
+	__m128 AYZX = _mm_shuffle_ps(A, A, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 BYZX = _mm_shuffle_ps(B, B, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 Result = _mm_sub_ps(_mm_mul_ps(A, BYZX), _mm_mul_ps(AYZX, B));
+	return _mm_shuffle_ps(Result, Result, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+// a . b in every lane
+static inline __m128 Dot(__m128 A, __m128 B)
+{
+	__m128 Product = _mm_mul_ps(A, B);
+	Product = _mm_add_ps(Product, _mm_shuffle_ps(Product, Product, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_add_ps(Product, _mm_shuffle_ps(Product, Product, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+#endif
+
+// columns of the inverse transpose of the upper 3x3 are c1 x c2, c2 x c0 and c0 x c1 over the determinant,
+// written as three vec4 columns (12 floats)
+static inline void ComputeOne(const float* Model, float* Normal)
+{
+#if NORMAL_MATRIX_SSE
+	// the w lanes are masked off, the first three columns of an affine matrix have 0 there anyway
+	const __m128 Mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	__m128 C0 = _mm_and_ps(_mm_loadu_ps(Model + 0), Mask);
+	__m128 C1 = _mm_and_ps(_mm_loadu_ps(Model + 4), Mask);
+	__m128 C2 = _mm_and_ps(_mm_loadu_ps(Model + 8), Mask);
+
+	__m128 N0 = Cross(C1, C2);
+	__m128 N1 = Cross(C2, C0);
+	__m128 N2 = Cross(C0, C1);
+
+	__m128 Determinant = Dot(C0, N0);
+	if (_mm_cvtss_f32(Determinant) != 0.0f)
+	{
+		__m128 Scale = _mm_div_ps(_mm_set1_ps(1.0f), Determinant);
+		N0 = _mm_mul_ps(N0, Scale);
+		N1 = _mm_mul_ps(N1, Scale);
+		N2 = _mm_mul_ps(N2, Scale);
+	}
+
+	_mm_storeu_ps(Normal + 0, N0);
+	_mm_storeu_ps(Normal + 4, N1);
+	_mm_storeu_ps(Normal + 8, N2);
+#else
+	glm::vec3 C0 = glm::make_vec3(Model + 0);
+	glm::vec3 C1 = glm::make_vec3(Model + 4);
+	glm::vec3 C2 = glm::make_vec3(Model + 8);
+
+	glm::vec3 N0 = glm::cross(C1, C2);
+	glm::vec3 N1 = glm::cross(C2, C0);
+	glm::vec3 N2 = glm::cross(C0, C1);
+
+	float Determinant = glm::dot(C0, N0);
+	if (Determinant != 0.0f)
+	{
+		N0 /= Determinant;
+		N1 /= Determinant;
+		N2 /= Determinant;
+	}
+
+	const glm::vec3 Columns[3] = { N0, N1, N2 };
+	for (int c = 0; c < 3; c++)
+	{
+		Normal[(c * 4) + 0] = Columns[c].x;
+		Normal[(c * 4) + 1] = Columns[c].y;
+		Normal[(c * 4) + 2] = Columns[c].z;
+		Normal[(c * 4) + 3] = 0.0f;
+	}
+#endif
+}
+
+glm::mat4 NormalMatrix::Compute(const glm::mat4& Model)
+{
+	// the last column keeps the identity's 0 0 0 1
+	glm::mat4 Normal;
+	ComputeOne(glm::value_ptr(Model), glm::value_ptr(Normal));
+	return Normal;
+}
+
+void NormalMatrix::ComputeBatch(const glm::mat4* Models, glm::mat4* Normals, size_t Count)
+{
+	for (size_t i = 0; i < Count; i++)
+	{
+		Normals[i] = Compute(Models[i]);
+	}
+}
+
+void NormalMatrix::ComputeBatch(InstanceTransform* Transforms, size_t Count)
+{
+	for (size_t i = 0; i < Count; i++)
+	{
+		ComputeOne(glm::value_ptr(Transforms[i].Model), glm::value_ptr(Transforms[i].Normal[0]));
+	}
+}
@@ -0,0 +1,38 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : NormalMatrix.h
+// Description    : normal matrices (inverse transpose of the model matrix) computed on the cpu with sse
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glm.hpp>
+#include <cstddef>
+
+// per instance / per object data of 3D_Instanced.vs and GPUScene.vs, 112 bytes
+// (RingBuffer aligns offsets from the start of the buffer, so base instance offsets stay whole)
+struct InstanceTransform
+{
+	glm::mat4 Model;
+	glm::vec4 Normal[3];	// columns of the inverse transpose of Model's upper 3x3, w is 0
+};
+
+// the shaders used to run mat3(transpose(inverse(Model))) for every vertex, now it is done once per object
+// 3D_Normals.vs, 3D_Instanced.vs and GPUScene.vs keep the old path under VERTEX_NORMAL_MATRIX, only to
+// compare the two in the gpu profiler (benchmark --defines VERTEX_NORMAL_MATRIX)
+namespace NormalMatrix
+{
+	// affine model matrices only (last row 0 0 0 1), a singular matrix gives its cofactors instead
+	glm::mat4 Compute(const glm::mat4& Model);
+
+	void ComputeBatch(const glm::mat4* Models, glm::mat4* Normals, size_t Count);
+
+	// fills Normal from Model for every transform
+	void ComputeBatch(InstanceTransform* Transforms, size_t Count);
+}
@@ -0,0 +1,149 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : ProgramCache.cpp
+// Description    : stores linked programs with glGetProgramBinary and restores them with glProgramBinary
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "ProgramCache.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+int ProgramCache::Hits = 0;
+int ProgramCache::Misses = 0;
+int ProgramCache::Rejected = 0;
+
+bool ProgramCache::IsSupported()
+{
+	static GLint FormatCount = -1;
+	if (FormatCount < 0)
+	{
+		FormatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &FormatCount);
+	}
+	return (FormatCount > 0);
+}
+
+uint64_t ProgramCache::ComputeKey(const GLenum* Stages, const std::string* Sources, int StageCount)
+{
+	uint32_t Version = PROGRAM_CACHE_VERSION;
+	uint64_t Key = BinaryCache::Hash(&Version, sizeof(Version));
+
+	// binaries only load on the driver that wrote them, a driver update gives new keys instead of rejected files
+	const GLenum DriverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (int i = 0; i < 3; i++)
+	{
+		const char* Value = (const char*)glGetString(DriverStrings[i]);
+		if (Value != nullptr)
+		{
+			Key = BinaryCache::Hash(Value, strlen(Value) + 1, Key);
+		}
+	}
+
+	// the sources include their defines, so every permutation gets its own key
+	for (int i = 0; i < StageCount; i++)
+	{
+		uint32_t Length = (uint32_t)Sources[i].size();
+		Key = BinaryCache::Hash(&Stages[i], sizeof(GLenum), Key);
+		Key = BinaryCache::Hash(&Length, sizeof(Length), Key);
+		Key = BinaryCache::Hash(Sources[i].data(), Sources[i].size(), Key);
+	}
+	return Key;
+}
+
+GLuint ProgramCache::Load(uint64_t Key)
+{
+	MappedFile File;
+	if (IsSupported() == false || File.Open(GetPath(Key)) == false)
+	{
+		Misses++;
+		return 0;
+	}
+
+	// reject anything truncated, from another version or from a hash collision on the file name
+	const ProgramCacheHeader* Header = reinterpret_cast<const ProgramCacheHeader*>(File.GetData());
+	if (File.GetSize() < sizeof(ProgramCacheHeader) ||
+		memcmp(Header->Magic, "PBIN", 4) != 0 ||
+		Header->Version != PROGRAM_CACHE_VERSION ||
+		Header->Key != Key ||
+		File.GetSize() != sizeof(ProgramCacheHeader) + Header->Length)
+	{
+		Misses++;
+		return 0;
+	}
+
+	// the driver may still refuse it (another gpu, a changed driver reporting the same strings)
+	GLuint Program = glCreateProgram();
+	glProgramBinary(Program, Header->Format, File.GetData() + sizeof(ProgramCacheHeader), (GLsizei)Header->Length);
+
+	GLint LinkResult = 0;
+	glGetProgramiv(Program, GL_LINK_STATUS, &LinkResult);
+	if (LinkResult == GL_FALSE)
+	{
+		std::cout << "Program binary " << GetPath(Key) << " was rejected by the driver, compiling from source" << std::endl;
+		glDeleteProgram(Program);
+		Rejected++;
+		return 0;
+	}
+
+	Hits++;
+	return Program;
+}
+
+bool ProgramCache::Store(uint64_t Key, GLuint Program)
+{
+	if (IsSupported() == false)
+	{
+		return false;
+	}
+
+	GLint Length = 0;
+	glGetProgramiv(Program, GL_PROGRAM_BINARY_LENGTH, &Length);
+	if (Length <= 0)
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> Binary(Length);
+	GLenum Format = 0;
+	glGetProgramBinary(Program, Length, &Length, &Format, Binary.data());
+
+	ProgramCacheHeader NewHeader;
+	memcpy(NewHeader.Magic, "PBIN", 4);
+	NewHeader.Version = PROGRAM_CACHE_VERSION;
+	NewHeader.Key = Key;
+	NewHeader.Format = Format;
+	NewHeader.Length = (uint32_t)Length;
+
+	std::vector<BinaryCache::Block> Blocks;
+	Blocks.push_back({ &NewHeader, sizeof(NewHeader) });
+	Blocks.push_back({ Binary.data(), (size_t)Length });
+	return BinaryCache::WriteFile(GetPath(Key), Blocks);
+}
+
+int ProgramCache::GetHits()
+{
+	return Hits;
+}
+
+int ProgramCache::GetMisses()
+{
+	return Misses;
+}
+
+int ProgramCache::GetRejected()
+{
+	return Rejected;
+}
+
+std::string ProgramCache::GetPath(uint64_t Key)
+{
+	return BinaryCache::MakePath("Program_", Key, ".bin");
+}
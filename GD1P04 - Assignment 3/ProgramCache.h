@@ -0,0 +1,58 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : ProgramCache.h
+// Description    : class file for the on disk cache of linked program binaries
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <string>
+#include "BinaryCache.h"
+
+// bump whenever the layout of the file changes
+#define PROGRAM_CACHE_VERSION 1
+
+// file layout: header, driver binary
+struct ProgramCacheHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint64_t Key;
+	uint32_t Format;	// binary format reported by the driver
+	uint32_t Length;
+};
+
+class ProgramCache
+{
+public:
+	// false when the driver offers no binary formats, every program is then compiled from source
+	static bool IsSupported();
+
+	// key built from every stage and its full source, plus the driver that produced the binary
+	static uint64_t ComputeKey(const GLenum* Stages, const std::string* Sources, int StageCount);
+
+	// a linked program made from the cached binary, 0 when there is none or the driver rejected it
+	static GLuint Load(uint64_t Key);
+
+	// the program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+	static bool Store(uint64_t Key, GLuint Program);
+
+	// programs loaded, missing and rejected since startup
+	static int GetHits();
+	static int GetMisses();
+	static int GetRejected();
+
+private:
+	static std::string GetPath(uint64_t Key);
+
+	static int Hits;
+	static int Misses;
+	static int Rejected;
+};
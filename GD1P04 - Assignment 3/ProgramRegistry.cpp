@@ -0,0 +1,56 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : ProgramRegistry.cpp
+// Description    : the shader files and defines of every scene program, in SceneProgram order
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "ProgramRegistry.h"
+#include "ShaderLoader.h"
+
+const ProgramRegistry::ProgramFiles ProgramRegistry::Programs[PROGRAM_COUNT] = {
+	{ "Resources/Shaders/SkyBox.vs",       "Resources/Shaders/SkyBox.fs",       "" },								// PROGRAM_SKYBOX
+	{ "Resources/Shaders/3D_Instanced.vs", "Resources/Shaders/GBuffer.fs",      "" },								// PROGRAM_GBUFFER
+	{ "Resources/Shaders/Fullscreen.vs",   "Resources/Shaders/Lit.fs",          "GBUFFER_INPUT LIGHTING_POINT" },	// PROGRAM_DEFERRED_LIGHTING
+	{ "Resources/Shaders/3D_Normals.vs",   "Resources/Shaders/Lit.fs",          "LIGHTING_DIRECTIONAL" },			// PROGRAM_DIRECTIONAL_LIGHT
+	{ "Resources/Shaders/3D_Normals.vs",   "Resources/Shaders/Lit.fs",          "LIGHTING_POINT" },					// PROGRAM_POINT_LIGHT
+	{ "Resources/Shaders/3D_Normals.vs",   "Resources/Shaders/Reflection.fs",   "" },								// PROGRAM_REFLECTION
+	{ "Resources/Shaders/3D_Normals.vs",   "Resources/Shaders/FixedColor.fs",   "" },								// PROGRAM_COLOR
+	{ "Resources/Shaders/3D_Instanced.vs", "Resources/Shaders/Lit.fs",          "LIGHTING_DIRECTIONAL" },			// PROGRAM_VEGETATION
+	{ "Resources/Shaders/Grass.vs",        "Resources/Shaders/Grass.fs",        "" },								// PROGRAM_GRASS
+	{ "Resources/Shaders/3D_Instanced.vs", "Resources/Shaders/Lit.fs",          "LIGHTING_POINT" },					// PROGRAM_INSTANCED
+	{ "Resources/Shaders/3D_Instanced.vs", "Resources/Shaders/FixedColor.fs",   "" },								// PROGRAM_COLOR_INSTANCED
+	{ "Resources/Shaders/GPUScene.vs",     "Resources/Shaders/Lit.fs",          "LIGHTING_POINT" },					// PROGRAM_GPU_SCENE
+	{ "Resources/Shaders/Grass.cs",        nullptr,                             "" },								// PROGRAM_GRASS_GENERATE
+};
+
+void ProgramRegistry::BeginAll(std::map<std::string, GLuint>& ShaderMap)
+{
+	for (int i = 0; i < PROGRAM_COUNT; i++)
+	{
+		if (Programs[i].FragmentShader == nullptr)
+		{
+			ShaderLoader::BeginComputeProgram(Programs[i].Shader, ShaderMap, Programs[i].Defines);
+		}
+		else
+		{
+			ShaderLoader::BeginProgram(Programs[i].Shader, Programs[i].FragmentShader, ShaderMap, Programs[i].Defines);
+		}
+	}
+}
+
+ShaderProgram* ProgramRegistry::Get(SceneProgram Program, std::map<std::string, GLuint>& ShaderMap)
+{
+	const ProgramFiles& Files = Programs[Program];
+	if (Files.FragmentShader == nullptr)
+	{
+		return ShaderLoader::CreateComputeProgram(Files.Shader, ShaderMap, Files.Defines);
+	}
+	return ShaderLoader::CreateProgram(Files.Shader, Files.FragmentShader, ShaderMap, Files.Defines);
+}
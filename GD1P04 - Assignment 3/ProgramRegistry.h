@@ -0,0 +1,62 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : ProgramRegistry.h
+// Description    : class file for the table of every program the scene links
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <map>
+#include <string>
+#include "ShaderProgram.h"
+
+// one entry per program, the lit ones are variants of Lit.fs (the defines pick the light sources)
+enum SceneProgram
+{
+	PROGRAM_SKYBOX,
+	PROGRAM_GBUFFER,
+	PROGRAM_DEFERRED_LIGHTING,
+	PROGRAM_DIRECTIONAL_LIGHT,
+	PROGRAM_POINT_LIGHT,
+	PROGRAM_REFLECTION,
+	PROGRAM_COLOR,
+	PROGRAM_VEGETATION,
+	PROGRAM_GRASS,
+	PROGRAM_INSTANCED,
+	PROGRAM_COLOR_INSTANCED,
+	PROGRAM_GPU_SCENE,
+	PROGRAM_GRASS_GENERATE,
+	PROGRAM_COUNT
+};
+
+// the startup prefetch and the objects that use the programs read the same table, so the two can not drift apart
+class ProgramRegistry
+{
+public:
+	// starts compiling and linking every program without waiting (the textures load while the driver works)
+	static void BeginAll(std::map<std::string, GLuint>& ShaderMap);
+
+	// the linked program, picked up from BeginAll or created on the spot
+	static ShaderProgram* Get(SceneProgram Program, std::map<std::string, GLuint>& ShaderMap);
+
+private:
+	ProgramRegistry(void);
+	~ProgramRegistry(void);
+
+	// a compute program has no fragment shader, its compute shader is the first file
+	struct ProgramFiles
+	{
+		const char* Shader;
+		const char* FragmentShader;
+		const char* Defines;
+	};
+
+	static const ProgramFiles Programs[PROGRAM_COUNT];
+};
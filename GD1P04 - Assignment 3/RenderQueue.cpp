@@ -0,0 +1,339 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : RenderQueue.cpp
+// Description    : sort key packing, radix sort and sorted submission of the render queue
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "RenderQueue.h"
+#include "CPUProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#define KEY_PASS_SHIFT 60
+#define KEY_PROGRAM_SHIFT 48
+#define KEY_TEXTURE_SHIFT 36
+#define KEY_VAO_SHIFT 24
+#define KEY_STATE_MASK 0xFFFFFFFFFF000000ull	// everything above the depth bits
+#define KEY_ID_MASK 0xFFF
+
+// profiler scope names, the two stencil passes are never both used in one frame
+static const char* PassNames[] = { "Opaque", "Spheres", "Spheres", "Outlines", "Sky" };
+
+RenderQueue::RenderQueue()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass Pass, GLuint Program, GLuint Texture, GLuint VAO, float Depth)
+{
+	// positive floats keep their order as integers, the top 24 bits are enough to sort front to back
+	float PositiveDepth = glm::max(Depth, 0.0f);
+	uint32_t DepthBits;
+	memcpy(&DepthBits, &PositiveDepth, sizeof(DepthBits));
+
+	return ((uint64_t)Pass << KEY_PASS_SHIFT)
+		| ((uint64_t)(Program & KEY_ID_MASK) << KEY_PROGRAM_SHIFT)
+		| ((uint64_t)(Texture & KEY_ID_MASK) << KEY_TEXTURE_SHIFT)
+		| ((uint64_t)(VAO & KEY_ID_MASK) << KEY_VAO_SHIFT)
+		| (uint64_t)(DepthBits >> 7);
+}
+
+void RenderQueue::Begin()
+{
+	ItemCount = 0;
+}
+
+RenderItem& RenderQueue::Submit(RenderPass Pass)
+{
+	if (ItemCount == Items.size())
+	{
+		Items.push_back(RenderItem());
+	}
+	RenderItem& Item = Items[ItemCount++];
+	Item = RenderItem();
+	Item.Key = MakeKey(Pass, 0, 0, 0, 0.0f);
+	Item.TextureTarget = GL_TEXTURE_2D;
+	Item.DrawType = GL_TRIANGLES;
+	Item.InstanceCount = 1;
+	return Item;
+}
+
+RenderItem& RenderQueue::SubmitCustom(RenderPass Pass, GLuint Program, float Depth, CustomDraw Draw, void* Context)
+{
+	RenderItem& Item = Submit(Pass);
+	Item.Key = MakeKey(Pass, Program, 0, 0, Depth);
+	Item.Custom = Draw;
+	Item.CustomContext = Context;
+	return Item;
+}
+
+void RenderQueue::RadixSort(const std::vector<uint64_t>& Keys, std::vector<uint32_t>& Order, std::vector<uint64_t>& KeyScratch, std::vector<uint64_t>& KeyTemp, std::vector<uint32_t>& OrderTemp)
+{
+	size_t Count = Keys.size();
+	KeyScratch.assign(Keys.begin(), Keys.end());
+	KeyTemp.resize(Count);
+	Order.resize(Count);
+	OrderTemp.resize(Count);
+	for (size_t i = 0; i < Count; i++)
+	{
+		Order[i] = (uint32_t)i;
+	}
+
+	// all 8 histograms in one read of the keys
+	size_t Histograms[8][256];
+	memset(Histograms, 0, sizeof(Histograms));
+	for (size_t i = 0; i < Count; i++)
+	{
+		uint64_t Key = KeyScratch[i];
+		for (int Byte = 0; Byte < 8; Byte++)
+		{
+			Histograms[Byte][(Key >> (Byte * 8)) & 0xFF]++;
+		}
+	}
+
+	for (int Byte = 0; Byte < 8; Byte++)
+	{
+		size_t* Histogram = Histograms[Byte];
+
+		// a byte every key shares does not change the order, skip the scatter
+		if (Count == 0 || Histogram[(KeyScratch[0] >> (Byte * 8)) & 0xFF] == Count)
+		{
+			continue;
+		}
+
+		size_t Offset = 0;
+		for (int Bucket = 0; Bucket < 256; Bucket++)
+		{
+			size_t BucketSize = Histogram[Bucket];
+			Histogram[Bucket] = Offset;
+			Offset += BucketSize;
+		}
+
+		for (size_t i = 0; i < Count; i++)
+		{
+			size_t Target = Histogram[(KeyScratch[i] >> (Byte * 8)) & 0xFF]++;
+			KeyTemp[Target] = KeyScratch[i];
+			OrderTemp[Target] = Order[i];
+		}
+		KeyScratch.swap(KeyTemp);
+		Order.swap(OrderTemp);
+	}
+}
+
+int RenderQueue::CountStateChanges(const std::vector<uint64_t>& Keys, const std::vector<uint32_t>& Order)
+{
+	// one change for every pass, program, texture or vao that differs from the previous item
+	int Changes = 0;
+	uint64_t Previous = 0;
+	for (size_t i = 0; i < Order.size(); i++)
+	{
+		uint64_t Key = Keys[Order[i]];
+		for (int Shift = KEY_VAO_SHIFT; Shift < 64; Shift += 12)
+		{
+			uint64_t Mask = (Shift == KEY_PASS_SHIFT) ? 0xF : KEY_ID_MASK;
+			if (i == 0 || ((Key >> Shift) & Mask) != ((Previous >> Shift) & Mask))
+			{
+				Changes++;
+			}
+		}
+		Previous = Key;
+	}
+	return Changes;
+}
+
+void RenderQueue::ApplyPass(RenderPass Pass)
+{
+	switch (Pass)
+	{
+	case PASS_OPAQUE:
+	case PASS_SKY:
+		GLState::Disable(GL_STENCIL_TEST);
+		break;
+	case PASS_STENCIL:
+	case PASS_STENCIL_ONLY:
+		GLState::Enable(GL_STENCIL_TEST);
+		GLState::StencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+		GLState::StencilFunc(GL_ALWAYS, 1, 0xFF);
+		GLState::StencilMask(0xFF);
+		break;
+	case PASS_OUTLINE:
+		GLState::Enable(GL_STENCIL_TEST);
+		GLState::StencilFunc(GL_NOTEQUAL, 1, 0xFF);
+		GLState::StencilMask(0x00);
+		break;
+	}
+
+	// stencil only items match the depth the deferred pass already wrote
+	bool MaskOnly = (Pass == PASS_STENCIL_ONLY);
+	GLState::ColorMask(MaskOnly ? GL_FALSE : GL_TRUE);
+	GLState::DepthFunc(MaskOnly ? GL_LEQUAL : GL_LESS);
+}
+
+void RenderQueue::Execute()
+{
+	PROFILE_FUNCTION();
+	std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+	Keys.resize(ItemCount);
+	for (size_t i = 0; i < ItemCount; i++)
+	{
+		Keys[i] = Items[i].Key;
+	}
+	RadixSort(Keys, Order, KeyScratch, KeyTemp, OrderTemp);
+	SortTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+	StateChanges = CountStateChanges(Keys, Order);
+
+	int CurrentPass = -1;
+	ShaderProgram* CurrentProgram = nullptr;
+	for (size_t i = 0; i < ItemCount; i++)
+	{
+		const RenderItem& Item = Items[Order[i]];
+
+		int Pass = (int)(Item.Key >> KEY_PASS_SHIFT);
+		if (Pass != CurrentPass)
+		{
+			if (Profiler != nullptr)
+			{
+				if (CurrentPass >= 0)
+				{
+					Profiler->EndScope();
+				}
+				Profiler->BeginScope(PassNames[Pass]);
+			}
+			ApplyPass((RenderPass)Pass);
+			CurrentPass = Pass;
+		}
+
+		if (Profiler != nullptr && Item.Scope != nullptr)
+		{
+			Profiler->BeginScope(Item.Scope);
+		}
+
+		if (Item.Custom != nullptr)
+		{
+			Item.Custom(Item.CustomContext);
+			CurrentProgram = nullptr;
+			if (Profiler != nullptr && Item.Scope != nullptr)
+			{
+				Profiler->EndScope();
+			}
+			continue;
+		}
+
+		// the sampler uniform lives in the program object, it only has to be set when the program changes
+		GLState::UseProgram(Item.Program->GetID());
+		if (Item.Program != CurrentProgram)
+		{
+			Item.Program->SetInt(Item.TextureHandle, 0);
+			CurrentProgram = Item.Program;
+		}
+		GLState::BindTexture(0, Item.TextureTarget, Item.TextureID);
+		Item.Program->SetMat4(Item.ModelMatHandle, Item.ModelMat);
+		Item.Program->SetMat4(Item.NormalMatHandle, Item.NormalMat);
+
+		GLState::CullFace(GL_BACK);
+		GLState::SetEnabled(GL_CULL_FACE, Item.FaceCull);
+		GLState::SetEnabled(GL_SCISSOR_TEST, Item.Scissor);
+
+		GLState::BindVertexArray(Item.VAO);
+		if (Item.InstanceCount == 1)
+		{
+			glDrawElements(Item.DrawType, Item.IndexCount, GL_UNSIGNED_INT, 0);
+		}
+		else
+		{
+			glDrawElementsInstanced(Item.DrawType, Item.IndexCount, GL_UNSIGNED_INT, 0, Item.InstanceCount);
+		}
+
+		if (Profiler != nullptr && Item.Scope != nullptr)
+		{
+			Profiler->EndScope();
+		}
+	}
+	if (Profiler != nullptr && CurrentPass >= 0)
+	{
+		Profiler->EndScope();
+	}
+
+	// leave the defaults the rest of the frame (and the next clear) expect
+	GLState::Disable(GL_STENCIL_TEST);
+	GLState::Disable(GL_SCISSOR_TEST);
+	GLState::StencilMask(0xFF);
+	GLState::ColorMask(GL_TRUE);
+	GLState::DepthFunc(GL_LESS);
+}
+
+void RenderQueue::SetProfiler(GPUProfiler* Profiler)
+{
+	this->Profiler = Profiler;
+}
+
+size_t RenderQueue::GetItemCount() const
+{
+	return ItemCount;
+}
+
+double RenderQueue::GetSortTime() const
+{
+	return SortTime;
+}
+
+int RenderQueue::GetStateChanges() const
+{
+	return StateChanges;
+}
+
+void RenderQueue::Benchmark(int Count)
+{
+	// a scene shaped like this one scaled up: few programs, more textures, many meshes, random depths
+	std::mt19937 Random(42);
+	std::vector<uint64_t> Keys(Count);
+	for (int i = 0; i < Count; i++)
+	{
+		RenderPass Pass = (RenderPass)(Random() % 4);
+		Keys[i] = MakeKey(Pass, 1 + Random() % 8, 1 + Random() % 32, 1 + Random() % 64, (Random() % 100000) / 100.0f);
+	}
+
+	std::vector<uint32_t> Submitted(Count);
+	for (int i = 0; i < Count; i++)
+	{
+		Submitted[i] = (uint32_t)i;
+	}
+
+	std::vector<uint32_t> Order;
+	std::vector<uint64_t> KeyScratch, KeyTemp;
+	std::vector<uint32_t> OrderTemp;
+	const int Runs = 50;
+
+	std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+	for (int Run = 0; Run < Runs; Run++)
+	{
+		RadixSort(Keys, Order, KeyScratch, KeyTemp, OrderTemp);
+	}
+	double RadixTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count() / Runs;
+
+	// comparison sort of the same keys for reference
+	std::vector<uint32_t> Compared;
+	StartTime = std::chrono::high_resolution_clock::now();
+	for (int Run = 0; Run < Runs; Run++)
+	{
+		Compared = Submitted;
+		std::sort(Compared.begin(), Compared.end(), [&Keys](uint32_t a, uint32_t b) { return Keys[a] < Keys[b]; });
+	}
+	double CompareTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count() / Runs;
+
+	std::cout << "Render queue (" << Count << " items): radix sort " << RadixTime << " ms (std::sort " << CompareTime << " ms)"
+		<< " | state changes " << CountStateChanges(Keys, Order) << " sorted, " << CountStateChanges(Keys, Submitted) << " unsorted" << std::endl;
+}
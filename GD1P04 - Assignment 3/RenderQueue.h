@@ -0,0 +1,109 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : RenderQueue.h
+// Description    : class file for the per frame render queue, items are radix sorted on a 64 bit key before they are drawn
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "ShaderProgram.h"
+#include "GLState.h"
+#include "GPUProfiler.h"
+
+// passes run in this order, the pass sets the stencil / mask state its items share
+enum RenderPass
+{
+	PASS_OPAQUE = 0,		// normal lit objects
+	PASS_STENCIL = 1,		// opaque objects that also mark the stencil buffer for an outline
+	PASS_STENCIL_ONLY = 2,	// stencil mark only, the object was already shaded (deferred)
+	PASS_OUTLINE = 3,		// scaled up shapes drawn where the stencil is not marked
+	PASS_SKY = 4,			// last, only the pixels nothing else covered are left to shade
+};
+
+// draw call of an item with its own draw path, Context is whatever was passed to SubmitCustom
+typedef void (*CustomDraw)(void* Context);
+
+// key layout, high to low: pass (4) | program (12) | texture (12) | vao (12) | depth (24)
+struct RenderItem
+{
+	uint64_t Key;
+
+	ShaderProgram* Program;
+	UniformHandle TextureHandle;
+	UniformHandle ModelMatHandle;
+	UniformHandle NormalMatHandle;
+	GLenum TextureTarget;
+	GLuint TextureID;
+	GLuint VAO;
+	GLenum DrawType;
+	int IndexCount;
+	int InstanceCount;		// 1 for a plain draw, otherwise the VAO is drawn instanced (3D_Instanced.vs programs)
+	bool FaceCull;
+	bool Scissor;
+	glm::mat4 ModelMat;
+	glm::mat4 NormalMat;	// from NormalMatrix::Compute, the shaders no longer invert the model matrix
+
+	// gpu profiler scope around this item only, null for none
+	const char* Scope;
+
+	// objects with their own draw path (instanced, indirect, compute) set this instead of the fields above
+	CustomDraw Custom;
+	void* CustomContext;
+};
+
+class RenderQueue
+{
+public:
+	RenderQueue();
+	~RenderQueue();
+
+	static uint64_t MakeKey(RenderPass Pass, GLuint Program, GLuint Texture, GLuint VAO, float Depth);
+
+	// clears the items, keeps the memory for the next frame
+	void Begin();
+	RenderItem& Submit(RenderPass Pass);
+	// Context has to stay valid until Execute
+	RenderItem& SubmitCustom(RenderPass Pass, GLuint Program, float Depth, CustomDraw Draw, void* Context);
+
+	// sorts the items and draws them in key order
+	void Execute();
+
+	// every pass (and every item with a Scope) is timed as a scope of the given profiler, null to stop
+	void SetProfiler(GPUProfiler* Profiler);
+
+	size_t GetItemCount() const;
+	double GetSortTime() const;
+	int GetStateChanges() const;
+
+	// sorts Count synthetic items and prints the sort time and the state changes against submission order
+	static void Benchmark(int Count);
+
+private:
+	// lsd radix sort of Keys, Order receives the item indices in key order
+	static void RadixSort(const std::vector<uint64_t>& Keys, std::vector<uint32_t>& Order, std::vector<uint64_t>& KeyScratch, std::vector<uint64_t>& KeyTemp, std::vector<uint32_t>& OrderTemp);
+	static int CountStateChanges(const std::vector<uint64_t>& Keys, const std::vector<uint32_t>& Order);
+	void ApplyPass(RenderPass Pass);
+
+	std::vector<RenderItem> Items;
+	size_t ItemCount = 0;
+
+	std::vector<uint64_t> Keys;
+	std::vector<uint32_t> Order;
+	std::vector<uint64_t> KeyScratch;
+	std::vector<uint64_t> KeyTemp;
+	std::vector<uint32_t> OrderTemp;
+
+	double SortTime = 0.0;
+	int StateChanges = 0;
+	GPUProfiler* Profiler = nullptr;
+};
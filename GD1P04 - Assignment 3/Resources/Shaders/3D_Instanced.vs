@@ -0,0 +1,49 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : 3D_Instanced.vs
+// Description    : vertex shader used for instanced objects (vegetation), model matrix per instance
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#version 460 core
+
+// vertex data interpretation 
+layout (location = 0) in vec3 Position;
+layout (location = 1) in vec2 TexCoords;
+layout (location = 2) in vec3 Normal;
+layout (location = 3) in mat4 InstanceModel;
+layout (location = 7) in mat3 InstanceNormal;	// inverse transpose of InstanceModel
+
+#include "FrameBlock.glsl"
+
+//inputs (shared by every instance)
+uniform mat4 Model;
+uniform mat4 NormalMatrix;	// inverse transpose of Model in the upper 3x3
+
+// outputs to fragment shader
+out vec2 FragTexCoords;
+out vec3 FragNormal;
+out vec3 FragPos;
+
+void main()
+{
+	mat4 WorldModel = Model * InstanceModel;
+
+	// calculate the vertex position
+	FragPos = vec3(WorldModel * vec4(Position, 1.0f));
+	gl_Position = ViewProj * vec4(FragPos, 1.0f);
+
+	// pass through the vertex information
+	FragTexCoords = TexCoords;
+#ifdef VERTEX_NORMAL_MATRIX
+	FragNormal = mat3(transpose(inverse(WorldModel))) * Normal;
+#else
+	FragNormal = mat3(NormalMatrix) * (InstanceNormal * Normal);
+#endif
+}
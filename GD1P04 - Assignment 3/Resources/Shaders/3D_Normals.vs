@@ -18,9 +18,11 @@ layout (location = 0) in vec3 Position;
 layout (location = 1) in vec2 TexCoords;
 layout (location = 2) in vec3 Normal;
 
+#include "FrameBlock.glsl"
+
 //inputs
-uniform mat4 PVM;
 uniform mat4 Model;
+uniform mat4 NormalMatrix;	// inverse transpose of Model in the upper 3x3
 
 // outputs to fragment shader
 out vec2 FragTexCoords;
@@ -30,10 +32,14 @@ out vec3 FragPos;
 void main()
 {
 	// calculate the vertex position
-	gl_Position = PVM * vec4(Position, 1.0f);
+	FragPos = vec3(Model * vec4(Position, 1.0f));
+	gl_Position = ViewProj * vec4(FragPos, 1.0f);
 
 	// pass through the vertex information
 	FragTexCoords = TexCoords;
+#ifdef VERTEX_NORMAL_MATRIX
 	FragNormal = mat3(transpose(inverse(Model))) * Normal;
-	FragPos = vec3(Model * vec4(Position, 1.0f));
+#else
+	FragNormal = mat3(NormalMatrix) * Normal;
+#endif
 }
\ No newline at end of file
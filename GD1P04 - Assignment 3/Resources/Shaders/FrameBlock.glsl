@@ -0,0 +1,23 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : FrameBlock.glsl
+// Description    : per frame values shared by every program, pulled in with #include "FrameBlock.glsl"
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+// ShaderLoader binds the block to FRAME_BLOCK_BINDING, the layout matches FrameConstants::FrameBlock
+layout (std140) uniform FrameBlock
+{
+	mat4 ViewProj;
+	mat4 View;
+	mat4 Proj;
+	vec3 CameraPos;
+	float Time;
+	vec4 Viewport;	  // width, height, 1 / width, 1 / height
+};
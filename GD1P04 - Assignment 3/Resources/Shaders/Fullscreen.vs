@@ -0,0 +1,25 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Fullscreen.vs
+// Description    : vertex shader for a single triangle covering the screen, no vertex data needed
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#version 460 core
+
+// outputs to fragment shader
+out vec2 ScreenUV;
+
+void main()
+{
+    // vertices 0, 1, 2 become (-1, -1), (3, -1), (-1, 3)
+    vec2 Corner = vec2(float((gl_VertexID & 1) << 2), float((gl_VertexID & 2) << 1)) - 1.0f;
+    ScreenUV = (Corner * 0.5f) + 0.5f;
+    gl_Position = vec4(Corner, 0.0f, 1.0f);
+}
@@ -0,0 +1,32 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : GBuffer.fs
+// Description    : fragment shader for the deferred geometry pass, writes albedo and normal (depth comes from the depth buffer)
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#version 460 core
+
+// vertex shader input
+in vec2 FragTexCoords;
+in vec3 FragNormal;
+in vec3 FragPos;
+
+// uniform inputs
+uniform sampler2D ImageTexture0;
+
+// g-buffer outputs
+layout (location = 0) out vec4 GAlbedo;
+layout (location = 1) out vec4 GNormal;
+
+void main()
+{
+    GAlbedo = texture(ImageTexture0, FragTexCoords);
+    GNormal = vec4(normalize(FragNormal), 0.0f);
+}
@@ -0,0 +1,59 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : GPUScene.vs
+// Description    : vertex shader for multi draw indirect, the model matrix is read from the object buffer by draw id
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#version 460 core
+
+// vertex data interpretation 
+layout (location = 0) in vec3 Position;
+layout (location = 1) in vec2 TexCoords;
+layout (location = 2) in vec3 Normal;
+
+// per object data, one entry per draw command (binding matches GPUScene.h)
+struct ObjectTransform
+{
+	mat4 Model;
+	vec4 Normal[3];	// inverse transpose of Model's upper 3x3, one column each (InstanceTransform in NormalMatrix.h)
+};
+
+layout (std430, binding = 5) readonly buffer ObjectBuffer
+{
+	ObjectTransform Objects[];
+};
+
+#include "FrameBlock.glsl"
+
+//inputs (shared by every draw)
+uniform int DrawOffset;		// object of the first command in this multi draw
+
+// outputs to fragment shader
+out vec2 FragTexCoords;
+out vec3 FragNormal;
+out vec3 FragPos;
+
+void main()
+{
+	int Object = DrawOffset + gl_DrawID;
+	mat4 Model = Objects[Object].Model;
+
+	// calculate the vertex position
+	FragPos = vec3(Model * vec4(Position, 1.0f));
+	gl_Position = ViewProj * vec4(FragPos, 1.0f);
+
+	// pass through the vertex information
+	FragTexCoords = TexCoords;
+#ifdef VERTEX_NORMAL_MATRIX
+	FragNormal = mat3(transpose(inverse(Model))) * Normal;
+#else
+	FragNormal = mat3(Objects[Object].Normal[0].xyz, Objects[Object].Normal[1].xyz, Objects[Object].Normal[2].xyz) * Normal;
+#endif
+}
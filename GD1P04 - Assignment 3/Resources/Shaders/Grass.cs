@@ -0,0 +1,101 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Grass.cs
+// Description    : compute shader generating and culling the grass blades around the camera
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+// 4.3 is enough for compute and keeps software implementations (llvmpipe) working
+#version 430 core
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+struct DrawArraysIndirectCommand
+{
+    uint Count;
+    uint InstanceCount;
+    uint First;
+    uint BaseInstance;
+};
+
+// outputs, xyz = blade root (terrain space), w = rotation
+layout (std430, binding = 0) writeonly buffer BladeBuffer
+{
+    vec4 Blades[];
+};
+layout (std430, binding = 1) buffer CommandBuffer
+{
+    DrawArraysIndirectCommand Command;
+};
+
+// uniform inputs
+uniform sampler2D HeightMap;
+uniform sampler2D DensityMap;
+uniform vec3 CameraPos;
+uniform vec4 FrustumPlanes[6];
+uniform float Radius;
+uniform float Spacing;
+uniform float HalfExtent;
+uniform float BladeHeight;
+uniform int GridSide;
+
+// stable random value for a world grid cell, so blades do not move as the camera does
+float Random(ivec2 Cell, uint Salt)
+{
+    uint x = (uint(Cell.x) * 73856093u) ^ (uint(Cell.y) * 19349663u) ^ (Salt * 83492791u);
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return float(x & 0xFFFFFFu) / 16777216.0f;
+}
+
+void main()
+{
+    ivec2 Id = ivec2(gl_GlobalInvocationID.xy);
+    if (Id.x >= GridSide || Id.y >= GridSide)
+    {
+        return;
+    }
+
+    // jittered position inside the grid cell
+    ivec2 Cell = ivec2(floor(CameraPos.xz / Spacing)) + Id - ivec2(GridSide / 2);
+    vec2 Position = (vec2(Cell) + vec2(Random(Cell, 1u), Random(Cell, 2u))) * Spacing;
+    if (abs(Position.x) > HalfExtent || abs(Position.y) > HalfExtent || distance(Position, CameraPos.xz) > Radius)
+    {
+        return;
+    }
+
+    // density map uses the same texture coordinates as the terrain mesh
+    vec2 TerrainUV = (Position + HalfExtent) / (2.0f * HalfExtent);
+    float Density = textureLod(DensityMap, vec2(TerrainUV.x, 1.0f - TerrainUV.y), 0.0f).g;
+    if (Random(Cell, 3u) > Density)
+    {
+        return;
+    }
+
+    // sample the height at the texel centres of the height grid
+    float HeightMapSize = float(textureSize(HeightMap, 0).x);
+    vec2 HeightUV = ((TerrainUV * (HeightMapSize - 1.0f)) + 0.5f) / HeightMapSize;
+    float Height = textureLod(HeightMap, HeightUV, 0.0f).r;
+
+    // frustum test against the bounding sphere of the blade
+    vec3 Center = vec3(Position.x, Height + (BladeHeight * 0.5f), Position.y);
+    for (int i = 0; i < 6; i++)
+    {
+        if (dot(FrustumPlanes[i].xyz, Center) + FrustumPlanes[i].w < -BladeHeight)
+        {
+            return;
+        }
+    }
+
+    uint Index = atomicAdd(Command.InstanceCount, 1u);
+    Blades[Index] = vec4(Position.x, Height, Position.y, Random(Cell, 4u) * 6.2831853f);
+}
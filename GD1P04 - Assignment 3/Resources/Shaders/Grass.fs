@@ -0,0 +1,26 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Grass.fs
+// Description    : fragment shader used in the grass program
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#version 430 core
+
+// vertex shader input
+in float FragHeight;
+
+//output
+out vec4 FinalColor;
+
+void main()
+{
+    // darker at the root, lighter at the tip
+    FinalColor = vec4(mix(vec3(0.05f, 0.25f, 0.03f), vec3(0.45f, 0.75f, 0.2f), FragHeight), 1.0f);
+}
@@ -0,0 +1,57 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Grass.vs
+// Description    : vertex shader building one triangle per grass blade from the generated blade buffer
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#version 430 core
+
+// blades written by Grass.cs
+layout (std430, binding = 0) readonly buffer BladeBuffer
+{
+    vec4 Blades[];
+};
+
+#include "FrameBlock.glsl"
+
+//inputs
+uniform mat4 Model;	// terrain model matrix, the blades are in terrain space
+uniform float BladeHeight;
+uniform float BladeWidth;
+
+// outputs to fragment shader
+out float FragHeight;
+
+void main()
+{
+    vec4 Blade = Blades[gl_InstanceID];
+    vec3 Side = vec3(cos(Blade.w), 0.0f, sin(Blade.w)) * (BladeWidth * 0.5f);
+    float Height = BladeHeight * (0.7f + (0.6f * fract(Blade.w * 7.13f)));
+
+    // two root corners and a slightly leaning tip
+    vec3 Offset;
+    if (gl_VertexID == 0)
+    {
+        Offset = -Side;
+        FragHeight = 0.0f;
+    }
+    else if (gl_VertexID == 1)
+    {
+        Offset = Side;
+        FragHeight = 0.0f;
+    }
+    else
+    {
+        Offset = vec3(Side.z, Height, -Side.x);
+        FragHeight = 1.0f;
+    }
+
+    gl_Position = ViewProj * Model * vec4(Blade.xyz + Offset, 1.0f);
+}
@@ -0,0 +1,236 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Lit.fs
+// Description    : uber fragment shader for every lit program, ShaderLoader compiles one variant per define set
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#version 460 core
+
+// features, ShaderLoader injects the ones a program asks for after the #version line
+// (the binding macros are always injected, their values come from the c++ headers)
+#ifndef LIGHTING_DIRECTIONAL
+#define LIGHTING_DIRECTIONAL 0      // the sun from LightBlock
+#endif
+#ifndef LIGHTING_POINT
+#define LIGHTING_POINT 0            // point lights through the cluster lists (LightClusters)
+#endif
+#ifndef GBUFFER_INPUT
+#define GBUFFER_INPUT 0             // fullscreen pass, position, normal and albedo come from the g-buffer
+#endif
+#ifndef FOG
+#define FOG 0                       // exponential squared distance fog
+#endif
+#ifndef FOG_DENSITY
+#define FOG_DENSITY 0.01
+#endif
+#ifndef FOG_COLOR
+#define FOG_COLOR vec3(0.6f, 0.7f, 0.8f)
+#endif
+
+// creating struct for light manager (std140/std430, same member order as LightManager.h)
+struct PointLight
+{
+    vec3 Position;
+    float AmbientStrength;
+    vec3 Color;
+    float LightSpecularStrength;
+
+    float AttenuationConstant;
+    float AttenuationLinear;
+    float AttenuationExponent;
+    float Radius;
+};
+
+struct DirectionalLight
+{
+    vec3 Direction;
+    float AmbientStrength;
+    vec3 Color;
+    float LightSpecularStrength;
+};
+
+// lights shared by every lit program, uploaded by LightManager only when they change
+layout (std140, binding = LIGHT_BLOCK_BINDING) uniform LightBlock
+{
+    DirectionalLight DirLight;
+    int PointLightCount;
+    float Shininess;
+};
+
+#if LIGHTING_POINT
+// every point light, indexed through the cluster lists
+layout (std430, binding = LIGHT_BUFFER_BINDING) readonly buffer PointLightBuffer
+{
+    PointLight PointLights[];
+};
+
+// cluster grid built by LightClusters each frame
+layout (std140, binding = CLUSTER_BLOCK_BINDING) uniform ClusterBlock
+{
+    mat4 ClusterView;
+    uvec4 ClusterGrid;
+    vec4 ClusterParams;    // near, far, slices / log(far / near)
+    vec4 ClusterScreenSize;
+};
+
+layout (std430, binding = CLUSTER_BUFFER_BINDING) readonly buffer ClusterBuffer
+{
+    uvec2 Clusters[];      // offset into LightIndices, light count
+};
+
+layout (std430, binding = LIGHT_INDEX_BUFFER_BINDING) readonly buffer LightIndexBuffer
+{
+    uint LightIndices[];
+};
+#endif
+
+#include "FrameBlock.glsl"
+
+#if GBUFFER_INPUT
+// fullscreen triangle input
+in vec2 ScreenUV;
+
+// uniform inputs
+uniform sampler2D GAlbedo;
+uniform sampler2D GNormal;
+uniform sampler2D GDepth;
+uniform mat4 InverseViewProj;
+
+// values the forward variants get from the vertex shader, rebuilt from the g-buffer
+vec3 FragPos;
+vec3 FragNormal;
+#else
+// vertex shader input
+in vec2 FragTexCoords;
+in vec3 FragNormal;
+in vec3 FragPos;
+
+// uniform inputs
+uniform sampler2D ImageTexture0;
+#endif
+
+//output
+out vec4 FinalColor;
+
+#if LIGHTING_DIRECTIONAL
+// calculate light function
+vec3 CalculateLight_Directional(DirectionalLight OneDirLight)
+{
+    // light direction
+    vec3 Normal = normalize(FragNormal);
+
+    // ambient component
+    vec3 Ambient = OneDirLight.AmbientStrength  * OneDirLight.Color;
+
+    // diffuse component
+    float DiffuseStrength = max(dot(Normal, -OneDirLight.Direction), 0.0f);
+    vec3 Diffuse = DiffuseStrength * OneDirLight.Color;
+
+    // specular component
+    vec3 ReverseViewDir = normalize(CameraPos - FragPos);
+    vec3 HalfwayVector = normalize(-OneDirLight.Direction + ReverseViewDir); // Blinn-Phong
+    float SpecularReflectivity = pow(max(dot(Normal, HalfwayVector), 0.0f), Shininess);
+    vec3 Specular = OneDirLight.LightSpecularStrength * SpecularReflectivity * OneDirLight.Color;
+
+    // combine the lighting components
+    return vec3(Ambient + Diffuse + Specular);
+}
+#endif
+
+#if LIGHTING_POINT
+// calculate light function
+vec3 CalculateLight_Point(PointLight OnePointLight)
+{
+    // light direction
+    vec3 Normal = normalize(FragNormal);
+    vec3 LightDir = normalize(FragPos - OnePointLight.Position);
+
+    // ambient component
+    vec3 Ambient = OnePointLight.AmbientStrength  * OnePointLight.Color;
+
+    // diffuse component
+    float DiffuseStrength = max(dot(Normal, -LightDir), 0.0f);
+    vec3 Diffuse = DiffuseStrength * OnePointLight.Color;
+
+    // specular component
+    vec3 ReverseViewDir = normalize(CameraPos - FragPos);
+    vec3 HalfwayVector = normalize(-LightDir + ReverseViewDir); // Blinn-Phong
+    float SpecularReflectivity = pow(max(dot(Normal, HalfwayVector), 0.0f), Shininess);
+    vec3 Specular = OnePointLight.LightSpecularStrength * SpecularReflectivity * OnePointLight.Color;
+
+    // combine the lighting components
+    vec3 Light = vec3(Ambient + Diffuse + Specular);
+
+    // calculate and apply attenuation
+    float Distance = length(OnePointLight.Position - FragPos);
+    float Attenuation = OnePointLight.AttenuationConstant + (OnePointLight.AttenuationLinear * Distance) + (OnePointLight.AttenuationExponent * pow(Distance, 2));
+    Light /= Attenuation;
+
+    return Light;
+}
+
+// point lights of the cluster this fragment falls in (screen tile and exponential depth slice)
+vec3 CalculateLight_Clustered()
+{
+    float ViewDepth = -(ClusterView * vec4(FragPos, 1.0f)).z;
+    uvec2 Tile = uvec2(gl_FragCoord.xy / ClusterScreenSize.xy * vec2(ClusterGrid.xy));
+    uint Slice = uint(max(log(ViewDepth / ClusterParams.x) * ClusterParams.z, 0.0f));
+    Tile = min(Tile, ClusterGrid.xy - 1u);
+    Slice = min(Slice, ClusterGrid.z - 1u);
+    uvec2 Cluster = Clusters[(((Slice * ClusterGrid.y) + Tile.y) * ClusterGrid.x) + Tile.x];
+
+    vec3 Light = vec3(0.0f, 0.0f, 0.0f);
+    for (uint i = 0u; i < Cluster.y; i++)
+    {
+        Light += CalculateLight_Point(PointLights[LightIndices[Cluster.x + i]]);
+    }
+    return Light;
+}
+#endif
+
+void main()
+{
+#if GBUFFER_INPUT
+    // nothing was drawn here in the geometry pass
+    float Depth = texture(GDepth, ScreenUV).r;
+    if (Depth >= 1.0f)
+    {
+        discard;
+    }
+
+    // world position from the depth buffer
+    vec4 WorldPos = InverseViewProj * vec4((vec3(ScreenUV, Depth) * 2.0f) - 1.0f, 1.0f);
+    FragPos = WorldPos.xyz / WorldPos.w;
+    FragNormal = texture(GNormal, ScreenUV).xyz;
+
+    // the forward objects drawn after this depth test against the g-buffer depth
+    gl_FragDepth = Depth;
+    vec4 Albedo = texture(GAlbedo, ScreenUV);
+#else
+    vec4 Albedo = texture(ImageTexture0, FragTexCoords);
+#endif
+
+    // add the light sources this variant was compiled with, the others are not in the code at all
+    vec3 LightOutput = vec3(0.0f, 0.0f, 0.0f);
+#if LIGHTING_DIRECTIONAL
+    LightOutput += CalculateLight_Directional(DirLight);
+#endif
+#if LIGHTING_POINT
+    LightOutput += CalculateLight_Clustered();
+#endif
+
+    //calculate the final color
+    FinalColor = vec4(LightOutput, 1.0f) * Albedo;
+
+#if FOG
+    float FogAmount = 1.0f - exp(-pow(length(CameraPos - FragPos) * FOG_DENSITY, 2.0f));
+    FinalColor.rgb = mix(FinalColor.rgb, FOG_COLOR, FogAmount);
+#endif
+}
@@ -13,12 +13,13 @@
 
 #version 460 core
 
+#include "FrameBlock.glsl"
+
 in vec3 FragNormal;
 in vec3 FragPos;
 
 //uniform inputs
 uniform samplerCube Texture0;
-uniform vec3 CameraPos;
 
 // output 
 out vec4 FinalColor;
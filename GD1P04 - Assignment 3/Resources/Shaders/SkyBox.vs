@@ -16,14 +16,16 @@
 // vertex data interpretation
 layout (location = 0) in vec3 Position;
 
+#include "FrameBlock.glsl"
+
 // inputs
-uniform mat4 PVMMat;
+uniform mat4 Model;
 
 // outputs to fragment sgader
 out vec3 FragTexCoords;
 
 void main()
 {
-	gl_Position = PVMMat * vec4(Position, 1.0f);
+	gl_Position = ViewProj * Model * vec4(Position, 1.0f);
 	FragTexCoords =  Position;
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : RingBuffer.cpp
+// Description    : persistent mapping, fence waits and aligned sub allocation of the upload ring
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "RingBuffer.h"
+#include <iostream>
+
+RingBuffer::RingBuffer(GLsizeiptr FrameSize, int FrameCount)
+{
+	GLint Alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+	UniformAlignment = (Alignment > 0) ? Alignment : 256;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+	StorageAlignment = (Alignment > 0) ? Alignment : 256;
+
+	// every region starts on an alignment any buffer binding accepts
+	this->FrameSize = (FrameSize + 255) & ~(GLsizeiptr)255;
+	this->FrameCount = FrameCount;
+	Fences.assign(FrameCount, (GLsync)0);
+
+	// immutable storage, mapped once for the lifetime of the ring
+	const GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &Buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, this->FrameSize * FrameCount, nullptr, Flags);
+	Mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, this->FrameSize * FrameCount, Flags);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (Mapped == nullptr)
+	{
+		std::cout << "Ring buffer: persistent mapping failed, dynamic uploads fall back to glBufferSubData" << std::endl;
+	}
+}
+
+RingBuffer::~RingBuffer()
+{
+	for (size_t i = 0; i < Fences.size(); i++)
+	{
+		if (Fences[i] != 0)
+		{
+			glDeleteSync(Fences[i]);
+		}
+	}
+	if (Mapped != nullptr)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+	glDeleteBuffers(1, &Buffer);
+}
+
+void RingBuffer::BeginFrame()
+{
+	Frame = (Frame + 1) % FrameCount;
+	Head = 0;
+
+	GLsync& Fence = Fences[Frame];
+	if (Fence == 0)
+	{
+		return;
+	}
+
+	// a fence that is not signalled yet means the cpu got FrameCount frames ahead of the gpu
+	GLenum Result = glClientWaitSync(Fence, 0, 0);
+	if (Result == GL_TIMEOUT_EXPIRED)
+	{
+		StallCount++;
+		do
+		{
+			Result = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while (Result == GL_TIMEOUT_EXPIRED);
+	}
+	glDeleteSync(Fence);
+	Fence = 0;
+}
+
+void RingBuffer::EndFrame()
+{
+	if (Head > 0)
+	{
+		Fences[Frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
+
+RingAllocation RingBuffer::Allocate(GLsizeiptr Size, GLsizeiptr Alignment)
+{
+	RingAllocation Allocation = { nullptr, 0, Size };
+
+	// aligned from the start of the buffer, not of the frame region, so Offset / Alignment is a whole
+	// base instance even when the alignment (an instance stride) does not divide the frame size
+	GLintptr FrameStart = Frame * FrameSize;
+	GLsizeiptr Start = (((FrameStart + Head + Alignment - 1) / Alignment) * Alignment) - FrameStart;
+	if (Mapped == nullptr || Start + Size > FrameSize)
+	{
+		OverflowCount++;
+		return Allocation;
+	}
+
+	Head = Start + Size;
+	Allocation.Offset = (Frame * FrameSize) + Start;
+	Allocation.Data = Mapped + Allocation.Offset;
+	BytesUploaded += Size;
+	return Allocation;
+}
+
+GLuint RingBuffer::GetBufferID() const
+{
+	return Buffer;
+}
+
+GLsizeiptr RingBuffer::GetUniformAlignment() const
+{
+	return UniformAlignment;
+}
+
+GLsizeiptr RingBuffer::GetStorageAlignment() const
+{
+	return StorageAlignment;
+}
+
+int RingBuffer::GetStallCount() const
+{
+	return StallCount;
+}
+
+size_t RingBuffer::GetBytesUploaded() const
+{
+	return BytesUploaded;
+}
+
+int RingBuffer::GetOverflowCount() const
+{
+	return OverflowCount;
+}
+
+void RingBuffer::ResetStats()
+{
+	StallCount = 0;
+	BytesUploaded = 0;
+	OverflowCount = 0;
+}
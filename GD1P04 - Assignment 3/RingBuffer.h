@@ -0,0 +1,66 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : RingBuffer.h
+// Description    : class file for the persistently mapped upload ring, one fenced region per frame in flight
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <vector>
+
+// part of the ring handed to one system for this frame, Data is null when the frame region is full
+struct RingAllocation
+{
+	void* Data;
+	GLintptr Offset;	// from the start of the buffer, for glBindBufferRange / base instance
+	GLsizeiptr Size;
+};
+
+class RingBuffer
+{
+public:
+	RingBuffer(GLsizeiptr FrameSize, int FrameCount);
+	~RingBuffer();
+
+	// waits until the gpu is done with the region of this frame, then hands it out again
+	void BeginFrame();
+
+	// fences the region, the cpu comes back to it FrameCount frames later
+	void EndFrame();
+
+	// aligned range of this frame's region, written directly (the mapping is coherent)
+	RingAllocation Allocate(GLsizeiptr Size, GLsizeiptr Alignment);
+
+	GLuint GetBufferID() const;
+	GLsizeiptr GetUniformAlignment() const;
+	GLsizeiptr GetStorageAlignment() const;
+
+	// frames that had to wait for the gpu, bytes handed out and allocations that did not fit since the last reset
+	int GetStallCount() const;
+	size_t GetBytesUploaded() const;
+	int GetOverflowCount() const;
+	void ResetStats();
+
+private:
+	GLuint Buffer = 0;
+	unsigned char* Mapped = nullptr;
+	GLsizeiptr FrameSize;
+	int FrameCount;
+	int Frame = 0;
+	GLsizeiptr Head = 0;
+	std::vector<GLsync> Fences;
+
+	GLsizeiptr UniformAlignment = 256;
+	GLsizeiptr StorageAlignment = 256;
+
+	int StallCount = 0;
+	size_t BytesUploaded = 0;
+	int OverflowCount = 0;
+};
@@ -13,78 +13,629 @@
 //
 
 #include "ShaderLoader.h" 
+#include "FrameConstants.h"
+#include "LightClusters.h"
+#include "LightManager.h"
+#include "CPUProfiler.h"
+#include "ProgramCache.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include<iostream>
 #include<fstream>
 #include<vector>
+#include<sstream>
 
 ShaderLoader::ShaderLoader(void) {}
 ShaderLoader::~ShaderLoader(void) {}
 
-GLuint ShaderLoader::CreateProgram(const char* vertexShaderFilename, const char* fragmentShaderFilename, std::map<std::string, GLuint>& ShaderMap)
+std::string ShaderLoader::GlobalDefines;
+std::map<std::string, std::string> ShaderLoader::SourceMap;
+std::map<std::string, ShaderLoader::PendingProgram> ShaderLoader::PendingPrograms;
+std::map<std::string, ShaderProgram*> ShaderLoader::ProgramMap;
+std::map<std::string, ShaderLoader::ProgramStages> ShaderLoader::StageMap;
+double ShaderLoader::StartupTime = 0.0;
+int ShaderLoader::ProgramCount = 0;
+int ShaderLoader::ProgramReuses = 0;
+int ShaderLoader::ProgramRequests = 0;
+int ShaderLoader::ShaderCompiles = 0;
+int ShaderLoader::ShaderReuses = 0;
+bool ShaderLoader::ParallelCompile = false;
+
+ShaderProgram* ShaderLoader::CreateProgram(const char* vertexShaderFilename, const char* fragmentShaderFilename, std::map<std::string, GLuint>& ShaderMap, const char* defines)
+{
+	PROFILE_FUNCTION();
+
+	const GLenum stages[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	const char* filenames[] = { vertexShaderFilename, fragmentShaderFilename };
+	return GetProgram(stages, filenames, 2, NormalizeDefines(defines), ShaderMap);
+}
+
+ShaderProgram* ShaderLoader::CreateComputeProgram(const char* computeShaderFilename, std::map<std::string, GLuint>& ShaderMap, const char* defines)
+{
+	PROFILE_FUNCTION();
+
+	const GLenum stages[] = { GL_COMPUTE_SHADER };
+	const char* filenames[] = { computeShaderFilename };
+	return GetProgram(stages, filenames, 1, NormalizeDefines(defines), ShaderMap);
+}
+
+void ShaderLoader::BeginProgram(const char* vertexShaderFilename, const char* fragmentShaderFilename, std::map<std::string, GLuint>& ShaderMap, const char* defines)
 {
-	// Create the shaders from the filepath
-	GLuint vertexShaderID = CreateShader(GL_VERTEX_SHADER, vertexShaderFilename, ShaderMap);
-	GLuint fragmentShaderID = CreateShader(GL_FRAGMENT_SHADER, fragmentShaderFilename, ShaderMap);
+	PROFILE_FUNCTION();
+
+	const GLenum stages[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	const char* filenames[] = { vertexShaderFilename, fragmentShaderFilename };
+	BeginStages(stages, filenames, 2, NormalizeDefines(defines), ShaderMap);
+}
 
+void ShaderLoader::BeginComputeProgram(const char* computeShaderFilename, std::map<std::string, GLuint>& ShaderMap, const char* defines)
+{
+	PROFILE_FUNCTION();
+
+	const GLenum stages[] = { GL_COMPUTE_SHADER };
+	const char* filenames[] = { computeShaderFilename };
+	BeginStages(stages, filenames, 1, NormalizeDefines(defines), ShaderMap);
+}
+
+void ShaderLoader::ReleasePrograms()
+{
+	for (std::map<std::string, ShaderProgram*>::iterator it = ProgramMap.begin(); it != ProgramMap.end(); ++it)
+	{
+		delete it->second;
+	}
+	ProgramMap.clear();
+	for (std::map<std::string, PendingProgram>::iterator it = PendingPrograms.begin(); it != PendingPrograms.end(); ++it)
+	{
+		glDeleteProgram(it->second.Program);
+	}
+	PendingPrograms.clear();
+	StageMap.clear();
+	SourceMap.clear();
+}
+
+void ShaderLoader::SetGlobalDefines(const char* defines)
+{
+	GlobalDefines = NormalizeDefines(defines);
+}
+
+std::string ShaderLoader::NormalizeDefines(const char* defines)
+{
+	// sorted and single spaced, the same set written in another order is the same variant
+	std::istringstream input(GlobalDefines + " " + (defines != nullptr ? defines : ""));
+	std::vector<std::string> names;
+	std::string name;
+	while (input >> name)
+	{
+		names.push_back(name);
+	}
+	std::sort(names.begin(), names.end());
+	names.erase(std::unique(names.begin(), names.end()), names.end());
+
+	std::string normalized;
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		normalized += (i == 0 ? "" : " ") + names[i];
+	}
+	return normalized;
+}
+
+std::string ShaderLoader::GetProgramName(const char* const* filenames, int stageCount, const std::string& defines)
+{
+	// the full stage set, the same shaders in another combination are another program
+	std::string programName = filenames[0];
+	for (int i = 1; i < stageCount; i++)
+	{
+		programName += std::string(" + ") + filenames[i];
+	}
+
+	// and every define set is its own variant
+	if (defines.empty() == false)
+	{
+		programName += " [" + defines + "]";
+	}
+	return programName;
+}
+
+ShaderProgram* ShaderLoader::GetProgram(const GLenum* stages, const char* const* filenames, int stageCount, const std::string& defines, std::map<std::string, GLuint>& ShaderMap)
+{
+	std::string programName = GetProgramName(filenames, stageCount, defines);
+	ProgramRequests++;
+
+	// already linked, every user of the same stage set shares one program
+	std::map<std::string, ShaderProgram*>::const_iterator Existing = ProgramMap.find(programName);
+	if (Existing != ProgramMap.end())
+	{
+		ProgramReuses++;
+		return Existing->second;
+	}
+
+	if (PendingPrograms.find(programName) == PendingPrograms.end())
+	{
+		BeginStages(stages, filenames, stageCount, defines, ShaderMap);
+	}
+	return FinishProgram(programName, ShaderMap);
+}
+
+void ShaderLoader::BeginStages(const GLenum* stages, const char* const* filenames, int stageCount, const std::string& defines, std::map<std::string, GLuint>& ShaderMap)
+{
+	std::string programName = GetProgramName(filenames, stageCount, defines);
+	if (ProgramMap.find(programName) != ProgramMap.end() || PendingPrograms.find(programName) != PendingPrograms.end())
+	{
+		return;
+	}
 
-	// Create the program handle, attach the shaders and link it
-	GLuint program = glCreateProgram();
-	glAttachShader(program, vertexShaderID);
-	glAttachShader(program, fragmentShaderID);
-	glLinkProgram(program);
+	std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
 
+	// let the driver compile on as many threads as it likes, nothing below waits for a result
+	static bool ThreadsRequested = false;
+	if (ThreadsRequested == false)
+	{
+		ThreadsRequested = true;
+		if (GLEW_KHR_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+			ParallelCompile = true;
+		}
+		else if (GLEW_ARB_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+			ParallelCompile = true;
+		}
+	}
+
+	// the binary cache is keyed by the sources, so they are read even when the binary is used
+	std::vector<std::string> sources(stageCount);
+	for (int i = 0; i < stageCount; i++)
+	{
+		sources[i] = GetVariantSource(filenames[i], defines);
+	}
+
+	PendingProgram Pending;
+	Pending.Source.Stages.assign(stages, stages + stageCount);
+	Pending.Source.Filenames.assign(filenames, filenames + stageCount);
+	Pending.Source.Defines = defines;
+	Pending.CacheKey = ProgramCache::ComputeKey(stages, sources.data(), stageCount);
+	Pending.Program = ProgramCache::Load(Pending.CacheKey);
+	Pending.FromCache = (Pending.Program != 0);
+	if (Pending.FromCache == false)
+	{
+		// Create the program handle, attach the shaders and link it
+		Pending.Program = glCreateProgram();
+		for (int i = 0; i < stageCount; i++)
+		{
+			GLuint shaderID = CreateShader(stages[i], filenames[i], defines, ShaderMap);
+			glAttachShader(Pending.Program, shaderID);
+		}
+		glProgramParameteri(Pending.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(Pending.Program);
+	}
+	PendingPrograms[programName] = Pending;
+
+	StartupTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+ShaderProgram* ShaderLoader::FinishProgram(const std::string& programName, std::map<std::string, GLuint>& ShaderMap)
+{
+	std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+
+	PendingProgram Pending = PendingPrograms[programName];
+	PendingPrograms.erase(programName);
+	GLuint program = Pending.Program;
+
+	// the caller needs the program now and the other links run on the driver's threads, so this thread has nothing
+	// else to do: the status query blocks until the link is done instead of spinning on GL_COMPLETION_STATUS_KHR
 	// Check for link errors
 	int link_result = 0;
 	glGetProgramiv(program, GL_LINK_STATUS, &link_result);
+	ShaderProgram* NewProgram = nullptr;
 	if (link_result == GL_FALSE)
 	{
-		std::string programName = vertexShaderFilename + *fragmentShaderFilename;
+		// compile errors only show up here, the shaders were never waited on
+		for (size_t i = 0; i < Pending.Source.Filenames.size(); i++)
+		{
+			std::map<std::string, GLuint>::iterator Shader = ShaderMap.find(GetShaderKey(Pending.Source.Filenames[i].c_str(), Pending.Source.Defines));
+			int compile_result = 0;
+			if (Shader != ShaderMap.end())
+			{
+				glGetShaderiv(Shader->second, GL_COMPILE_STATUS, &compile_result);
+				if (compile_result == GL_FALSE)
+				{
+					// a broken shader is not kept, the next program that needs it compiles it again
+					PrintErrorDetails(true, Shader->second, Shader->first.c_str());
+					glDeleteShader(Shader->second);
+					ShaderMap.erase(Shader);
+				}
+			}
+		}
 		PrintErrorDetails(false, program, programName.c_str());
-		return 0;
+		glDeleteProgram(program);
+		NewProgram = new ShaderProgram(0, programName);
+	}
+	else
+	{
+		if (Pending.FromCache == false)
+		{
+			ProgramCache::Store(Pending.CacheKey, program);
+		}
+		NewProgram = CreateReflectedProgram(program, programName);
 	}
-	return program;
+
+	ProgramMap[programName] = NewProgram;
+	StageMap[programName] = Pending.Source;
+	ProgramCount++;
+	StartupTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+	return NewProgram;
 }
 
-GLuint ShaderLoader::CreateShader(GLenum shaderType, const char* shaderName, std::map<std::string, GLuint>& ShaderMap)
+int ShaderLoader::ReloadShader(const std::string& filename)
 {
-	// Read the shader files and save the source code as strings
-	std::string shaderSourceCode = ReadShaderFile(shaderName);
+	PROFILE_FUNCTION();
 
-	// MAPPING HELL
-	if (ShaderMap.find(shaderName) != ShaderMap.end())
-	{
-		std::cout << "Retrieving " << shaderName << " from the ShaderMap" << std::endl;
+	// read the file again, nothing else uses the old text
+	SourceMap.erase(filename);
 
-		return ShaderMap[shaderName];
-	}
-	else
+	int reloaded = 0;
+	for (std::map<std::string, ProgramStages>::const_iterator it = StageMap.begin(); it != StageMap.end(); ++it)
 	{
-		// Create the shader ID and create pointers for source code string and length
-		// GLuint shaderID = 0; big no, 0 is unassign ID
-		GLuint shaderID = glCreateShader(shaderType);
-		const char* shader_code_ptr = shaderSourceCode.c_str();
-		const int shader_code_size = shaderSourceCode.length();
+		// a shared file (FrameBlock.glsl) rebuilds every program with a stage that includes it
+		const std::vector<std::string>& programFiles = it->second.Filenames;
+		bool usesFile = (std::find(programFiles.begin(), programFiles.end(), filename) != programFiles.end());
+		for (size_t i = 0; i < programFiles.size() && usesFile == false; i++)
+		{
+			usesFile = IncludesFile(programFiles[i], filename);
+		}
+		if (usesFile == false)
+		{
+			continue;
+		}
+		if (RelinkProgram(it->first, it->second, ProgramMap[it->first]) == true)
+		{
+			reloaded++;
+		}
+	}
+	return reloaded;
+}
 
-		// Populate the Shader Object (ID) and compile
-		glShaderSource(shaderID, 1, &shader_code_ptr, &shader_code_size);
-		glCompileShader(shaderID);
+bool ShaderLoader::RelinkProgram(const std::string& programName, const ProgramStages& source, ShaderProgram* target)
+{
+	// fresh shader objects, the ones in the ShaderMap are shared with the programs that keep running
+	int stageCount = (int)source.Stages.size();
+	std::vector<std::string> sources(stageCount);
+	std::vector<GLuint> shaders(stageCount);
+	bool compiled = true;
+	for (int i = 0; i < stageCount; i++)
+	{
+		sources[i] = GetVariantSource(source.Filenames[i].c_str(), source.Defines);
+		const char* shader_code_ptr = sources[i].c_str();
+		const int shader_code_size = sources[i].length();
 
+		shaders[i] = glCreateShader(source.Stages[i]);
+		glShaderSource(shaders[i], 1, &shader_code_ptr, &shader_code_size);
+		glCompileShader(shaders[i]);
 
-		// Check for errors
 		int compile_result = 0;
-		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &compile_result);
+		glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &compile_result);
 		if (compile_result == GL_FALSE)
 		{
-			PrintErrorDetails(true, shaderID, shaderName);
-			return 0;
+			PrintErrorDetails(true, shaders[i], source.Filenames[i].c_str());
+			compiled = false;
 		}
+	}
 
-		std::cout << "Adding " << shaderName << " from the ShaderMap" << std::endl;
+	GLuint program = 0;
+	if (compiled == true)
+	{
+		program = glCreateProgram();
+		for (int i = 0; i < stageCount; i++)
+		{
+			glAttachShader(program, shaders[i]);
+		}
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(program);
 
-		ShaderMap[shaderName] = shaderID;
-		return shaderID; // return data	
+		int link_result = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &link_result);
+		if (link_result == GL_FALSE)
+		{
+			PrintErrorDetails(false, program, programName.c_str());
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+
+	// the linked program keeps its own copy of the code
+	for (int i = 0; i < stageCount; i++)
+	{
+		if (program != 0)
+		{
+			glDetachShader(program, shaders[i]);
+		}
+		glDeleteShader(shaders[i]);
 	}
 
+	if (program == 0)
+	{
+		std::cout << "Reload of " << programName << " failed, keeping the previous program" << std::endl;
+		return false;
+	}
+
+	// swap behind the same object, handles given out earlier resolve against the new program
+	ProgramCache::Store(ProgramCache::ComputeKey(source.Stages.data(), sources.data(), stageCount), program);
+	if (target->GetID() != 0)
+	{
+		glDeleteProgram(target->GetID());
+	}
+	target->Reflect(program);
+	BindFrameBlock(target);
+	std::cout << "Reloaded " << programName << " (" << target->GetUniformCount() << " uniforms)" << std::endl;
+	return true;
+}
+
+double ShaderLoader::GetStartupTime()
+{
+	return StartupTime;
+}
+
+void ShaderLoader::PrintStartupReport()
+{
+	// warm when every program came from the binary cache, cold when none did
+	int hits = ProgramCache::GetHits();
+	const char* state = (hits == ProgramCount) ? "warm" : ((hits == 0) ? "cold" : "partly warm");
+	std::cout << "Shader startup (" << state << ", " << (ParallelCompile ? "parallel" : "serial") << " compile): "
+		<< StartupTime << " ms for " << ProgramCount << " programs ("
+		<< hits << " from the program cache, " << ProgramCache::GetMisses() + ProgramCache::GetRejected() << " compiled, "
+		<< ProgramCache::GetRejected() << " binaries rejected, " << ProgramReuses << " shared)" << std::endl;
+
+	// variants per stage set, e.g. 3D_Normals.vs + Lit.fs with and without point lights
+	std::map<std::string, int> variants;
+	int permutations = 0;
+	for (std::map<std::string, ProgramStages>::const_iterator it = StageMap.begin(); it != StageMap.end(); ++it)
+	{
+		if (it->second.Defines.empty() == false)
+		{
+			std::vector<const char*> filenames;
+			for (size_t i = 0; i < it->second.Filenames.size(); i++)
+			{
+				filenames.push_back(it->second.Filenames[i].c_str());
+			}
+			variants[GetProgramName(filenames.data(), (int)filenames.size(), "")]++;
+			permutations++;
+		}
+	}
+	std::cout << "Shader permutations: " << permutations << " variants of " << variants.size() << " stage sets" << std::endl;
+	for (std::map<std::string, int>::const_iterator it = variants.begin(); it != variants.end(); ++it)
+	{
+		std::cout << "  " << it->first << ": " << it->second << std::endl;
+	}
+
+	// a request is served from the cache when nothing had to be compiled for it
+	int served = ProgramReuses + hits;
+	std::cout << "Shader compile cache: " << served << " of " << ProgramRequests << " program requests without a compile ("
+		<< ((ProgramRequests > 0) ? (100 * served / ProgramRequests) : 0) << "%), "
+		<< ShaderCompiles << " shader objects compiled, " << ShaderReuses << " reused" << std::endl;
+}
+
+ShaderProgram* ShaderLoader::CreateReflectedProgram(GLuint program, const std::string& programName)
+{
+	// uniform locations are read once here instead of by name every frame
+	ShaderProgram* NewProgram = new ShaderProgram(program, programName);
+	BindFrameBlock(NewProgram);
+	std::cout << "Linked " << programName << " (" << NewProgram->GetUniformCount() << " uniforms)" << std::endl;
+	return NewProgram;
+}
+
+void ShaderLoader::BindFrameBlock(const ShaderProgram* Program)
+{
+	// every program reads the camera, time and viewport from the same block, a new link resets the binding
+	GLint FrameBlockIndex = Program->GetUniformBlock("FrameBlock");
+	if (FrameBlockIndex >= 0)
+	{
+		glUniformBlockBinding(Program->GetID(), FrameBlockIndex, FRAME_BLOCK_BINDING);
+	}
+}
+
+GLuint ShaderLoader::CreateShader(GLenum shaderType, const char* shaderName, const std::string& defines, std::map<std::string, GLuint>& ShaderMap)
+{
+	// MAPPING HELL (one entry per file and define set)
+	std::string shaderKey = GetShaderKey(shaderName, defines);
+	if (ShaderMap.find(shaderKey) != ShaderMap.end())
+	{
+		std::cout << "Retrieving " << shaderKey << " from the ShaderMap" << std::endl;
+		ShaderReuses++;
+
+		return ShaderMap[shaderKey];
+	}
+
+	// Read the shader file (only on a map miss) and save the source code as a string
+	std::string shaderSourceCode = GetVariantSource(shaderName, defines);
+
+	// Create the shader ID and create pointers for source code string and length
+	// GLuint shaderID = 0; big no, 0 is unassign ID
+	GLuint shaderID = glCreateShader(shaderType);
+	const char* shader_code_ptr = shaderSourceCode.c_str();
+	const int shader_code_size = shaderSourceCode.length();
+
+	// Populate the Shader Object (ID) and compile, the status is checked after the link so compiles can overlap
+	glShaderSource(shaderID, 1, &shader_code_ptr, &shader_code_size);
+	glCompileShader(shaderID);
+
+	std::cout << "Adding " << shaderKey << " to the ShaderMap" << std::endl;
+	ShaderCompiles++;
+
+	ShaderMap[shaderKey] = shaderID;
+	return shaderID; // return data	
+}
+
+const std::string& ShaderLoader::GetShaderSource(const char* filename)
+{
+	// every file is read from disk once, several programs share 3D_Normals.vs
+	std::map<std::string, std::string>::const_iterator Existing = SourceMap.find(filename);
+	if (Existing != SourceMap.end())
+	{
+		return Existing->second;
+	}
+	return SourceMap[filename] = ReadShaderFile(filename);
+}
+
+std::string ShaderLoader::GetStageDefines(const char* filename, const std::string& defines)
+{
+	// only the defines a file (or a file it includes) mentions change it, so 3D_Normals.vs stays one shader under every Lit.fs variant
+	const std::string source = ExpandIncludes(filename, GetShaderSource(filename));
+	std::istringstream input(defines);
+	std::string define;
+	std::string used;
+	while (input >> define)
+	{
+		if (ContainsIdentifier(source, define.substr(0, define.find('='))))
+		{
+			used += (used.empty() ? "" : " ") + define;
+		}
+	}
+	return used;
+}
+
+bool ShaderLoader::ContainsIdentifier(const std::string& source, const std::string& name)
+{
+	// whole identifiers only, POINT must not match LIGHTING_POINT or POINTS
+	for (size_t found = source.find(name); found != std::string::npos; found = source.find(name, found + 1))
+	{
+		size_t end = found + name.size();
+		bool startsWord = (found == 0) || !(isalnum((unsigned char)source[found - 1]) || source[found - 1] == '_');
+		bool endsWord = (end == source.size()) || !(isalnum((unsigned char)source[end]) || source[end] == '_');
+		if (startsWord && endsWord)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string ShaderLoader::GetShaderKey(const char* filename, const std::string& defines)
+{
+	std::string stageDefines = GetStageDefines(filename, defines);
+	return stageDefines.empty() ? std::string(filename) : std::string(filename) + " [" + stageDefines + "]";
+}
+
+std::string ShaderLoader::GetVariantSource(const char* filename, const std::string& defines)
+{
+	const std::string source = ExpandIncludes(filename, GetShaderSource(filename));
+
+	// bindings shared with the c++ side come from the same macros, so the two can not disagree
+	std::ostringstream block;
+	block << "#define LIGHT_BLOCK_BINDING " << LIGHT_BLOCK_BINDING << "\n"
+		<< "#define LIGHT_BUFFER_BINDING " << LIGHT_BUFFER_BINDING << "\n"
+		<< "#define CLUSTER_BLOCK_BINDING " << CLUSTER_BLOCK_BINDING << "\n"
+		<< "#define CLUSTER_BUFFER_BINDING " << CLUSTER_BUFFER_BINDING << "\n"
+		<< "#define LIGHT_INDEX_BUFFER_BINDING " << LIGHT_INDEX_BUFFER_BINDING << "\n"
+		<< "#define FRAME_BLOCK_BINDING " << FRAME_BLOCK_BINDING << "\n";
+
+	// the variant's own defines, "NAME" means NAME 1 and "NAME=VALUE" sets the value
+	std::istringstream input(GetStageDefines(filename, defines));
+	std::string define;
+	while (input >> define)
+	{
+		size_t equals = define.find('=');
+		if (equals == std::string::npos)
+		{
+			block << "#define " << define << " 1\n";
+		}
+		else
+		{
+			block << "#define " << define.substr(0, equals) << " " << define.substr(equals + 1) << "\n";
+		}
+	}
+
+	// the block goes right after #version (nothing may come before it), #line keeps the error line numbers of the file
+	size_t version = source.find("#version");
+	if (version == std::string::npos)
+	{
+		return block.str() + "#line 1\n" + source;
+	}
+	size_t lineEnd = source.find('\n', version);
+	if (lineEnd == std::string::npos)
+	{
+		return source + "\n" + block.str();
+	}
+	int nextLine = (int)std::count(source.begin(), source.begin() + lineEnd, '\n') + 2;
+	block << "#line " << nextLine << "\n";
+
+	// a 4.5 context gets the 460 shaders as 450, the only 460 feature they use (gl_DrawID) is an extension there
+	std::string versionLine = source.substr(version, lineEnd - version);
+	if (versionLine.find("460") != std::string::npos && GetContextVersion() < 46)
+	{
+		versionLine = "#version 450 core";
+		if (source.find("gl_DrawID") != std::string::npos)
+		{
+			versionLine += "\n#extension GL_ARB_shader_draw_parameters : require\n#define gl_DrawID gl_DrawIDARB";
+		}
+	}
+	return source.substr(0, version) + versionLine + "\n" + block.str() + source.substr(lineEnd + 1);
+}
+
+std::string ShaderLoader::ExpandIncludes(const char* filename, const std::string& source)
+{
+	if (source.find("#include") == std::string::npos)
+	{
+		return source;
+	}
+
+	// #include "File" is replaced by the file next to the shader (one level, the shared files include nothing),
+	// #line before and after it keeps the error line numbers of both files
+	std::string path = filename;
+	size_t slash = path.find_last_of("/\\");
+	std::string directory = (slash == std::string::npos) ? "" : path.substr(0, slash + 1);
+
+	std::string expanded;
+	size_t lineStart = 0;
+	int line = 1;
+	while (lineStart < source.size())
+	{
+		size_t lineEnd = source.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+		{
+			lineEnd = source.size();
+		}
+		std::string text = source.substr(lineStart, lineEnd - lineStart);
+		size_t directive = text.find_first_not_of(" \t");
+		size_t open = text.find('"');
+		size_t close = (open == std::string::npos) ? std::string::npos : text.find('"', open + 1);
+		if (directive != std::string::npos && text.compare(directive, 8, "#include") == 0 && close != std::string::npos)
+		{
+			std::string included = directory + text.substr(open + 1, close - open - 1);
+			expanded += "#line 1\n" + GetShaderSource(included.c_str()) + "\n#line " + std::to_string(line + 1) + "\n";
+		}
+		else
+		{
+			expanded += text + "\n";
+		}
+		lineStart = lineEnd + 1;
+		line++;
+	}
+	return expanded;
+}
+
+bool ShaderLoader::IncludesFile(const std::string& filename, const std::string& included)
+{
+	size_t slash = included.find_last_of("/\\");
+	std::string name = "\"" + ((slash == std::string::npos) ? included : included.substr(slash + 1)) + "\"";
+	const std::string& source = GetShaderSource(filename.c_str());
+	return source.find("#include") != std::string::npos && source.find(name) != std::string::npos;
+}
+
+int ShaderLoader::GetContextVersion()
+{
+	// major * 10 + minor, asked once (every program is created on the same context)
+	static int contextVersion = 0;
+	if (contextVersion == 0)
+	{
+		GLint major = 0;
+		GLint minor = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		contextVersion = (major * 10) + minor;
+	}
+	return contextVersion;
 }
 
 std::string ShaderLoader::ReadShaderFile(const char* filename)
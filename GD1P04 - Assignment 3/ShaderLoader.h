@@ -19,17 +19,87 @@
 #include <glfw3.h>
 #include <iostream>
 #include <map>
+#include <string>
+#include <vector>
+#include "ShaderProgram.h"
 
 class ShaderLoader
 {
 
 public:
-	static GLuint CreateProgram(const char* VertexShaderFilename, const char* FragmentShaderFilename, std::map<std::string, GLuint>& ShaderMap);
+	// linked programs are shared, asking again for the same stage set and defines returns the same program
+	// Defines is a space separated list such as "LIGHTING_POINT FOG_DENSITY=0.02", injected after the #version line
+	static ShaderProgram* CreateProgram(const char* VertexShaderFilename, const char* FragmentShaderFilename, std::map<std::string, GLuint>& ShaderMap, const char* Defines = "");
+	static ShaderProgram* CreateComputeProgram(const char* ComputeShaderFilename, std::map<std::string, GLuint>& ShaderMap, const char* Defines = "");
+
+	// starts compiling and linking without waiting, the Create call for the same stages picks the result up
+	static void BeginProgram(const char* VertexShaderFilename, const char* FragmentShaderFilename, std::map<std::string, GLuint>& ShaderMap, const char* Defines = "");
+	static void BeginComputeProgram(const char* ComputeShaderFilename, std::map<std::string, GLuint>& ShaderMap, const char* Defines = "");
+
+	// the loader owns every program it created
+	static void ReleasePrograms();
+
+	// defines added to every program created afterwards (each stage still only gets the ones it mentions)
+	static void SetGlobalDefines(const char* Defines);
+
+	// rebuilds every program that uses or includes the file, a program that fails to compile or link stays as it was
+	// the ShaderProgram objects are kept, so everyone holding one (and its handles) sees the new program
+	static int ReloadShader(const std::string& Filename);
+
+	// time spent creating programs so far, from source or from the program binary cache
+	static double GetStartupTime();
+	static void PrintStartupReport();
 
 private:
+	// stages and files of a program, kept for linking it again when a file changes
+	struct ProgramStages
+	{
+		std::vector<GLenum> Stages;
+		std::vector<std::string> Filenames;
+		std::string Defines;	// normalized, see NormalizeDefines
+	};
+
+	// a program whose link was started but not checked yet
+	struct PendingProgram
+	{
+		GLuint Program = 0;
+		uint64_t CacheKey = 0;
+		bool FromCache = false;
+		ProgramStages Source;
+	};
+
 	ShaderLoader(void);
 	~ShaderLoader(void);
-	static GLuint CreateShader(GLenum shaderType, const char* shaderName, std::map<std::string, GLuint>& ShaderMap);
+	static std::string NormalizeDefines(const char* Defines);
+	static std::string GetProgramName(const char* const* Filenames, int StageCount, const std::string& Defines);
+	static ShaderProgram* GetProgram(const GLenum* Stages, const char* const* Filenames, int StageCount, const std::string& Defines, std::map<std::string, GLuint>& ShaderMap);
+	static void BeginStages(const GLenum* Stages, const char* const* Filenames, int StageCount, const std::string& Defines, std::map<std::string, GLuint>& ShaderMap);
+	static ShaderProgram* FinishProgram(const std::string& ProgramName, std::map<std::string, GLuint>& ShaderMap);
+	static bool RelinkProgram(const std::string& ProgramName, const ProgramStages& Source, ShaderProgram* Target);
+	static ShaderProgram* CreateReflectedProgram(GLuint program, const std::string& programName);
+	static void BindFrameBlock(const ShaderProgram* Program);
+	static GLuint CreateShader(GLenum shaderType, const char* shaderName, const std::string& defines, std::map<std::string, GLuint>& ShaderMap);
+	static const std::string& GetShaderSource(const char* filename);
+	static std::string GetStageDefines(const char* filename, const std::string& defines);
+	static bool ContainsIdentifier(const std::string& source, const std::string& name);
+	static std::string GetShaderKey(const char* filename, const std::string& defines);
+	static std::string GetVariantSource(const char* filename, const std::string& defines);
+	static std::string ExpandIncludes(const char* filename, const std::string& source);
+	static bool IncludesFile(const std::string& filename, const std::string& included);
+	static int GetContextVersion();
 	static std::string ReadShaderFile(const char* filename);
 	static void PrintErrorDetails(bool isShader, GLuint id, const char* name);
+
+	static std::string GlobalDefines;
+	static std::map<std::string, std::string> SourceMap;
+	static std::map<std::string, PendingProgram> PendingPrograms;
+	static std::map<std::string, ShaderProgram*> ProgramMap;
+	static std::map<std::string, ProgramStages> StageMap;
+	static double StartupTime;
+	static int ProgramCount;
+	static int ProgramReuses;
+	static int ProgramRequests;
+	static int ShaderCompiles;
+	static int ShaderReuses;
+	static bool ParallelCompile;
 };
@@ -0,0 +1,241 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : ShaderProgram.cpp
+// Description    : uniform reflection and handle based uniform setters for linked programs
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "ShaderProgram.h"
+#include <cstring>
+
+int ShaderProgram::FrameUniformCalls = 0;
+int ShaderProgram::FrameNameLookups = 0;
+int ShaderProgram::FrameSkippedCalls = 0;
+
+ShaderProgram::ShaderProgram(GLuint ID, const std::string& Name)
+{
+	this->Name = Name;
+	Reflect(ID);
+}
+
+ShaderProgram::~ShaderProgram()
+{
+	if (ID != 0)
+	{
+		glDeleteProgram(ID);
+	}
+}
+
+GLuint ShaderProgram::GetID() const
+{
+	return ID;
+}
+
+const std::string& ShaderProgram::GetName() const
+{
+	return Name;
+}
+
+void ShaderProgram::Reflect(GLuint ID)
+{
+	this->ID = ID;
+	ActiveUniforms.clear();
+	UniformBlocks.clear();
+	StorageBlocks.clear();
+
+	// a program that failed to link has nothing to reflect, every handle resolves to -1
+	if (ID != 0)
+	{
+		GLint MaxNameLength = 0;
+		glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_MAX_NAME_LENGTH, &MaxNameLength);
+		std::vector<char> NameBuffer(glm::max(MaxNameLength, 1));
+
+		// plain uniforms, the ones inside blocks have no location and are skipped
+		GLint UniformCount = 0;
+		glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &UniformCount);
+		const GLenum Properties[] = { GL_LOCATION, GL_ARRAY_SIZE };
+		for (GLint i = 0; i < UniformCount; i++)
+		{
+			GLint Values[2];
+			glGetProgramResourceiv(ID, GL_UNIFORM, i, 2, Properties, 2, nullptr, Values);
+			if (Values[0] < 0)
+			{
+				continue;
+			}
+
+			glGetProgramResourceName(ID, GL_UNIFORM, i, (GLsizei)NameBuffer.size(), nullptr, NameBuffer.data());
+			std::string UniformName = NameBuffer.data();
+			ActiveUniforms[UniformName] = Values[0];
+
+			// arrays are reported as "Name[0]", also accept "Name" and every element (locations are consecutive)
+			size_t Suffix = UniformName.rfind("[0]");
+			if (Suffix != std::string::npos && Suffix + 3 == UniformName.size())
+			{
+				std::string BaseName = UniformName.substr(0, Suffix);
+				ActiveUniforms[BaseName] = Values[0];
+				for (GLint Element = 1; Element < Values[1]; Element++)
+				{
+					ActiveUniforms[BaseName + "[" + std::to_string(Element) + "]"] = Values[0] + Element;
+				}
+			}
+		}
+
+		// uniform and storage blocks by name, for binding them to fixed points
+		const GLenum BlockInterfaces[] = { GL_UNIFORM_BLOCK, GL_SHADER_STORAGE_BLOCK };
+		std::map<std::string, GLint>* BlockMaps[] = { &UniformBlocks, &StorageBlocks };
+		for (int b = 0; b < 2; b++)
+		{
+			GLint BlockCount = 0;
+			GLint MaxBlockNameLength = 0;
+			glGetProgramInterfaceiv(ID, BlockInterfaces[b], GL_ACTIVE_RESOURCES, &BlockCount);
+			glGetProgramInterfaceiv(ID, BlockInterfaces[b], GL_MAX_NAME_LENGTH, &MaxBlockNameLength);
+			std::vector<char> BlockName(glm::max(MaxBlockNameLength, 1));
+			for (GLint i = 0; i < BlockCount; i++)
+			{
+				glGetProgramResourceName(ID, BlockInterfaces[b], i, (GLsizei)BlockName.size(), nullptr, BlockName.data());
+				(*BlockMaps[b])[BlockName.data()] = i;
+			}
+		}
+	}
+
+	// resolve the handles that were already given out, a new program starts with its default values
+	for (size_t i = 0; i < HandleNames.size(); i++)
+	{
+		std::map<std::string, GLint>::const_iterator Found = ActiveUniforms.find(HandleNames[i]);
+		HandleLocations[i] = (Found != ActiveUniforms.end()) ? Found->second : -1;
+		HandleValues[i].clear();
+	}
+}
+
+size_t ShaderProgram::GetUniformCount() const
+{
+	return ActiveUniforms.size();
+}
+
+UniformHandle ShaderProgram::GetUniform(const std::string& Name)
+{
+	std::map<std::string, UniformHandle>::const_iterator Existing = Handles.find(Name);
+	if (Existing != Handles.end())
+	{
+		return Existing->second;
+	}
+
+	// only a new name is looked up in the reflected uniforms, the ones asked for before already have a handle
+	// (unknown names still get a handle, it resolves to -1 the same way glGetUniformLocation would)
+	FrameNameLookups++;
+	UniformHandle Handle = (UniformHandle)HandleNames.size();
+	std::map<std::string, GLint>::const_iterator Found = ActiveUniforms.find(Name);
+	HandleNames.push_back(Name);
+	HandleLocations.push_back((Found != ActiveUniforms.end()) ? Found->second : -1);
+	HandleValues.push_back(std::vector<unsigned char>());
+	Handles[Name] = Handle;
+	return Handle;
+}
+
+GLint ShaderProgram::GetLocation(UniformHandle Handle) const
+{
+	return HandleLocations[Handle];
+}
+
+GLint ShaderProgram::GetUniformBlock(const std::string& Name) const
+{
+	std::map<std::string, GLint>::const_iterator Found = UniformBlocks.find(Name);
+	return (Found != UniformBlocks.end()) ? Found->second : -1;
+}
+
+GLint ShaderProgram::GetStorageBlock(const std::string& Name) const
+{
+	std::map<std::string, GLint>::const_iterator Found = StorageBlocks.find(Name);
+	return (Found != StorageBlocks.end()) ? Found->second : -1;
+}
+
+void ShaderProgram::SetInt(UniformHandle Handle, GLint Value) const
+{
+	GLint Location = HandleLocations[Handle];
+	if (Location >= 0 && Changed(Handle, &Value, sizeof(Value)))
+	{
+		glUniform1i(Location, Value);
+		FrameUniformCalls++;
+	}
+}
+
+void ShaderProgram::SetFloat(UniformHandle Handle, float Value) const
+{
+	GLint Location = HandleLocations[Handle];
+	if (Location >= 0 && Changed(Handle, &Value, sizeof(Value)))
+	{
+		glUniform1f(Location, Value);
+		FrameUniformCalls++;
+	}
+}
+
+void ShaderProgram::SetVec3(UniformHandle Handle, const glm::vec3& Value) const
+{
+	GLint Location = HandleLocations[Handle];
+	if (Location >= 0 && Changed(Handle, glm::value_ptr(Value), sizeof(Value)))
+	{
+		glUniform3fv(Location, 1, glm::value_ptr(Value));
+		FrameUniformCalls++;
+	}
+}
+
+void ShaderProgram::SetVec4Array(UniformHandle Handle, const glm::vec4* Values, int Count) const
+{
+	GLint Location = HandleLocations[Handle];
+	if (Location >= 0 && Changed(Handle, glm::value_ptr(Values[0]), Count * sizeof(glm::vec4)))
+	{
+		glUniform4fv(Location, Count, glm::value_ptr(Values[0]));
+		FrameUniformCalls++;
+	}
+}
+
+void ShaderProgram::SetMat4(UniformHandle Handle, const glm::mat4& Value) const
+{
+	GLint Location = HandleLocations[Handle];
+	if (Location >= 0 && Changed(Handle, glm::value_ptr(Value), sizeof(Value)))
+	{
+		glUniformMatrix4fv(Location, 1, GL_FALSE, glm::value_ptr(Value));
+		FrameUniformCalls++;
+	}
+}
+
+bool ShaderProgram::Changed(UniformHandle Handle, const void* Value, size_t Size) const
+{
+	// uniform values belong to the program object, so the last one set through the handle is still in place
+	std::vector<unsigned char>& Last = HandleValues[Handle];
+	if (Last.size() == Size && memcmp(Last.data(), Value, Size) == 0)
+	{
+		FrameSkippedCalls++;
+		return false;
+	}
+	Last.assign((const unsigned char*)Value, (const unsigned char*)Value + Size);
+	return true;
+}
+
+int ShaderProgram::GetFrameUniformCalls()
+{
+	return FrameUniformCalls;
+}
+
+int ShaderProgram::GetFrameNameLookups()
+{
+	return FrameNameLookups;
+}
+
+int ShaderProgram::GetFrameSkippedCalls()
+{
+	return FrameSkippedCalls;
+}
+
+void ShaderProgram::ResetFrameStats()
+{
+	FrameUniformCalls = 0;
+	FrameNameLookups = 0;
+	FrameSkippedCalls = 0;
+}
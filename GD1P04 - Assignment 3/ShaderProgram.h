@@ -0,0 +1,76 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : ShaderProgram.h
+// Description    : class file for a linked program with its uniforms and blocks reflected at link time
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glm.hpp>
+#include <gtc/type_ptr.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+// index into the program's location table, stays valid if the program is linked again
+typedef int UniformHandle;
+
+class ShaderProgram
+{
+public:
+	ShaderProgram(GLuint ID, const std::string& Name);
+	~ShaderProgram();
+
+	GLuint GetID() const;
+	const std::string& GetName() const;
+
+	// reads every active uniform and block of the linked program, handles given out earlier are resolved again
+	void Reflect(GLuint ID);
+	size_t GetUniformCount() const;
+
+	// name lookups belong in setup code, the handle is what gets used every frame
+	UniformHandle GetUniform(const std::string& Name);
+	GLint GetLocation(UniformHandle Handle) const;
+	GLint GetUniformBlock(const std::string& Name) const;
+	GLint GetStorageBlock(const std::string& Name) const;
+
+	// set a uniform of the currently bound program, uniforms the linker removed and values that did not change
+	// since the last set through the same handle are skipped without a driver call
+	void SetInt(UniformHandle Handle, GLint Value) const;
+	void SetFloat(UniformHandle Handle, float Value) const;
+	void SetVec3(UniformHandle Handle, const glm::vec3& Value) const;
+	void SetVec4Array(UniformHandle Handle, const glm::vec4* Values, int Count) const;
+	void SetMat4(UniformHandle Handle, const glm::mat4& Value) const;
+
+	// driver uniform calls, calls skipped because the value was already set and name lookups of new handles since the last reset
+	static int GetFrameUniformCalls();
+	static int GetFrameSkippedCalls();
+	static int GetFrameNameLookups();
+	static void ResetFrameStats();
+
+private:
+	bool Changed(UniformHandle Handle, const void* Value, size_t Size) const;
+
+	GLuint ID;
+	std::string Name;
+
+	std::map<std::string, GLint> ActiveUniforms;
+	std::map<std::string, GLint> UniformBlocks;
+	std::map<std::string, GLint> StorageBlocks;
+
+	std::map<std::string, UniformHandle> Handles;
+	std::vector<std::string> HandleNames;
+	std::vector<GLint> HandleLocations;
+	mutable std::vector<std::vector<unsigned char>> HandleValues;	// empty until the first set, and after a new link
+
+	static int FrameUniformCalls;
+	static int FrameNameLookups;
+	static int FrameSkippedCalls;
+};
@@ -0,0 +1,205 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : ShaderWatcher.cpp
+// Description    : watches the shader directory on a background thread and collects the files that changed
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "ShaderWatcher.h"
+#include "CPUProfiler.h"
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+ShaderWatcher::ShaderWatcher(const std::string& Directory)
+	: Directory(Directory), Running(false), StopRequested(false)
+{
+#ifdef _WIN32
+	HANDLE Handle = CreateFileA(Directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (Handle == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Cannot watch " << Directory << ", shader hot reload is off" << std::endl;
+		return;
+	}
+	DirectoryHandle = Handle;
+#else
+	NotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	// close_write covers editors that save in place, moved_to the ones that save to a temporary file and rename it
+	if (NotifyHandle < 0 || inotify_add_watch(NotifyHandle, Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+	{
+		std::cout << "Cannot watch " << Directory << ", shader hot reload is off" << std::endl;
+		if (NotifyHandle >= 0)
+		{
+			close(NotifyHandle);
+			NotifyHandle = -1;
+		}
+		return;
+	}
+#endif
+
+	Running = true;
+	Thread = std::thread(&ShaderWatcher::Run, this);
+	std::cout << "Watching " << Directory << " for shader changes" << std::endl;
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+	StopRequested = true;
+	if (Thread.joinable())
+	{
+		Thread.join();
+	}
+
+#ifdef _WIN32
+	if (DirectoryHandle != nullptr)
+	{
+		CloseHandle(DirectoryHandle);
+	}
+#else
+	if (NotifyHandle >= 0)
+	{
+		close(NotifyHandle);
+	}
+#endif
+}
+
+bool ShaderWatcher::IsRunning() const
+{
+	return Running;
+}
+
+std::vector<std::string> ShaderWatcher::TakeChanges()
+{
+	std::vector<std::string> Settled;
+	std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> Lock(Mutex);
+	std::map<std::string, std::chrono::steady_clock::time_point>::iterator it = Changes.begin();
+	while (it != Changes.end())
+	{
+		if (Now - it->second >= SettleTime)
+		{
+			Settled.push_back(Directory + it->first);
+			it = Changes.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+	return Settled;
+}
+
+void ShaderWatcher::AddChange(const std::string& Name)
+{
+	// a later write of the same file restarts its settle time
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Changes[Name] = std::chrono::steady_clock::now();
+}
+
+void ShaderWatcher::Run()
+{
+	PROFILE_THREAD_NAME("Shader watcher");
+
+#ifdef _WIN32
+	OVERLAPPED Overlapped = {};
+	Overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+	alignas(DWORD) char Buffer[16 * 1024];
+	bool Pending = false;
+
+	while (StopRequested == false)
+	{
+		if (Pending == false)
+		{
+			ResetEvent(Overlapped.hEvent);
+			if (!ReadDirectoryChangesW(DirectoryHandle, Buffer, sizeof(Buffer), FALSE,
+				FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, NULL, &Overlapped, NULL))
+			{
+				std::cout << "Shader watcher stopped (ReadDirectoryChangesW failed)" << std::endl;
+				break;
+			}
+			Pending = true;
+		}
+
+		// short waits so a stop request is noticed quickly
+		if (WaitForSingleObject(Overlapped.hEvent, 100) != WAIT_OBJECT_0)
+		{
+			continue;
+		}
+		Pending = false;
+
+		DWORD Bytes = 0;
+		if (!GetOverlappedResult(DirectoryHandle, &Overlapped, &Bytes, FALSE) || Bytes == 0)
+		{
+			continue;	// the buffer overflowed, nothing to report
+		}
+
+		const char* Entry = Buffer;
+		while (true)
+		{
+			const FILE_NOTIFY_INFORMATION* Info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(Entry);
+			if (Info->Action == FILE_ACTION_MODIFIED || Info->Action == FILE_ACTION_ADDED || Info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+			{
+				int NameLength = (int)(Info->FileNameLength / sizeof(WCHAR));
+				int Size = WideCharToMultiByte(CP_UTF8, 0, Info->FileName, NameLength, NULL, 0, NULL, NULL);
+				std::string Name(Size, '\0');
+				WideCharToMultiByte(CP_UTF8, 0, Info->FileName, NameLength, &Name[0], Size, NULL, NULL);
+				AddChange(Name);
+			}
+			if (Info->NextEntryOffset == 0)
+			{
+				break;
+			}
+			Entry += Info->NextEntryOffset;
+		}
+	}
+
+	if (Pending == true)
+	{
+		CancelIoEx(DirectoryHandle, &Overlapped);
+		DWORD Bytes = 0;
+		GetOverlappedResult(DirectoryHandle, &Overlapped, &Bytes, TRUE);
+	}
+	CloseHandle(Overlapped.hEvent);
+#else
+	alignas(struct inotify_event) char Buffer[16 * 1024];
+	pollfd Poll = { NotifyHandle, POLLIN, 0 };
+
+	while (StopRequested == false)
+	{
+		// short waits so a stop request is noticed quickly
+		if (poll(&Poll, 1, 100) <= 0)
+		{
+			continue;
+		}
+
+		ssize_t Bytes = read(NotifyHandle, Buffer, sizeof(Buffer));
+		for (ssize_t Offset = 0; Offset < Bytes; )
+		{
+			const inotify_event* Event = reinterpret_cast<const inotify_event*>(Buffer + Offset);
+			if (Event->len > 0)
+			{
+				AddChange(Event->name);
+			}
+			Offset += sizeof(inotify_event) + Event->len;
+		}
+	}
+#endif
+
+	Running = false;
+}
@@ -0,0 +1,58 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : ShaderWatcher.h
+// Description    : class file for the background watcher of the shader directory, used for hot reloading
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// inotify on linux, ReadDirectoryChangesW on windows, nothing touches gl on the watcher thread
+class ShaderWatcher
+{
+public:
+	// Directory ends with a slash, e.g. "Resources/Shaders/"
+	ShaderWatcher(const std::string& Directory);
+	~ShaderWatcher();
+
+	bool IsRunning() const;
+
+	// files written since the last call, each as Directory + name
+	// a file is only handed out once it stayed untouched for SettleTime, editors often write in several steps
+	std::vector<std::string> TakeChanges();
+
+private:
+	ShaderWatcher(const ShaderWatcher&);
+	ShaderWatcher& operator=(const ShaderWatcher&);
+
+	void Run();
+	void AddChange(const std::string& Name);
+
+	std::string Directory;
+	std::thread Thread;
+	std::atomic<bool> Running;
+	std::atomic<bool> StopRequested;
+
+	std::mutex Mutex;
+	std::map<std::string, std::chrono::steady_clock::time_point> Changes;	// guarded by Mutex
+	const std::chrono::milliseconds SettleTime = std::chrono::milliseconds(100);
+
+#ifdef _WIN32
+	void* DirectoryHandle = nullptr;
+#else
+	int NotifyHandle = -1;
+#endif
+};
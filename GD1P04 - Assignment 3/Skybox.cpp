@@ -11,13 +11,17 @@
 // Mail           : valeriia.blokhina@mds.ac.nz
 //
 #include "Skybox.h"
+#include "CPUProfiler.h"
+#include "ProgramRegistry.h"
 
 Skybox::Skybox(std::map<std::string, GLuint> &ShaderMap, camera* Camera)
 {
+	PROFILE_FUNCTION();
+
 	// create the program
-	Program_Cubemap = ShaderLoader::CreateProgram("Resources/Shaders/SkyBox.vs",
-		"Resources/Shaders/SkyBox.fs",
-		ShaderMap);
+	Program_Cubemap = ProgramRegistry::Get(PROGRAM_SKYBOX, ShaderMap);
+	TextureHandle = Program_Cubemap->GetUniform("Texture0");
+	ModelMatHandle = Program_Cubemap->GetUniform("Model");
 	TextureID = NULL;
 
 	this->Camera = Camera;
@@ -81,7 +85,7 @@ Skybox::Skybox(std::map<std::string, GLuint> &ShaderMap, camera* Camera)
 	GLuint VBO;
 
 	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
+	GLState::BindVertexArray(VAO);
 
 	glGenBuffers(1, &VBO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -97,9 +101,11 @@ Skybox::Skybox(std::map<std::string, GLuint> &ShaderMap, camera* Camera)
 }
 void Skybox::ImageLoad()
 {
+	PROFILE_FUNCTION();
+
 	// create and bind new texture template
 	glGenTextures(1, &TextureID);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, TextureID);
+	GLState::BindTexture(0, GL_TEXTURE_CUBE_MAP, TextureID);
 
 	std::string FilePath[6];
 	FilePath[0] = "Right.jpg";
@@ -117,6 +123,7 @@ void Skybox::ImageLoad()
 
 	for (int i = 0; i < 6; i++)
 	{
+		PROFILE_SCOPE("Decode cubemap face");
 		std::string FullFilePath = "Resources/Textures/Cubemaps/MountainOutpost/" + FilePath[i];
 		unsigned char* ImageData = stbi_load(FullFilePath.c_str(), &ImageWidth, &ImageHeight, &ImageComponent, 0);
 
@@ -137,9 +144,8 @@ void Skybox::ImageLoad()
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	// generate mipmaps, free the memory and unbind the texture
+	// generate mipmaps and free the memory
 	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 }
 
 GLuint Skybox::GetTextureID()
@@ -150,24 +156,19 @@ GLuint Skybox::GetTextureID()
 void Skybox::Update(float Deltatime)
 {
 	ModelMat = glm::scale(glm::mat4(), glm::vec3(2000.0f, 2000.0f, 2000.0f));
-	PVMMat = Camera->GetMatrixPV() * ModelMat;
 }
 
 void Skybox::Render()
 {
-	glUseProgram(Program_Cubemap);
-	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+	GLState::UseProgram(Program_Cubemap->GetID());
+	GLState::Enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, TextureID);
-	glUniform1i(glGetUniformLocation(Program_Cubemap, "Texture0"), 0);
-	glUniformMatrix4fv(glGetUniformLocation(Program_Cubemap, "PVMMat"), 1, GL_FALSE, glm::value_ptr(PVMMat));
+	GLState::BindTexture(0, GL_TEXTURE_CUBE_MAP, TextureID);
+	Program_Cubemap->SetInt(TextureHandle, 0);
+	Program_Cubemap->SetMat4(ModelMatHandle, ModelMat);
 
-	glBindVertexArray(VAO);
+	GLState::BindVertexArray(VAO);
 	glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-	glUseProgram(0);
 
 }
 
@@ -14,6 +14,7 @@
 #include <glew.h>
 #include <glfw3.h>
 #include "ShaderLoader.h"
+#include "GLState.h"
 #include <stb_image.h> 
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
@@ -39,8 +40,8 @@ private:
 	// object matrices and components (global variables)
 	glm::mat4 ModelMat;
 
-	glm::mat4 PVMMat;
-
-	GLuint Program_Cubemap;
+	ShaderProgram* Program_Cubemap;
+	UniformHandle TextureHandle;
+	UniformHandle ModelMatHandle;
 
 };
\ No newline at end of file
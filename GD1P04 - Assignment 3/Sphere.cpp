@@ -11,9 +11,35 @@
 // Mail           : valeriia.blokhina@mds.ac.nz
 //
 #include "Sphere.h"
+#include "CPUProfiler.h"
 
 // Constructor
-Sphere::Sphere(float Radius, int Fidelity, GLuint TextureID, GLuint ProgramID, LightManager* light)
+Sphere::Sphere(float Radius, int Fidelity, GLuint TextureID, ShaderProgram* Program, TransformSystem* Transforms)
+{
+	PROFILE_FUNCTION();
+
+	// spheres with the same radius and fidelity share one mesh (and VAO)
+	const CachedMesh& Mesh = MeshCache::GetSphere(Radius, Fidelity);
+	VAO = Mesh.VAO;
+	IndexCount = Mesh.IndexCount;
+
+	DrawType = GL_TRIANGLES;
+
+	// storing textures and programs
+	this->Program = Program;
+
+	// uniform handles are looked up once, not every frame
+	TextureHandle = Program->GetUniform("ImageTexture0");
+	ModelMatHandle = Program->GetUniform("Model");
+	NormalMatHandle = Program->GetUniform("NormalMatrix");
+	this->TextureID = TextureID;
+
+	this->Transforms = Transforms;
+	Transform = Transforms->Add(ObjPosition, glm::angleAxis(glm::radians(ObjRotationAngle), glm::vec3(0.0f, 1.0f, 0.0f)), ObjScale);
+}
+
+// Builds interleaved position, texture coordinate and normal data for a sphere
+void Sphere::BuildGeometry(float Radius, int Fidelity, std::vector<GLfloat>& Vertices, std::vector<GLuint>& Indices)
 {
 	int VertexAttrib = 8;	// Float components are needed for each vertex point
 	int IndexPerQuad = 6;	// Indices needed to create a quad
@@ -23,8 +49,7 @@ Sphere::Sphere(float Radius, int Fidelity, GLuint TextureID, GLuint ProgramID, L
 	float Theta = 0.0f;
 
 	// Create the vertex array to hold the correct number of elements based on the fidelity of the sphere
-	int VertexCount = Fidelity * Fidelity * VertexAttrib;
-	GLfloat* Vertices = new GLfloat[VertexCount];
+	Vertices.resize(Fidelity * Fidelity * VertexAttrib);
 	int Element = 0;
 
 	// Each cycle moves down on the vertical (Y axis) to start the next ring
@@ -66,8 +91,7 @@ Sphere::Sphere(float Radius, int Fidelity, GLuint TextureID, GLuint ProgramID, L
 	}
 
 	// Create the index array to hold the correct number of elements based on the fidelity of the sphere
-	IndexCount = Fidelity * Fidelity * IndexPerQuad;
-	GLuint* Indices = new GLuint[IndexCount];
+	Indices.resize(Fidelity * Fidelity * IndexPerQuad);
 
 	Element = 0;	// Reset the element offset for the new array
 	for (int i = 0; i < Fidelity; i++)
@@ -85,53 +109,28 @@ Sphere::Sphere(float Radius, int Fidelity, GLuint TextureID, GLuint ProgramID, L
 			Indices[Element++] = (((i + 1) % Fidelity) * Fidelity) + ((j + 1) % Fidelity);
 		}
 	}
-
-	// Create the Vertex Array and associated buffers
-	GLuint VBO, EBO;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, VertexCount * sizeof(GLfloat), Vertices, GL_STATIC_DRAW);
-	glGenBuffers(1, &EBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, IndexCount * sizeof(GLuint), Indices, GL_STATIC_DRAW);
-
-	// Vertex Information (Position, Texture Coords and Normals)
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(5 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(2);
-
-	DrawType = GL_TRIANGLES;
-
-	// storing textures and programs
-	this->ProgramID = ProgramID;
-	this->TextureID = TextureID;
-	this->light = light;
-
-	// Clean up the used memory
-	delete[] Vertices;
-	delete[] Indices;
 }
 
 // Destructor
 Sphere::~Sphere()
 {
+	Transforms->Remove(Transform);
 }
 
 void Sphere::SetPosition(glm::vec3 position)
 {
 	ObjPosition = position;
+	Transforms->SetPosition(Transform, position);
 }
 
-void Sphere::Update(float DeltaTime, glm::mat4 CameraPV)
+// the matrix from the last TransformSystem::Update
+const glm::mat4& Sphere::GetModelMatrix() const
 {
-	// calculate the translation matrix
-	TranslationMat = glm::translate(glm::mat4(), ObjPosition);
+	return Transforms->GetModel(Transform);
+}
 
+void Sphere::Update(float DeltaTime)
+{
 	if (ObjRotationAngle > 360.0f)
 	{
 		ObjRotationAngle -= 360.0f;
@@ -139,52 +138,59 @@ void Sphere::Update(float DeltaTime, glm::mat4 CameraPV)
 
 	ObjRotationAngle += 0.5f;
 
-	// calculate the rotation matrix
-	RotationMat = glm::rotate(glm::mat4(), glm::radians(ObjRotationAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-
-	// calculate the scale matrix
-	ScaleMat = glm::scale(glm::mat4(), ObjScale);
-
-	// create object model matrix
-	ObjModelMat = TranslationMat * RotationMat * ScaleMat;
-
-	// calcualting PV camera
-	PVMMat = CameraPV * ObjModelMat;
+	// only the rotation changes, the model and normal matrices are built for every object at once in TransformSystem::Update
+	Transforms->SetRotation(Transform, glm::angleAxis(glm::radians(ObjRotationAngle), glm::vec3(0.0f, 1.0f, 0.0f)));
 }
 
 // Render the Sphere 
 void Sphere::Render()
 {
-	glUseProgram(ProgramID);
+	// state is left bound for the next object, the state cache drops whatever is already set
+	GLState::UseProgram(Program->GetID());
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, TextureID);
-	glUniform1i(glGetUniformLocation(ProgramID, "ImageTexture0"), 0);
+	GLState::BindTexture(0, GL_TEXTURE_2D, TextureID);
+	Program->SetInt(TextureHandle, 0);
 
-	light->Render(ProgramID);
+	Program->SetMat4(ModelMatHandle, Transforms->GetModel(Transform));
+	Program->SetMat4(NormalMatHandle, Transforms->GetNormal(Transform));
 
-	GLint ModelMatLoc = glGetUniformLocation(ProgramID, "Model");
-	glUniformMatrix4fv(ModelMatLoc, 1, GL_FALSE, glm::value_ptr(ObjModelMat));
-	GLint PVMMatLoc = glGetUniformLocation(ProgramID, "PVM");
-	glUniformMatrix4fv(PVMMatLoc, 1, GL_FALSE, glm::value_ptr(PVMMat));
+	// face culling
+	GLState::CullFace(GL_BACK);
+	GLState::SetEnabled(GL_CULL_FACE, facecull);
 
-	if (facecull == true)
-	{
-		glCullFace(GL_BACK);
-		glEnable(GL_CULL_FACE);	// face culling
-	}
-	glBindVertexArray(VAO);
+	GLState::BindVertexArray(VAO);
 	glDrawElements(DrawType, IndexCount, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
-	if (facecull == true)
-	{
-		glDisable(GL_CULL_FACE);	
-	}
+}
 
-	glUseProgram(0);
+// Queue the sphere for this frame, the queue decides the order and the shared state
+RenderItem& Sphere::Submit(RenderQueue* Queue, RenderPass Pass, glm::vec3 CameraPos)
+{
+	RenderItem& Item = Queue->Submit(Pass);
+	Item.Key = RenderQueue::MakeKey(Pass, Program->GetID(), TextureID, VAO, glm::distance(CameraPos, ObjPosition));
+	Item.Program = Program;
+	Item.TextureHandle = TextureHandle;
+	Item.ModelMatHandle = ModelMatHandle;
+	Item.NormalMatHandle = NormalMatHandle;
+	Item.TextureID = TextureID;
+	Item.VAO = VAO;
+	Item.DrawType = DrawType;
+	Item.IndexCount = IndexCount;
+	Item.FaceCull = facecull;
+	Item.ModelMat = Transforms->GetModel(Transform);
+	Item.NormalMat = Transforms->GetNormal(Transform);
+	return Item;
 }
 
 void Sphere::SetFaceCulling(bool faceculling)
 {
 	facecull = faceculling;
 }
+
+// switch the program the sphere is drawn with (e.g. the g-buffer program in deferred mode)
+void Sphere::SetProgram(ShaderProgram* Program)
+{
+	this->Program = Program;
+	TextureHandle = Program->GetUniform("ImageTexture0");
+	ModelMatHandle = Program->GetUniform("Model");
+	NormalMatHandle = Program->GetUniform("NormalMatrix");
+}
@@ -18,7 +18,12 @@
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <gtc/type_ptr.hpp>
-#include "LightManager.h"
+#include "ShaderProgram.h"
+#include "GLState.h"
+#include "RenderQueue.h"
+#include "MeshCache.h"
+#include "TransformSystem.h"
+#include <vector>
 
 #define _USE_MATH_DEFINES
 #include <cmath>
@@ -29,12 +34,16 @@ class Sphere
 	
 public:
 	// csphere functions
-	Sphere(float Radius, int Fidelity, GLuint TextureID, GLuint ProgramID, LightManager* light);
+	Sphere(float Radius, int Fidelity, GLuint TextureID, ShaderProgram* Program, TransformSystem* Transforms);
 	~Sphere();
 	void SetPosition(glm::vec3 position);
-	void Update(float DeltaTime, glm::mat4 CameraPV);
+	void Update(float DeltaTime);
 	void Render();
+	RenderItem& Submit(RenderQueue* Queue, RenderPass Pass, glm::vec3 CameraPos);
 	void SetFaceCulling(bool faceculling);
+	void SetProgram(ShaderProgram* Program);
+	const glm::mat4& GetModelMatrix() const;
+	static void BuildGeometry(float Radius, int Fidelity, std::vector<GLfloat>& Vertices, std::vector<GLuint>& Indices);
 
 private:
 	GLuint VAO;
@@ -43,15 +52,16 @@ private:
 	glm::vec3 ObjPosition = glm::vec3(0.0f, 0.0f, 0.0f);
 	float ObjRotationAngle = 0.0f;
 	glm::vec3 ObjScale = glm::vec3(0.5f, 0.5, 0.5f);
-	glm::mat4 TranslationMat;
-	glm::mat4 RotationMat;
-	glm::mat4 ScaleMat;
-	glm::mat4 ObjModelMat;
-	glm::mat4 PVMMat;
+
+	// the model and normal matrices are built by the transform system, one batch for every object
+	TransformSystem* Transforms;
+	TransformHandle Transform;
 
 	GLuint TextureID;
-	GLuint ProgramID;
-	LightManager* light;
+	ShaderProgram* Program;
+	UniformHandle TextureHandle;
+	UniformHandle ModelMatHandle;
+	UniformHandle NormalMatHandle;
 
 	int IndexCount;
 	int DrawType;
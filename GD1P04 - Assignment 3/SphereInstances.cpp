@@ -0,0 +1,141 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : SphereInstances.cpp
+// Description    : instance buffer upload and the single instanced draw of a group of spheres
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "SphereInstances.h"
+
+SphereInstances::SphereInstances(float Radius, int Fidelity, GLuint TextureID, ShaderProgram* Program)
+{
+	// shared mesh from the cache, the VAO adds this group's instance buffer to it
+	const CachedMesh& Mesh = MeshCache::GetSphere(Radius, Fidelity);
+	IndexCount = Mesh.IndexCount;
+	glGenBuffers(1, &InstanceVBO);
+	VAO = MeshCache::CreateInstancedVAO(Mesh, InstanceVBO);
+
+	// storing textures and programs
+	this->TextureID = TextureID;
+	SetProgram(Program);
+}
+
+SphereInstances::~SphereInstances()
+{
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &InstanceVBO);
+	GLState::Invalidate();
+}
+
+void SphereInstances::Add(const glm::mat4& ModelMat)
+{
+	InstanceTransform NewInstance;
+	NewInstance.Model = ModelMat;
+	Instances.push_back(NewInstance);
+	Dirty = true;
+}
+
+void SphereInstances::SetTransform(size_t Index, const glm::mat4& ModelMat)
+{
+	Instances[Index].Model = ModelMat;
+	Dirty = true;
+}
+
+void SphereInstances::Clear()
+{
+	Instances.clear();
+	Dirty = true;
+}
+
+size_t SphereInstances::GetInstanceCount() const
+{
+	return Instances.size();
+}
+
+GLuint SphereInstances::GetProgramID() const
+{
+	return Program->GetID();
+}
+
+void SphereInstances::SetProgram(ShaderProgram* Program)
+{
+	this->Program = Program;
+	TextureHandle = Program->GetUniform("ImageTexture0");
+	ModelMatHandle = Program->GetUniform("Model");
+	NormalMatHandle = Program->GetUniform("NormalMatrix");
+}
+
+void SphereInstances::SetFaceCulling(bool faceculling)
+{
+	facecull = faceculling;
+}
+
+void SphereInstances::Upload()
+{
+	if (Dirty == false)
+	{
+		return;
+	}
+
+	// a new set reallocates the buffer, moved spheres only rewrite their matrices
+	NormalMatrix::ComputeBatch(Instances.data(), Instances.size());
+	glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+	if (Instances.size() == UploadedCount)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, 0, Instances.size() * sizeof(InstanceTransform), Instances.data());
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, Instances.size() * sizeof(InstanceTransform), Instances.data(), GL_STATIC_DRAW);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	UploadedCount = Instances.size();
+	Dirty = false;
+}
+
+void SphereInstances::Render()
+{
+	if (Instances.empty())
+	{
+		return;
+	}
+	Upload();
+
+	GLState::UseProgram(Program->GetID());
+	GLState::BindTexture(0, GL_TEXTURE_2D, TextureID);
+	Program->SetInt(TextureHandle, 0);
+	Program->SetMat4(ModelMatHandle, glm::mat4());
+	Program->SetMat4(NormalMatHandle, glm::mat4());
+
+	GLState::CullFace(GL_BACK);
+	GLState::SetEnabled(GL_CULL_FACE, facecull);
+	GLState::BindVertexArray(VAO);
+	glDrawElementsInstanced(GL_TRIANGLES, IndexCount, GL_UNSIGNED_INT, 0, (GLsizei)UploadedCount);
+}
+
+RenderItem& SphereInstances::Submit(RenderQueue* Queue, RenderPass Pass)
+{
+	Upload();
+
+	// one item for the whole group, the instance matrices already place every sphere
+	RenderItem& Item = Queue->Submit(Pass);
+	Item.Key = RenderQueue::MakeKey(Pass, Program->GetID(), TextureID, VAO, 0.0f);
+	Item.Program = Program;
+	Item.TextureHandle = TextureHandle;
+	Item.ModelMatHandle = ModelMatHandle;
+	Item.NormalMatHandle = NormalMatHandle;
+	Item.TextureID = TextureID;
+	Item.VAO = VAO;
+	Item.IndexCount = IndexCount;
+	Item.InstanceCount = (int)UploadedCount;
+	Item.FaceCull = facecull;
+	Item.ModelMat = glm::mat4();
+	Item.NormalMat = glm::mat4();
+	return Item;
+}
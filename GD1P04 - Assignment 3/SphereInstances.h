@@ -0,0 +1,63 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : SphereInstances.h
+// Description    : class file for instanced spheres, every sphere with the same mesh, program and texture in one draw
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <vector>
+#include "ShaderProgram.h"
+#include "GLState.h"
+#include "MeshCache.h"
+#include "RenderQueue.h"
+
+class SphereInstances
+{
+public:
+	// the program needs the instanced vertex layout (3D_Instanced.vs)
+	SphereInstances(float Radius, int Fidelity, GLuint TextureID, ShaderProgram* Program);
+	~SphereInstances();
+
+	// model matrices are uploaded (with their normal matrices) on the next render after they change
+	void Add(const glm::mat4& ModelMat);
+	void SetTransform(size_t Index, const glm::mat4& ModelMat);
+	void Clear();
+	size_t GetInstanceCount() const;
+	GLuint GetProgramID() const;
+	void SetProgram(ShaderProgram* Program);
+	void SetFaceCulling(bool faceculling);
+
+	// one glDrawElementsInstanced no matter how many spheres there are
+	void Render();
+
+	// the same draw as one queue item, for the passes that need the queue's stencil state
+	RenderItem& Submit(RenderQueue* Queue, RenderPass Pass);
+
+private:
+	void Upload();
+
+	GLuint VAO;
+	GLuint InstanceVBO;
+	int IndexCount;
+
+	std::vector<InstanceTransform> Instances;
+	size_t UploadedCount = 0;
+	bool Dirty = false;
+	bool facecull = false;
+
+	GLuint TextureID;
+	ShaderProgram* Program;
+	UniformHandle TextureHandle;
+	UniformHandle ModelMatHandle;
+	UniformHandle NormalMatHandle;
+};
@@ -12,17 +12,138 @@
 //
 
 #include "Terrain.h"
+#include "CPUProfiler.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
 
-Terrain::Terrain(GLuint TextureID, GLuint ProgramID)
+Terrain::Terrain(const char* HeightmapFile, GLuint TextureID, ShaderProgram* Program, TransformSystem* Transforms)
 {    
+    PROFILE_FUNCTION();
+
     // creating terrain
-    const int squareSize = 256 / 2;
-    const int vertexAttribCount = 5;
+    BuildParams.GridSize = 256 / 2;
+    BuildParams.Spacing = 2.0f;
+    BuildParams.VertexStride = 5;
+    BuildParams.HeightScale = 0.2f;
+
+    // the loaded samples are part of the cache key, a new heightmap builds a new mesh
+    Heights.assign(BuildParams.GridSize * BuildParams.GridSize, 0.0f);
+    if (LoadHeightmap(HeightmapFile))
+    {
+        SmoothHeights();
+    }
+
+    // reuse the mesh built on a previous launch when neither the heights nor the parameters changed
+    std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+    uint64_t CacheKey = TerrainCache::ComputeKey(Heights.data(), Heights.size(), &BuildParams, sizeof(BuildParams));
+    TerrainCache Cache;
+    bool CacheHit = Cache.Load(CacheKey);
+
+    if (CacheHit)
+    {
+        // upload straight from the mapped file
+        const TerrainCacheHeader* Header = Cache.GetHeader();
+        UploadMesh(Cache.GetVertices(), (size_t)Header->VertexCount * Header->VertexStride, Cache.GetIndices(), Header->IndexCount);
+    }
+    else
+    {
+        std::vector<GLfloat> Vertices;
+        std::vector<GLuint> Indices;
+        BuildMesh(Vertices, Indices);
+
+        std::vector<TerrainLod> Lods;
+        Lods.push_back({ 0, (uint32_t)Indices.size() });
+        TerrainCache::Store(CacheKey, BuildParams.VertexStride, Vertices, Indices, Lods);
+
+        UploadMesh(Vertices.data(), Vertices.size(), Indices.data(), Indices.size());
+    }
+
+    double BuildTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+    std::cout << "Terrain mesh " << (CacheHit ? "loaded from cache (warm)" : "built (cold)") << " in " << BuildTime << " ms" << std::endl;
+
+    DrawType = GL_TRIANGLES;
+
+    // single channel float copy of the heights for shaders that place things on the surface
+    glGenTextures(1, &HeightTexture);
+    GLState::BindTexture(0, GL_TEXTURE_2D, HeightTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, BuildParams.GridSize, BuildParams.GridSize, 0, GL_RED, GL_FLOAT, Heights.data());
+
+    // storing textures and programs
+    this->Program = Program;
+
+    // uniform handles are looked up once, not every frame
+    TextureHandle = Program->GetUniform("ImageTexture0");
+    ModelMatHandle = Program->GetUniform("Model");
+    NormalMatHandle = Program->GetUniform("NormalMatrix");
+    this->TextureID = TextureID;
+
+    this->Transforms = Transforms;
+    Transform = Transforms->Add(ObjPosition, glm::angleAxis(glm::radians(ObjRotationAngle), glm::vec3(0.0f, 1.0f, 0.0f)), ObjScale);
+}
+
+// 8 bit raw file, GridSize x GridSize samples row by row (Tools/GenerateHeightmap.py writes one)
+bool Terrain::LoadHeightmap(const char* FilePath)
+{
+    std::vector<unsigned char> Samples(Heights.size());
+    std::ifstream File(FilePath, std::ios_base::binary);
+    if (!File.read((char*)Samples.data(), Samples.size()))
+    {
+        std::cout << "Terrain: could not read " << Samples.size() << " height samples from " << FilePath << ", the terrain stays flat" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < Samples.size(); i++)
+    {
+        Heights[i] = Samples[i] * BuildParams.HeightScale;
+    }
+    return true;
+}
+
+// averages every sample with its neighbours, 8 bit steps would otherwise show up as terraces
+void Terrain::SmoothHeights()
+{
+    const int squareSize = BuildParams.GridSize;
+    std::vector<float> Smoothed(Heights.size());
+
+    for (int i = 0; i < squareSize; i++)
+    {
+        for (int j = 0; j < squareSize; j++)
+        {
+            float Sum = 0.0f;
+            int Count = 0;
+            for (int di = -1; di <= 1; di++)
+            {
+                for (int dj = -1; dj <= 1; dj++)
+                {
+                    int Row = i + di;
+                    int Column = j + dj;
+                    if (Row >= 0 && Row < squareSize && Column >= 0 && Column < squareSize)
+                    {
+                        Sum += Heights[(Row * squareSize) + Column];
+                        Count++;
+                    }
+                }
+            }
+            Smoothed[(i * squareSize) + j] = Sum / Count;
+        }
+    }
+    Heights.swap(Smoothed);
+}
+
+void Terrain::BuildMesh(std::vector<GLfloat>& Vertices, std::vector<GLuint>& Indices)
+{
+    const int squareSize = BuildParams.GridSize;
+    const int vertexAttribCount = BuildParams.VertexStride;
     const int indexPerQuad = 6;	// Indices needed to create a quad
 
     // Create the vertex array to hold the correct number of elements
-    const int vertexCount = vertexAttribCount * squareSize * squareSize;
-    GLfloat verticesHeightMapQuad[vertexCount];
+    Vertices.resize(vertexAttribCount * squareSize * squareSize);
 
     int vertexElement = 0;
     float startPos = squareSize - 1;
@@ -31,28 +152,28 @@ Terrain::Terrain(GLuint TextureID, GLuint ProgramID)
     {
         for (size_t j = 0; j < squareSize; j++)
         {
-            float x = (-startPos + (2.0f * j));
-            float z = (-startPos + (2.0f * i));
+            float x = (-startPos + (BuildParams.Spacing * j));
+            float z = (-startPos + (BuildParams.Spacing * i));
 
             // X
-            verticesHeightMapQuad[vertexElement++] = x;
+            Vertices[vertexElement++] = x;
 
-            // Y = 0
-            verticesHeightMapQuad[vertexElement++] = 0;
+            // Y
+            Vertices[vertexElement++] = Heights[(i * squareSize) + j];
 
             // Z
-            verticesHeightMapQuad[vertexElement++] = z;
+            Vertices[vertexElement++] = z;
 
             // TexCoords.x
-            verticesHeightMapQuad[vertexElement++] = (j / startPos);
+            Vertices[vertexElement++] = (j / startPos);
 
             // TexCoords.y
-            verticesHeightMapQuad[vertexElement++] = ((startPos - i) / startPos);
+            Vertices[vertexElement++] = ((startPos - i) / startPos);
         }
     }
 
-    const int indexCount = indexPerQuad * squareSize * squareSize;
-    GLuint indicesHeightMapQuad[indexCount];
+    // only (squareSize - 1)^2 quads exist between the grid points
+    Indices.resize(indexPerQuad * (squareSize - 1) * (squareSize - 1));
 
     int Element = 0;
     for (size_t i = 0; i < (squareSize - 1); i++)
@@ -60,27 +181,32 @@ Terrain::Terrain(GLuint TextureID, GLuint ProgramID)
         for (size_t j = 0; j < (squareSize - 1); j++)
         {
             // First triangle of the quad
-            indicesHeightMapQuad[Element++] = ((i * squareSize) + j);
-            indicesHeightMapQuad[Element++] = (((i + 1) * squareSize) + j);
-            indicesHeightMapQuad[Element++] = (((i + 1) * squareSize) + (j + 1));
+            Indices[Element++] = ((i * squareSize) + j);
+            Indices[Element++] = (((i + 1) * squareSize) + j);
+            Indices[Element++] = (((i + 1) * squareSize) + (j + 1));
 
             // Second triangle of the quad
-            indicesHeightMapQuad[Element++] = ((i * squareSize) + j);
-            indicesHeightMapQuad[Element++] = (((i + 1) * squareSize) + (j + 1));
-            indicesHeightMapQuad[Element++] = ((i * squareSize) + (j + 1));
+            Indices[Element++] = ((i * squareSize) + j);
+            Indices[Element++] = (((i + 1) * squareSize) + (j + 1));
+            Indices[Element++] = ((i * squareSize) + (j + 1));
         }
     }
+}
 
-    // Create the Vertex Array and associated buffers
-    GLuint VBO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-    glGenBuffers(1, &VBO);
+void Terrain::UploadMesh(const GLfloat* Vertices, size_t VertexFloatCount, const GLuint* Indices, size_t IndexCount)
+{
+    // Create the Vertex Array and associated buffers (reused when the mesh is replaced)
+    if (VAO == 0)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+    }
+    GLState::BindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(GLfloat), verticesHeightMapQuad, GL_STATIC_DRAW);
-    glGenBuffers(1, &EBO);
+    glBufferData(GL_ARRAY_BUFFER, VertexFloatCount * sizeof(GLfloat), Vertices, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(GLuint), indicesHeightMapQuad, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, IndexCount * sizeof(GLuint), Indices, GL_STATIC_DRAW);
 
     // Vertex Information (Position, Texture Coords and Normals)
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (void*)0);
@@ -88,28 +214,23 @@ Terrain::Terrain(GLuint TextureID, GLuint ProgramID)
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
     glEnableVertexAttribArray(1);
 
-    this->IndexCount = indexCount;
-    DrawType = GL_TRIANGLES;
-
-    // storing textures and programs
-    this->ProgramID = ProgramID;
-    this->TextureID = TextureID;
+    this->IndexCount = (int)IndexCount;
 }
 
 Terrain::~Terrain()
 {
+    delete Adaptive;
+    Transforms->Remove(Transform);
 }
 
 void Terrain::SetPosition(glm::vec3 position)
 {
     ObjPosition = position;
+    Transforms->SetPosition(Transform, position);
 }
 
-void Terrain::Update(float DeltaTime, glm::mat4 CameraPV)
+void Terrain::Update(float DeltaTime)
 {
-    // calculate the translation matrix
-    TranslationMat = glm::translate(glm::mat4(), ObjPosition);
-
     //if (ObjRotationAngle > 360.0f)
     //{
     //    ObjRotationAngle -= 360.0f;
@@ -117,49 +238,278 @@ void Terrain::Update(float DeltaTime, glm::mat4 CameraPV)
 
     //ObjRotationAngle += 0.5f;
 
-    // calculate the rotation matrix
-    RotationMat = glm::rotate(glm::mat4(), glm::radians(ObjRotationAngle), glm::vec3(0.0f, 1.0f, 0.0f));
+    // the model and normal matrices are built with every other object's in TransformSystem::Update
+    Transforms->SetRotation(Transform, glm::angleAxis(glm::radians(ObjRotationAngle), glm::vec3(0.0f, 1.0f, 0.0f)));
+}
+
+void Terrain::Render()
+{
+    GLState::UseProgram(Program->GetID());
+
+    GLState::BindTexture(0, GL_TEXTURE_2D, TextureID);
+    Program->SetInt(TextureHandle, 0);
 
-    // calculate the scale matrix
-    ScaleMat = glm::scale(glm::mat4(), ObjScale);
+    Program->SetMat4(ModelMatHandle, Transforms->GetModel(Transform));
+    Program->SetMat4(NormalMatHandle, Transforms->GetNormal(Transform));
 
-    // create object model matrix
-    ObjModelMat = TranslationMat * RotationMat * ScaleMat;
+    // face culling
+    GLState::CullFace(GL_BACK);
+    GLState::SetEnabled(GL_CULL_FACE, facecull);
 
-    // calcualting PV camera
-    PVMMat = CameraPV * ObjModelMat;
+    GLState::BindVertexArray(VAO);
+    glDrawElements(DrawType, IndexCount, GL_UNSIGNED_INT, 0);
 }
 
-void Terrain::Render()
+// Queue the terrain for this frame, it covers most of the screen so the depth is the closest point of its bounds
+RenderItem& Terrain::Submit(RenderQueue* Queue, RenderPass Pass, glm::vec3 CameraPos)
 {
-    glUseProgram(ProgramID);
+    const glm::mat4& ObjModelMat = Transforms->GetModel(Transform);
+    glm::vec3 LocalCameraPos = glm::vec3(glm::inverse(ObjModelMat) * glm::vec4(CameraPos, 1.0f));
+    float HalfExtent = GetHalfExtent();
+    glm::vec3 Closest = glm::clamp(LocalCameraPos, glm::vec3(-HalfExtent, 0.0f, -HalfExtent), glm::vec3(HalfExtent, 0.0f, HalfExtent));
+    Closest.y = GetHeight(Closest.x, Closest.z);
+    float Depth = glm::distance(glm::vec3(ObjModelMat * glm::vec4(Closest, 1.0f)), CameraPos);
+
+    RenderItem& Item = Queue->Submit(Pass);
+    Item.Key = RenderQueue::MakeKey(Pass, Program->GetID(), TextureID, VAO, Depth);
+    Item.Program = Program;
+    Item.TextureHandle = TextureHandle;
+    Item.ModelMatHandle = ModelMatHandle;
+    Item.NormalMatHandle = NormalMatHandle;
+    Item.TextureID = TextureID;
+    Item.VAO = VAO;
+    Item.DrawType = DrawType;
+    Item.IndexCount = IndexCount;
+    Item.FaceCull = facecull;
+    Item.ModelMat = ObjModelMat;
+    Item.NormalMat = Transforms->GetNormal(Transform);
+    return Item;
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, TextureID);
-    glUniform1i(glGetUniformLocation(ProgramID, "ImageTexture0"), 0);
+void Terrain::SetFaceCulling(bool faceculling)
+{
+    facecull = faceculling;
+}
 
-    GLint ModelMatLoc = glGetUniformLocation(ProgramID, "Model");
-    glUniformMatrix4fv(ModelMatLoc, 1, GL_FALSE, glm::value_ptr(ObjModelMat));
-    GLint PVMMatLoc = glGetUniformLocation(ProgramID, "PVM");
-    glUniformMatrix4fv(PVMMatLoc, 1, GL_FALSE, glm::value_ptr(PVMMat));
+float Terrain::GetHeight(float x, float z) const
+{
+    // convert to grid coordinates and clamp to the edge of the map
+    const int squareSize = BuildParams.GridSize;
+    float gridX = glm::clamp((x + GetHalfExtent()) / BuildParams.Spacing, 0.0f, (float)(squareSize - 1));
+    float gridZ = glm::clamp((z + GetHalfExtent()) / BuildParams.Spacing, 0.0f, (float)(squareSize - 1));
+
+    int j0 = glm::min((int)gridX, squareSize - 2);
+    int i0 = glm::min((int)gridZ, squareSize - 2);
+    float fx = gridX - j0;
+    float fz = gridZ - i0;
+
+    // bilinear blend of the four surrounding samples
+    float h00 = Heights[(i0 * squareSize) + j0];
+    float h01 = Heights[(i0 * squareSize) + j0 + 1];
+    float h10 = Heights[((i0 + 1) * squareSize) + j0];
+    float h11 = Heights[((i0 + 1) * squareSize) + j0 + 1];
+    return glm::mix(glm::mix(h00, h01, fx), glm::mix(h10, h11, fx), fz);
+}
 
-    if (facecull == true)
+float Terrain::GetSlope(float x, float z) const
+{
+    // central differences, returned as the angle from horizontal in degrees
+    float step = BuildParams.Spacing;
+    float dx = (GetHeight(x + step, z) - GetHeight(x - step, z)) / (2.0f * step);
+    float dz = (GetHeight(x, z + step) - GetHeight(x, z - step)) / (2.0f * step);
+    return glm::degrees(atan(sqrt((dx * dx) + (dz * dz))));
+}
+
+float Terrain::GetHalfExtent() const
+{
+    return (float)(BuildParams.GridSize - 1);
+}
+
+void Terrain::GetHeightRange(float& MinHeight, float& MaxHeight) const
+{
+    MinHeight = Heights[0];
+    MaxHeight = Heights[0];
+    for (size_t i = 1; i < Heights.size(); i++)
     {
-        glCullFace(GL_BACK);
-        glEnable(GL_CULL_FACE);	// face culling
+        MinHeight = glm::min(MinHeight, Heights[i]);
+        MaxHeight = glm::max(MaxHeight, Heights[i]);
     }
-    glBindVertexArray(VAO);
-    glDrawElements(DrawType, IndexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-    if (facecull == true)
+}
+
+glm::mat4 Terrain::GetModelMatrix() const
+{
+    return glm::translate(glm::mat4(), ObjPosition) * glm::rotate(glm::mat4(), glm::radians(ObjRotationAngle), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::scale(glm::mat4(), ObjScale);
+}
+
+glm::mat4 Terrain::GetNormalMatrix() const
+{
+    return NormalMatrix::Compute(GetModelMatrix());
+}
+
+GLuint Terrain::GetHeightTexture() const
+{
+    return HeightTexture;
+}
+
+void Terrain::SetMaxError(float MaxError)
+{
+    std::vector<GLfloat> Vertices;
+    std::vector<GLuint> Indices;
+    if (MaxError > 0.0f)
     {
-        glDisable(GL_CULL_FACE);
+        BuildAdaptiveMesh(MaxError, Vertices, Indices);
     }
+    else
+    {
+        BuildMesh(Vertices, Indices);
+    }
+    UploadMesh(Vertices.data(), Vertices.size(), Indices.data(), Indices.size());
+    this->MaxError = MaxError;
+}
 
-    glUseProgram(0);
+float Terrain::GetMaxError() const
+{
+    return MaxError;
 }
 
-void Terrain::SetFaceCulling(bool faceculling)
+void Terrain::BuildAdaptiveMesh(float MaxError, std::vector<GLfloat>& Vertices, std::vector<GLuint>& Indices)
 {
-    facecull = faceculling;
+    // the RTIN needs a 2^n + 1 grid, resample the heights over the same extent
+    int tileSize = 1;
+    while (tileSize < BuildParams.GridSize - 1)
+    {
+        tileSize *= 2;
+    }
+    float halfExtent = GetHalfExtent();
+
+    if (Adaptive == nullptr)
+    {
+        std::vector<float> Samples((tileSize + 1) * (tileSize + 1));
+        for (int i = 0; i <= tileSize; i++)
+        {
+            for (int j = 0; j <= tileSize; j++)
+            {
+                float x = -halfExtent + ((2.0f * halfExtent * j) / tileSize);
+                float z = -halfExtent + ((2.0f * halfExtent * i) / tileSize);
+                Samples[(i * (tileSize + 1)) + j] = GetHeight(x, z);
+            }
+        }
+
+        Adaptive = new TerrainRTIN(tileSize + 1);
+        Adaptive->BuildErrors(Samples);
+    }
+
+    std::vector<GLuint> GridCoords;
+    Adaptive->Extract(MaxError, GridCoords, Indices);
+
+    // same vertex layout as the regular grid (position, texture coords)
+    size_t vertexCount = GridCoords.size() / 2;
+    Vertices.resize(vertexCount * BuildParams.VertexStride);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        float gridX = (float)GridCoords[(v * 2) + 0] / tileSize;
+        float gridZ = (float)GridCoords[(v * 2) + 1] / tileSize;
+        float x = -halfExtent + (2.0f * halfExtent * gridX);
+        float z = -halfExtent + (2.0f * halfExtent * gridZ);
+
+        Vertices[(v * 5) + 0] = x;
+        Vertices[(v * 5) + 1] = GetHeight(x, z);
+        Vertices[(v * 5) + 2] = z;
+        Vertices[(v * 5) + 3] = gridX;
+        Vertices[(v * 5) + 4] = 1.0f - gridZ;
+    }
+}
+
+void Terrain::ReportAdaptiveMesh()
+{
+    // triangle count and extraction time against the error tolerance
+    const float Tolerances[] = { 0.01f, 0.05f, 0.1f, 0.25f, 0.5f, 1.0f, 2.0f, 5.0f };
+    std::vector<GLfloat> Vertices;
+    std::vector<GLuint> Indices;
+
+    std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+    BuildAdaptiveMesh(Tolerances[0], Vertices, Indices);
+    double FirstTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+    std::cout << "RTIN error map + first extraction: " << FirstTime << " ms (regular grid: "
+        << 2 * (BuildParams.GridSize - 1) * (BuildParams.GridSize - 1) << " triangles)" << std::endl;
+
+    for (size_t i = 0; i < sizeof(Tolerances) / sizeof(Tolerances[0]); i++)
+    {
+        StartTime = std::chrono::high_resolution_clock::now();
+        BuildAdaptiveMesh(Tolerances[i], Vertices, Indices);
+        double ExtractTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+        std::cout << "RTIN max error " << Tolerances[i] << ": " << Indices.size() / 3 << " triangles, "
+            << Vertices.size() / BuildParams.VertexStride << " vertices, " << ExtractTime << " ms" << std::endl;
+    }
+}
+
+void Terrain::UseStaticMesh(float MaxError)
+{
+    // the error and tiling are part of the key so every tolerance gets its own cache file
+    struct StaticMeshParams
+    {
+        TerrainBuildParams Grid;
+        char Kind[4];
+        float MaxError;
+        int32_t TileSize;
+    };
+    StaticMeshParams Params;
+    memset(&Params, 0, sizeof(Params));
+    Params.Grid = BuildParams;
+    memcpy(Params.Kind, "TIN", 4);
+    Params.MaxError = MaxError;
+    Params.TileSize = StaticTileSize;
+
+    std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+    uint64_t CacheKey = TerrainCache::ComputeKey(Heights.data(), Heights.size(), &Params, sizeof(Params));
+    TerrainCache Cache;
+    bool CacheHit = Cache.Load(CacheKey);
+
+    if (CacheHit)
+    {
+        const TerrainCacheHeader* Header = Cache.GetHeader();
+        UploadMesh(Cache.GetVertices(), (size_t)Header->VertexCount * Header->VertexStride, Cache.GetIndices(), Header->IndexCount);
+    }
+    else
+    {
+        std::vector<GLfloat> Vertices;
+        std::vector<GLuint> Indices;
+        BuildStaticMesh(MaxError, Vertices, Indices);
+
+        std::vector<TerrainLod> Lods;
+        Lods.push_back({ 0, (uint32_t)Indices.size() });
+        TerrainCache::Store(CacheKey, BuildParams.VertexStride, Vertices, Indices, Lods);
+
+        UploadMesh(Vertices.data(), Vertices.size(), Indices.data(), Indices.size());
+    }
+    this->MaxError = MaxError;
+
+    double BuildTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+    std::cout << "TIN mesh (max error " << MaxError << "): " << IndexCount / 3 << " triangles, "
+        << (CacheHit ? "loaded from cache (warm)" : "built (cold)") << " in " << BuildTime << " ms" << std::endl;
+}
+
+void Terrain::BuildStaticMesh(float MaxError, std::vector<GLfloat>& Vertices, std::vector<GLuint>& Indices)
+{
+    // triangulated directly on the height samples, no resampling needed
+    std::vector<GLuint> GridCoords;
+    TerrainTIN Builder(Heights, BuildParams.GridSize);
+    Builder.Build(MaxError, StaticTileSize, GridCoords, Indices);
+
+    // same vertex layout as the regular grid (position, texture coords)
+    const int squareSize = BuildParams.GridSize;
+    float startPos = squareSize - 1;
+    size_t vertexCount = GridCoords.size() / 2;
+    Vertices.resize(vertexCount * BuildParams.VertexStride);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        GLuint j = GridCoords[(v * 2) + 0];
+        GLuint i = GridCoords[(v * 2) + 1];
+
+        Vertices[(v * 5) + 0] = (-startPos + (BuildParams.Spacing * j));
+        Vertices[(v * 5) + 1] = Heights[(i * squareSize) + j];
+        Vertices[(v * 5) + 2] = (-startPos + (BuildParams.Spacing * i));
+        Vertices[(v * 5) + 3] = (j / startPos);
+        Vertices[(v * 5) + 4] = ((startPos - i) / startPos);
+    }
 }
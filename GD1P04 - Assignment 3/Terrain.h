@@ -18,37 +18,94 @@
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <gtc/type_ptr.hpp>
+#include <vector>
+#include "ShaderProgram.h"
+#include "GLState.h"
+#include "RenderQueue.h"
+#include "TerrainCache.h"
+#include "TerrainRTIN.h"
+#include "TerrainTIN.h"
+#include "NormalMatrix.h"
+#include "TransformSystem.h"
 
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include <math.h>
 
+// parameters that shape the generated mesh, all of them are hashed into the cache key
+struct TerrainBuildParams
+{
+	int32_t GridSize;
+	float Spacing;
+	int32_t VertexStride;
+	float HeightScale;		// model units per heightmap step (0 - 255)
+};
+
 class Terrain
 {
 public:
 	// terrain functions
-	Terrain(GLuint TextureID, GLuint ProgramID);
+	Terrain(const char* HeightmapFile, GLuint TextureID, ShaderProgram* Program, TransformSystem* Transforms);
 	~Terrain();
 	void SetPosition(glm::vec3 position);
-	void Update(float DeltaTime, glm::mat4 CameraPV);
+	void Update(float DeltaTime);
 	void Render();
+	RenderItem& Submit(RenderQueue* Queue, RenderPass Pass, glm::vec3 CameraPos);
 	void SetFaceCulling(bool faceculling);
 
+	// queries in terrain (model) space, used to place objects on the surface
+	float GetHeight(float x, float z) const;
+	float GetSlope(float x, float z) const;
+	float GetHalfExtent() const;
+	void GetHeightRange(float& MinHeight, float& MaxHeight) const;
+	glm::mat4 GetModelMatrix() const;
+	glm::mat4 GetNormalMatrix() const;
+	GLuint GetHeightTexture() const;
+
+	// switches to the adaptive (RTIN) mesh, a max error of zero or less restores the full grid
+	void SetMaxError(float MaxError);
+	float GetMaxError() const;
+	void ReportAdaptiveMesh();
+
+	// switches to the minimum triangle (greedy delaunay) mesh for static levels, kept in the mesh cache
+	void UseStaticMesh(float MaxError);
+
 private:
-	GLuint VAO;
+	bool LoadHeightmap(const char* FilePath);
+	void SmoothHeights();
+	void BuildMesh(std::vector<GLfloat>& Vertices, std::vector<GLuint>& Indices);
+	void UploadMesh(const GLfloat* Vertices, size_t VertexFloatCount, const GLuint* Indices, size_t IndexCount);
+	void BuildAdaptiveMesh(float MaxError, std::vector<GLfloat>& Vertices, std::vector<GLuint>& Indices);
+	void BuildStaticMesh(float MaxError, std::vector<GLfloat>& Vertices, std::vector<GLuint>& Indices);
+
+	GLuint VAO = 0;
+	GLuint VBO = 0;
+	GLuint EBO = 0;
+
+	// height samples, one per grid vertex (row major)
+	TerrainBuildParams BuildParams;
+	std::vector<float> Heights;
+	GLuint HeightTexture;
+
+	// error map for the adaptive mesh, built the first time it is needed
+	TerrainRTIN* Adaptive = nullptr;
+	float MaxError = 0.0f;
+	int StaticTileSize = 32;
 
 	// object matrices and components (global variables)
 	glm::vec3 ObjPosition = glm::vec3(0.0f, 0.0f, 0.0f);
 	float ObjRotationAngle = 0.0f;
 	glm::vec3 ObjScale = glm::vec3(0.5f, 0.5, 0.5f);
-	glm::mat4 TranslationMat;
-	glm::mat4 RotationMat;
-	glm::mat4 ScaleMat;
-	glm::mat4 ObjModelMat;
-	glm::mat4 PVMMat;
+
+	// the model and normal matrices are built by the transform system, one batch for every object
+	TransformSystem* Transforms;
+	TransformHandle Transform;
 
 	GLuint TextureID;
-	GLuint ProgramID;
+	ShaderProgram* Program;
+	UniformHandle TextureHandle;
+	UniformHandle ModelMatHandle;
+	UniformHandle NormalMatHandle;
 
 	int IndexCount;
 	int DrawType;
@@ -0,0 +1,110 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : TerrainCache.cpp
+// Description    : writes built terrain meshes to disk and maps them back on the next launch
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "TerrainCache.h"
+#include <cstring>
+
+TerrainCache::TerrainCache()
+{
+}
+
+TerrainCache::~TerrainCache()
+{
+}
+
+uint64_t TerrainCache::ComputeKey(const float* Heights, size_t HeightCount, const void* BuildParams, size_t BuildParamsSize)
+{
+	uint32_t Version = TERRAIN_CACHE_VERSION;
+	uint64_t Key = BinaryCache::Hash(&Version, sizeof(Version));
+	Key = BinaryCache::Hash(BuildParams, BuildParamsSize, Key);
+	Key = BinaryCache::Hash(Heights, HeightCount * sizeof(float), Key);
+	return Key;
+}
+
+bool TerrainCache::Store(uint64_t Key, int VertexStride, const std::vector<GLfloat>& Vertices, const std::vector<GLuint>& Indices, const std::vector<TerrainLod>& Lods)
+{
+	TerrainCacheHeader NewHeader;
+	memcpy(NewHeader.Magic, "TMSH", 4);
+	NewHeader.Version = TERRAIN_CACHE_VERSION;
+	NewHeader.Key = Key;
+	NewHeader.VertexStride = (uint32_t)VertexStride;
+	NewHeader.VertexCount = (uint32_t)(Vertices.size() / VertexStride);
+	NewHeader.IndexCount = (uint32_t)Indices.size();
+	NewHeader.LodCount = (uint32_t)Lods.size();
+
+	std::vector<BinaryCache::Block> Blocks;
+	Blocks.push_back({ &NewHeader, sizeof(NewHeader) });
+	Blocks.push_back({ Lods.data(), Lods.size() * sizeof(TerrainLod) });
+	Blocks.push_back({ Vertices.data(), Vertices.size() * sizeof(GLfloat) });
+	Blocks.push_back({ Indices.data(), Indices.size() * sizeof(GLuint) });
+
+	return BinaryCache::WriteFile(GetPath(Key), Blocks);
+}
+
+bool TerrainCache::Load(uint64_t Key)
+{
+	Header = nullptr;
+	if (!File.Open(GetPath(Key)))
+	{
+		return false;
+	}
+
+	// reject anything truncated, from another version or from a hash collision on the file name
+	const TerrainCacheHeader* FileHeader = reinterpret_cast<const TerrainCacheHeader*>(File.GetData());
+	if (File.GetSize() < sizeof(TerrainCacheHeader) ||
+		memcmp(FileHeader->Magic, "TMSH", 4) != 0 ||
+		FileHeader->Version != TERRAIN_CACHE_VERSION ||
+		FileHeader->Key != Key)
+	{
+		File.Close();
+		return false;
+	}
+
+	size_t ExpectedSize = sizeof(TerrainCacheHeader)
+		+ (size_t)FileHeader->LodCount * sizeof(TerrainLod)
+		+ (size_t)FileHeader->VertexCount * FileHeader->VertexStride * sizeof(GLfloat)
+		+ (size_t)FileHeader->IndexCount * sizeof(GLuint);
+	if (File.GetSize() != ExpectedSize)
+	{
+		File.Close();
+		return false;
+	}
+
+	Header = FileHeader;
+	return true;
+}
+
+const TerrainCacheHeader* TerrainCache::GetHeader() const
+{
+	return Header;
+}
+
+const TerrainLod* TerrainCache::GetLods() const
+{
+	return reinterpret_cast<const TerrainLod*>(File.GetData() + sizeof(TerrainCacheHeader));
+}
+
+const GLfloat* TerrainCache::GetVertices() const
+{
+	return reinterpret_cast<const GLfloat*>(GetLods() + Header->LodCount);
+}
+
+const GLuint* TerrainCache::GetIndices() const
+{
+	return reinterpret_cast<const GLuint*>(GetVertices() + (size_t)Header->VertexCount * Header->VertexStride);
+}
+
+std::string TerrainCache::GetPath(uint64_t Key)
+{
+	return BinaryCache::MakePath("Terrain_", Key, ".mesh");
+}
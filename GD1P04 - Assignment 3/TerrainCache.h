@@ -0,0 +1,63 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : TerrainCache.h
+// Description    : class file for the binary cache of built terrain meshes
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <vector>
+#include "BinaryCache.h"
+
+// bump whenever the layout of the file or of the generated mesh changes
+#define TERRAIN_CACHE_VERSION 1
+
+// one level of detail, a range inside the shared index array
+struct TerrainLod
+{
+	uint32_t IndexOffset;
+	uint32_t IndexCount;
+};
+
+// file layout: header, lod table, vertices, indices
+struct TerrainCacheHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint64_t Key;
+	uint32_t VertexStride;	// floats per vertex
+	uint32_t VertexCount;
+	uint32_t IndexCount;
+	uint32_t LodCount;
+};
+
+class TerrainCache
+{
+public:
+	TerrainCache();
+	~TerrainCache();
+
+	// key built from the height samples and every parameter that changes the generated mesh
+	static uint64_t ComputeKey(const float* Heights, size_t HeightCount, const void* BuildParams, size_t BuildParamsSize);
+	static bool Store(uint64_t Key, int VertexStride, const std::vector<GLfloat>& Vertices, const std::vector<GLuint>& Indices, const std::vector<TerrainLod>& Lods);
+
+	// maps the cache file for the key, pointers below stay valid until the cache is destroyed
+	bool Load(uint64_t Key);
+	const TerrainCacheHeader* GetHeader() const;
+	const TerrainLod* GetLods() const;
+	const GLfloat* GetVertices() const;
+	const GLuint* GetIndices() const;
+
+private:
+	static std::string GetPath(uint64_t Key);
+
+	MappedFile File;
+	const TerrainCacheHeader* Header = nullptr;
+};
@@ -0,0 +1,178 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : TerrainRTIN.cpp
+// Description    : longest-edge bisection error map and linear time mesh extraction (martini style)
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "TerrainRTIN.h"
+#include <algorithm>
+#include <cmath>
+
+TerrainRTIN::TerrainRTIN(int GridSize)
+{
+	this->GridSize = GridSize;
+	int TileSize = GridSize - 1;
+	TriangleCount = (TileSize * TileSize * 2) - 2;
+	ParentTriangleCount = TriangleCount - (TileSize * TileSize);
+	Coords.resize(TriangleCount * 4);
+
+	// walk the implicit binary tree, triangle id 2 and 3 are the two halves of the square
+	for (int i = 0; i < TriangleCount; i++)
+	{
+		int id = i + 2;
+		int ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+		if (id & 1)
+		{
+			bx = by = cx = TileSize;	// bottom-left triangle
+		}
+		else
+		{
+			ax = ay = cy = TileSize;	// top-right triangle
+		}
+
+		while ((id >>= 1) > 1)
+		{
+			int mx = (ax + bx) >> 1;
+			int my = (ay + by) >> 1;
+
+			if (id & 1)
+			{
+				// left half
+				bx = ax; by = ay;
+				ax = cx; ay = cy;
+			}
+			else
+			{
+				// right half
+				ax = bx; ay = by;
+				bx = cx; by = cy;
+			}
+			cx = mx;
+			cy = my;
+		}
+
+		Coords[(i * 4) + 0] = (unsigned short)ax;
+		Coords[(i * 4) + 1] = (unsigned short)ay;
+		Coords[(i * 4) + 2] = (unsigned short)bx;
+		Coords[(i * 4) + 3] = (unsigned short)by;
+	}
+}
+
+TerrainRTIN::~TerrainRTIN()
+{
+}
+
+void TerrainRTIN::BuildErrors(const std::vector<float>& Heights)
+{
+	Errors.assign(GridSize * GridSize, 0.0f);
+
+	// smallest triangles first so every parent can take the maximum of its children
+	for (int i = TriangleCount - 1; i >= 0; i--)
+	{
+		int ax = Coords[(i * 4) + 0];
+		int ay = Coords[(i * 4) + 1];
+		int bx = Coords[(i * 4) + 2];
+		int by = Coords[(i * 4) + 3];
+		int mx = (ax + bx) >> 1;
+		int my = (ay + by) >> 1;
+		int cx = mx + my - ay;
+		int cy = my + ax - mx;
+
+		// error at the middle of the long edge
+		float Interpolated = (Heights[(ay * GridSize) + ax] + Heights[(by * GridSize) + bx]) / 2.0f;
+		int Middle = (my * GridSize) + mx;
+		float MiddleError = fabs(Interpolated - Heights[Middle]);
+		Errors[Middle] = std::max(Errors[Middle], MiddleError);
+
+		if (i < ParentTriangleCount)
+		{
+			int LeftChild = (((ay + cy) >> 1) * GridSize) + ((ax + cx) >> 1);
+			int RightChild = (((by + cy) >> 1) * GridSize) + ((bx + cx) >> 1);
+			Errors[Middle] = std::max(Errors[Middle], std::max(Errors[LeftChild], Errors[RightChild]));
+		}
+	}
+}
+
+void TerrainRTIN::Extract(float MaxError, std::vector<GLuint>& GridCoords, std::vector<GLuint>& Triangles)
+{
+	this->MaxError = MaxError;
+	VertexIndices.assign(GridSize * GridSize, 0);
+	VertexCount = 0;
+	OutputTriangleCount = 0;
+
+	// first pass numbers the used samples and counts triangles, second pass writes them
+	int Max = GridSize - 1;
+	CountElements(0, 0, Max, Max, Max, 0);
+	CountElements(Max, Max, 0, 0, 0, Max);
+
+	GridCoords.resize(VertexCount * 2);
+	Triangles.resize(OutputTriangleCount * 3);
+	OutCoords = &GridCoords;
+	OutTriangles = &Triangles;
+	OutputTriangleCount = 0;
+	EmitTriangles(0, 0, Max, Max, Max, 0);
+	EmitTriangles(Max, Max, 0, 0, 0, Max);
+}
+
+int TerrainRTIN::GetGridSize() const
+{
+	return GridSize;
+}
+
+void TerrainRTIN::CountElements(int ax, int ay, int bx, int by, int cx, int cy)
+{
+	int mx = (ax + bx) >> 1;
+	int my = (ay + by) >> 1;
+
+	if (abs(ax - cx) + abs(ay - cy) > 1 && Errors[(my * GridSize) + mx] > MaxError)
+	{
+		CountElements(cx, cy, ax, ay, mx, my);
+		CountElements(bx, by, cx, cy, mx, my);
+	}
+	else
+	{
+		// indices are stored plus one so zero means unused
+		GLuint& a = VertexIndices[(ay * GridSize) + ax];
+		GLuint& b = VertexIndices[(by * GridSize) + bx];
+		GLuint& c = VertexIndices[(cy * GridSize) + cx];
+		if (a == 0) a = ++VertexCount;
+		if (b == 0) b = ++VertexCount;
+		if (c == 0) c = ++VertexCount;
+		OutputTriangleCount++;
+	}
+}
+
+void TerrainRTIN::EmitTriangles(int ax, int ay, int bx, int by, int cx, int cy)
+{
+	int mx = (ax + bx) >> 1;
+	int my = (ay + by) >> 1;
+
+	if (abs(ax - cx) + abs(ay - cy) > 1 && Errors[(my * GridSize) + mx] > MaxError)
+	{
+		EmitTriangles(cx, cy, ax, ay, mx, my);
+		EmitTriangles(bx, by, cx, cy, mx, my);
+	}
+	else
+	{
+		GLuint a = VertexIndices[(ay * GridSize) + ax] - 1;
+		GLuint b = VertexIndices[(by * GridSize) + bx] - 1;
+		GLuint c = VertexIndices[(cy * GridSize) + cx] - 1;
+
+		std::vector<GLuint>& Out = *OutCoords;
+		Out[(2 * a) + 0] = ax; Out[(2 * a) + 1] = ay;
+		Out[(2 * b) + 0] = bx; Out[(2 * b) + 1] = by;
+		Out[(2 * c) + 0] = cx; Out[(2 * c) + 1] = cy;
+
+		(*OutTriangles)[(OutputTriangleCount * 3) + 0] = a;
+		(*OutTriangles)[(OutputTriangleCount * 3) + 1] = b;
+		(*OutTriangles)[(OutputTriangleCount * 3) + 2] = c;
+		OutputTriangleCount++;
+	}
+}
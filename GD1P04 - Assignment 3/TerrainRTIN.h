@@ -0,0 +1,51 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : TerrainRTIN.h
+// Description    : class file for the right-triangulated irregular network (adaptive terrain mesh)
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <vector>
+
+class TerrainRTIN
+{
+public:
+	// grid size has to be a power of two plus one (65, 129, 257...)
+	TerrainRTIN(int GridSize);
+	~TerrainRTIN();
+
+	// builds the hierarchical error map once, heights are GridSize x GridSize row major
+	void BuildErrors(const std::vector<float>& Heights);
+
+	// watertight mesh where no skipped sample is further than MaxError from the surface
+	// outputs grid coordinates (x, y pairs) of the used samples and the triangle indices into them
+	void Extract(float MaxError, std::vector<GLuint>& GridCoords, std::vector<GLuint>& Triangles);
+
+	int GetGridSize() const;
+
+private:
+	void CountElements(int ax, int ay, int bx, int by, int cx, int cy);
+	void EmitTriangles(int ax, int ay, int bx, int by, int cx, int cy);
+
+	int GridSize;
+	int TriangleCount;
+	int ParentTriangleCount;
+	std::vector<unsigned short> Coords;	// a and b corners of every triangle in the implicit binary tree
+	std::vector<float> Errors;
+
+	// state used while extracting
+	float MaxError;
+	std::vector<GLuint> VertexIndices;
+	GLuint VertexCount;
+	GLuint OutputTriangleCount;
+	std::vector<GLuint>* OutCoords;
+	std::vector<GLuint>* OutTriangles;
+};
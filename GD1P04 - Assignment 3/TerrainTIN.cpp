@@ -0,0 +1,618 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : TerrainTIN.cpp
+// Description    : greedy insertion delaunay triangulation of the height grid, tiles are built in parallel
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "TerrainTIN.h"
+#include "CPUProfiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+// twice the signed area of the triangle, positive for the winding used by the terrain grid
+static int64_t Orient(glm::ivec2 a, glm::ivec2 b, glm::ivec2 c)
+{
+	return ((int64_t)(b.y - a.y) * (c.x - a.x)) - ((int64_t)(b.x - a.x) * (c.y - a.y));
+}
+
+// true when p is inside the circumcircle of a, b, c (works for either winding)
+static bool InCircle(glm::ivec2 a, glm::ivec2 b, glm::ivec2 c, glm::ivec2 p)
+{
+	int64_t dx = a.x - p.x;
+	int64_t dy = a.y - p.y;
+	int64_t ex = b.x - p.x;
+	int64_t ey = b.y - p.y;
+	int64_t fx = c.x - p.x;
+	int64_t fy = c.y - p.y;
+
+	int64_t ap = (dx * dx) + (dy * dy);
+	int64_t bp = (ex * ex) + (ey * ey);
+	int64_t cp = (fx * fx) + (fy * fy);
+
+	int64_t Det = (dx * ((ey * cp) - (bp * fy))) - (dy * ((ex * cp) - (bp * fx))) + (ap * ((ex * fy) - (ey * fx)));
+	return (Orient(a, b, c) < 0) ? (Det > 0) : (Det < 0);
+}
+
+TINTriangulator::TINTriangulator(const float* Heights, int GridWidth, glm::ivec2 Min, glm::ivec2 Max)
+{
+	this->Heights = Heights;
+	this->GridWidth = GridWidth;
+	this->Min = Min;
+	this->Max = Max;
+}
+
+TINTriangulator::~TINTriangulator()
+{
+}
+
+void TINTriangulator::Run(float MaxError, const std::vector<glm::ivec2>& BorderPoints)
+{
+	// two triangles covering the tile
+	int p0 = AddPoint(Min);
+	int p1 = AddPoint(glm::ivec2(Max.x, Min.y));
+	int p2 = AddPoint(glm::ivec2(Min.x, Max.y));
+	int p3 = AddPoint(Max);
+	int t0 = AddTriangle(p3, p0, p2, -1, -1, -1, -1);
+	AddTriangle(p0, p3, p1, t0, -1, -1, -1);
+
+	// fixed border points, they lie on the hull so they always split a border edge
+	for (size_t i = 0; i < BorderPoints.size(); i++)
+	{
+		InsertPoint(FindTriangle(BorderPoints[i]), BorderPoints[i]);
+	}
+
+	// find the worst point of every triangle once the border is in place
+	Pending.clear();
+	for (int t = 0; t < (int)Triangles.size() / 3; t++)
+	{
+		Pending.push_back(t);
+	}
+	Flush();
+
+	// keep inserting the worst point until every triangle is within the error
+	while (!Queue.empty() && Errors[Queue[0]] > MaxError)
+	{
+		int t = QueuePop();
+		InsertPoint(t, Candidates[t]);
+		Flush();
+	}
+}
+
+const std::vector<glm::ivec2>& TINTriangulator::GetPoints() const
+{
+	return Points;
+}
+
+void TINTriangulator::GetTriangles(std::vector<int>& Output) const
+{
+	Output = Triangles;
+}
+
+float TINTriangulator::HeightAt(glm::ivec2 Point) const
+{
+	return Heights[(Point.y * GridWidth) + Point.x];
+}
+
+int TINTriangulator::AddPoint(glm::ivec2 Point)
+{
+	Points.push_back(Point);
+	return (int)Points.size() - 1;
+}
+
+int TINTriangulator::AddTriangle(int a, int b, int c, int ab, int bc, int ca, int e)
+{
+	int t;
+	if (e < 0)
+	{
+		// new triangle
+		t = (int)Triangles.size();
+		Triangles.push_back(a);
+		Triangles.push_back(b);
+		Triangles.push_back(c);
+		Halfedges.push_back(ab);
+		Halfedges.push_back(bc);
+		Halfedges.push_back(ca);
+		Candidates.push_back(glm::ivec2(0));
+		Errors.push_back(0.0f);
+		QueueIndexes.push_back(-1);
+	}
+	else
+	{
+		// reuse the slot of a triangle that was split or flipped
+		t = e;
+		Triangles[t + 0] = a;
+		Triangles[t + 1] = b;
+		Triangles[t + 2] = c;
+		Halfedges[t + 0] = ab;
+		Halfedges[t + 1] = bc;
+		Halfedges[t + 2] = ca;
+	}
+
+	// link the neighbours back to this triangle
+	if (ab >= 0) Halfedges[ab] = t + 0;
+	if (bc >= 0) Halfedges[bc] = t + 1;
+	if (ca >= 0) Halfedges[ca] = t + 2;
+
+	Pending.push_back(t / 3);
+	return t;
+}
+
+void TINTriangulator::InsertPoint(int t, glm::ivec2 Point)
+{
+	int e0 = (t * 3) + 0;
+	int e1 = (t * 3) + 1;
+	int e2 = (t * 3) + 2;
+	int p0 = Triangles[e0];
+	int p1 = Triangles[e1];
+	int p2 = Triangles[e2];
+	glm::ivec2 a = Points[p0];
+	glm::ivec2 b = Points[p1];
+	glm::ivec2 c = Points[p2];
+	int pn = AddPoint(Point);
+
+	// a point on an edge splits both triangles that share it
+	if (Orient(a, b, Point) == 0)
+	{
+		HandleCollinear(pn, e0);
+	}
+	else if (Orient(b, c, Point) == 0)
+	{
+		HandleCollinear(pn, e1);
+	}
+	else if (Orient(c, a, Point) == 0)
+	{
+		HandleCollinear(pn, e2);
+	}
+	else
+	{
+		int h0 = Halfedges[e0];
+		int h1 = Halfedges[e1];
+		int h2 = Halfedges[e2];
+
+		int n0 = AddTriangle(p0, p1, pn, h0, -1, -1, e0);
+		int n1 = AddTriangle(p1, p2, pn, h1, -1, n0 + 1, -1);
+		int n2 = AddTriangle(p2, p0, pn, h2, n0 + 2, n1 + 1, -1);
+
+		Legalize(n0);
+		Legalize(n1);
+		Legalize(n2);
+	}
+}
+
+void TINTriangulator::HandleCollinear(int pn, int a)
+{
+	int a0 = a - (a % 3);
+	int al = a0 + ((a + 1) % 3);
+	int ar = a0 + ((a + 2) % 3);
+	int p0 = Triangles[ar];
+	int pr = Triangles[a];
+	int pl = Triangles[al];
+	int hal = Halfedges[al];
+	int har = Halfedges[ar];
+
+	int b = Halfedges[a];
+	if (b < 0)
+	{
+		// the edge is on the tile border, only one triangle to split
+		int t0 = AddTriangle(pn, p0, pr, -1, har, -1, a0);
+		int t1 = AddTriangle(p0, pn, pl, t0, -1, hal, -1);
+		Legalize(t0 + 1);
+		Legalize(t1 + 2);
+		return;
+	}
+
+	int b0 = b - (b % 3);
+	int bl = b0 + ((b + 2) % 3);
+	int br = b0 + ((b + 1) % 3);
+	int p1 = Triangles[bl];
+	int hbl = Halfedges[bl];
+	int hbr = Halfedges[br];
+
+	QueueRemove(b / 3);
+
+	int t0 = AddTriangle(p0, pr, pn, har, -1, -1, a0);
+	int t1 = AddTriangle(pr, p1, pn, hbr, -1, t0 + 1, b0);
+	int t2 = AddTriangle(p1, pl, pn, hbl, -1, t1 + 1, -1);
+	int t3 = AddTriangle(pl, p0, pn, hal, t0 + 2, t2 + 1, -1);
+
+	Legalize(t0);
+	Legalize(t1);
+	Legalize(t2);
+	Legalize(t3);
+}
+
+void TINTriangulator::Legalize(int a)
+{
+	// a is the edge pr -> pl of triangle [p0, pr, pl], b is the same edge in the neighbour [pl, pr, p1]
+	// if p1 is inside the circumcircle of [p0, pr, pl] flip the shared edge to pl - p1,
+	// then check the two new outer edges the same way
+	int b = Halfedges[a];
+	if (b < 0)
+	{
+		return;
+	}
+
+	int a0 = a - (a % 3);
+	int b0 = b - (b % 3);
+	int al = a0 + ((a + 1) % 3);
+	int ar = a0 + ((a + 2) % 3);
+	int bl = b0 + ((b + 2) % 3);
+	int br = b0 + ((b + 1) % 3);
+	int p0 = Triangles[ar];
+	int pr = Triangles[a];
+	int pl = Triangles[al];
+	int p1 = Triangles[bl];
+
+	if (!InCircle(Points[p0], Points[pr], Points[pl], Points[p1]))
+	{
+		return;
+	}
+
+	int hal = Halfedges[al];
+	int har = Halfedges[ar];
+	int hbl = Halfedges[bl];
+	int hbr = Halfedges[br];
+
+	QueueRemove(a / 3);
+	QueueRemove(b / 3);
+
+	int t0 = AddTriangle(p0, p1, pl, -1, hbl, hal, a0);
+	int t1 = AddTriangle(p1, p0, pr, t0, har, hbr, b0);
+
+	Legalize(t0 + 1);
+	Legalize(t1 + 2);
+}
+
+void TINTriangulator::Flush()
+{
+	for (size_t i = 0; i < Pending.size(); i++)
+	{
+		int t = Pending[i];
+		ComputeCandidate(t);
+
+		// a triangle can be touched twice before a flush, fix its place in the heap instead of adding it again
+		if (QueueIndexes[t] < 0)
+		{
+			QueuePush(t);
+		}
+		else if (!QueueDown(QueueIndexes[t], (int)Queue.size()))
+		{
+			QueueUp(QueueIndexes[t]);
+		}
+	}
+	Pending.clear();
+}
+
+void TINTriangulator::ComputeCandidate(int t)
+{
+	glm::ivec2 a = Points[Triangles[(t * 3) + 0]];
+	glm::ivec2 b = Points[Triangles[(t * 3) + 1]];
+	glm::ivec2 c = Points[Triangles[(t * 3) + 2]];
+
+	int64_t Area = Orient(a, b, c);
+	float MaxError = 0.0f;
+	glm::ivec2 MaxPoint = a;
+
+	if (Area != 0)
+	{
+		// rasterize the bounding box and keep the samples inside the triangle
+		int64_t Sign = (Area > 0) ? 1 : -1;
+		float za = HeightAt(a) / (float)(Area * Sign);
+		float zb = HeightAt(b) / (float)(Area * Sign);
+		float zc = HeightAt(c) / (float)(Area * Sign);
+		glm::ivec2 BoxMin = glm::min(glm::min(a, b), c);
+		glm::ivec2 BoxMax = glm::max(glm::max(a, b), c);
+
+		for (int y = BoxMin.y; y <= BoxMax.y; y++)
+		{
+			for (int x = BoxMin.x; x <= BoxMax.x; x++)
+			{
+				glm::ivec2 p = glm::ivec2(x, y);
+				int64_t w0 = Orient(b, c, p) * Sign;
+				int64_t w1 = Orient(c, a, p) * Sign;
+				int64_t w2 = Orient(a, b, p) * Sign;
+				if (w0 < 0 || w1 < 0 || w2 < 0)
+				{
+					continue;
+				}
+
+				// barycentric interpolation of the corner heights
+				float z = (za * w0) + (zb * w1) + (zc * w2);
+				float Error = fabs(z - HeightAt(p));
+				if (Error > MaxError)
+				{
+					MaxError = Error;
+					MaxPoint = p;
+				}
+			}
+		}
+	}
+
+	if (MaxPoint == a || MaxPoint == b || MaxPoint == c)
+	{
+		MaxError = 0.0f;
+	}
+
+	Candidates[t] = MaxPoint;
+	Errors[t] = MaxError;
+}
+
+int TINTriangulator::FindTriangle(glm::ivec2 Point) const
+{
+	for (int t = 0; t < (int)Triangles.size() / 3; t++)
+	{
+		glm::ivec2 a = Points[Triangles[(t * 3) + 0]];
+		glm::ivec2 b = Points[Triangles[(t * 3) + 1]];
+		glm::ivec2 c = Points[Triangles[(t * 3) + 2]];
+		int64_t Sign = (Orient(a, b, c) > 0) ? 1 : -1;
+		if (Orient(b, c, Point) * Sign >= 0 && Orient(c, a, Point) * Sign >= 0 && Orient(a, b, Point) * Sign >= 0)
+		{
+			return t;
+		}
+	}
+	return 0;
+}
+
+void TINTriangulator::QueuePush(int t)
+{
+	int i = (int)Queue.size();
+	QueueIndexes[t] = i;
+	Queue.push_back(t);
+	QueueUp(i);
+}
+
+int TINTriangulator::QueuePop()
+{
+	int n = (int)Queue.size() - 1;
+	QueueSwap(0, n);
+	QueueDown(0, n);
+
+	int t = Queue.back();
+	Queue.pop_back();
+	QueueIndexes[t] = -1;
+	return t;
+}
+
+void TINTriangulator::QueueRemove(int t)
+{
+	int i = QueueIndexes[t];
+	if (i < 0)
+	{
+		// not queued yet, drop it from the pending list instead
+		std::vector<int>::iterator Found = std::find(Pending.begin(), Pending.end(), t);
+		if (Found != Pending.end())
+		{
+			*Found = Pending.back();
+			Pending.pop_back();
+		}
+		return;
+	}
+
+	int n = (int)Queue.size() - 1;
+	if (n != i)
+	{
+		QueueSwap(i, n);
+		if (!QueueDown(i, n))
+		{
+			QueueUp(i);
+		}
+	}
+	Queue.pop_back();
+	QueueIndexes[t] = -1;
+}
+
+bool TINTriangulator::QueueLess(int i, int j) const
+{
+	// largest error on top
+	return Errors[Queue[i]] > Errors[Queue[j]];
+}
+
+void TINTriangulator::QueueSwap(int i, int j)
+{
+	int pi = Queue[i];
+	int pj = Queue[j];
+	Queue[i] = pj;
+	Queue[j] = pi;
+	QueueIndexes[pi] = j;
+	QueueIndexes[pj] = i;
+}
+
+void TINTriangulator::QueueUp(int j)
+{
+	while (j > 0)
+	{
+		int i = (j - 1) / 2;
+		if (!QueueLess(j, i))
+		{
+			break;
+		}
+		QueueSwap(i, j);
+		j = i;
+	}
+}
+
+bool TINTriangulator::QueueDown(int i0, int n)
+{
+	int i = i0;
+	while (true)
+	{
+		int j1 = (2 * i) + 1;
+		if (j1 >= n)
+		{
+			break;
+		}
+		int j = j1;
+		int j2 = j1 + 1;
+		if (j2 < n && !QueueLess(j1, j2))
+		{
+			j = j2;
+		}
+		if (!QueueLess(j, i))
+		{
+			break;
+		}
+		QueueSwap(i, j);
+		i = j;
+	}
+	return i > i0;
+}
+
+TerrainTIN::TerrainTIN(const std::vector<float>& Heights, int GridSize)
+	: Heights(Heights)
+{
+	this->GridSize = GridSize;
+}
+
+TerrainTIN::~TerrainTIN()
+{
+}
+
+void TerrainTIN::Build(float MaxError, int TileSize, std::vector<GLuint>& GridCoords, std::vector<GLuint>& Triangles)
+{
+	PROFILE_FUNCTION();
+
+	// tiles share their border rows and columns
+	int Last = GridSize - 1;
+	int TilesPerSide = (Last + TileSize - 1) / TileSize;
+	int TileCount = TilesPerSide * TilesPerSide;
+
+	std::vector<std::vector<glm::ivec2>> TilePoints(TileCount);
+	std::vector<std::vector<int>> TileTriangles(TileCount);
+	std::atomic<int> NextTile(0);
+
+	unsigned int ThreadCount = std::thread::hardware_concurrency();
+	if (ThreadCount == 0)
+	{
+		ThreadCount = 4;
+	}
+	ThreadCount = std::min(ThreadCount, (unsigned int)TileCount);
+
+	std::vector<std::thread> Workers;
+	for (unsigned int w = 0; w < ThreadCount; w++)
+	{
+		Workers.push_back(std::thread([&, MaxError, TileSize]()
+			{
+				PROFILE_THREAD_NAME("Terrain worker");
+				for (int Tile = NextTile++; Tile < TileCount; Tile = NextTile++)
+				{
+					PROFILE_SCOPE("TIN tile");
+					glm::ivec2 Min = glm::ivec2(Tile % TilesPerSide, Tile / TilesPerSide) * TileSize;
+					glm::ivec2 Max = glm::min(Min + glm::ivec2(TileSize), glm::ivec2(Last));
+
+					// the borders only depend on their own samples, so both tiles on an edge pick the same points
+					std::vector<glm::ivec2> Border;
+					SimplifyBorder(Min, glm::ivec2(1, 0), Max.x - Min.x, MaxError, Border);
+					SimplifyBorder(glm::ivec2(Min.x, Max.y), glm::ivec2(1, 0), Max.x - Min.x, MaxError, Border);
+					SimplifyBorder(Min, glm::ivec2(0, 1), Max.y - Min.y, MaxError, Border);
+					SimplifyBorder(glm::ivec2(Max.x, Min.y), glm::ivec2(0, 1), Max.y - Min.y, MaxError, Border);
+
+					TINTriangulator Triangulator(Heights.data(), GridSize, Min, Max);
+					Triangulator.Run(MaxError, Border);
+					TilePoints[Tile] = Triangulator.GetPoints();
+					Triangulator.GetTriangles(TileTriangles[Tile]);
+				}
+			}));
+	}
+	for (size_t w = 0; w < Workers.size(); w++)
+	{
+		Workers[w].join();
+	}
+
+	// merge the tiles in order, samples on shared borders become one vertex
+	std::vector<int> Remap(GridSize * GridSize, -1);
+	GridCoords.clear();
+	Triangles.clear();
+	for (int Tile = 0; Tile < TileCount; Tile++)
+	{
+		const std::vector<glm::ivec2>& Points = TilePoints[Tile];
+		const std::vector<int>& Tris = TileTriangles[Tile];
+
+		for (size_t t = 0; t < Tris.size(); t += 3)
+		{
+			glm::ivec2 a = Points[Tris[t + 0]];
+			glm::ivec2 b = Points[Tris[t + 1]];
+			glm::ivec2 c = Points[Tris[t + 2]];
+			int64_t Area = Orient(a, b, c);
+			if (Area == 0)
+			{
+				continue;
+			}
+			if (Area < 0)
+			{
+				std::swap(b, c);	// same winding as the regular grid
+			}
+
+			glm::ivec2 Corners[3] = { a, b, c };
+			for (int k = 0; k < 3; k++)
+			{
+				int& Index = Remap[(Corners[k].y * GridSize) + Corners[k].x];
+				if (Index < 0)
+				{
+					Index = (int)(GridCoords.size() / 2);
+					GridCoords.push_back(Corners[k].x);
+					GridCoords.push_back(Corners[k].y);
+				}
+				Triangles.push_back(Index);
+			}
+		}
+	}
+}
+
+void TerrainTIN::SimplifyBorder(glm::ivec2 Start, glm::ivec2 Step, int Length, float MaxError, std::vector<glm::ivec2>& Output) const
+{
+	// top down split at the worst sample until the line is within the error, end points are corners and not output
+	std::vector<char> Keep(Length + 1, 0);
+	Keep[0] = 1;
+	Keep[Length] = 1;
+
+	std::vector<glm::ivec2> Spans;
+	Spans.push_back(glm::ivec2(0, Length));
+	while (!Spans.empty())
+	{
+		glm::ivec2 Span = Spans.back();
+		Spans.pop_back();
+
+		glm::ivec2 First = Start + (Step * Span.x);
+		glm::ivec2 Second = Start + (Step * Span.y);
+		float h0 = Heights[(First.y * GridSize) + First.x];
+		float h1 = Heights[(Second.y * GridSize) + Second.x];
+
+		float WorstError = 0.0f;
+		int Worst = -1;
+		for (int i = Span.x + 1; i < Span.y; i++)
+		{
+			glm::ivec2 Sample = Start + (Step * i);
+			float t = (float)(i - Span.x) / (float)(Span.y - Span.x);
+			float Error = fabs(Heights[(Sample.y * GridSize) + Sample.x] - (h0 + ((h1 - h0) * t)));
+			if (Error > WorstError)
+			{
+				WorstError = Error;
+				Worst = i;
+			}
+		}
+
+		if (Worst >= 0 && WorstError > MaxError)
+		{
+			Keep[Worst] = 1;
+			Spans.push_back(glm::ivec2(Span.x, Worst));
+			Spans.push_back(glm::ivec2(Worst, Span.y));
+		}
+	}
+
+	for (int i = 1; i < Length; i++)
+	{
+		if (Keep[i])
+		{
+			Output.push_back(Start + (Step * i));
+		}
+	}
+}
@@ -0,0 +1,82 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : TerrainTIN.h
+// Description    : class file for the greedy insertion delaunay TIN used for static terrain export
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glm.hpp>
+#include <vector>
+
+// incremental delaunay triangulation of one rectangular tile of the height grid
+// the point with the largest vertical error is inserted until every triangle is within the max error
+class TINTriangulator
+{
+public:
+	TINTriangulator(const float* Heights, int GridWidth, glm::ivec2 Min, glm::ivec2 Max);
+	~TINTriangulator();
+
+	// border points are inserted first and never moved, so neighbouring tiles match exactly
+	void Run(float MaxError, const std::vector<glm::ivec2>& BorderPoints);
+	const std::vector<glm::ivec2>& GetPoints() const;
+	void GetTriangles(std::vector<int>& Output) const;
+
+private:
+	float HeightAt(glm::ivec2 Point) const;
+	int AddPoint(glm::ivec2 Point);
+	int AddTriangle(int a, int b, int c, int ab, int bc, int ca, int e);
+	void InsertPoint(int t, glm::ivec2 Point);
+	void HandleCollinear(int pn, int a);
+	void Legalize(int a);
+	void Flush();
+	void ComputeCandidate(int t);
+	int FindTriangle(glm::ivec2 Point) const;
+
+	// binary max heap of triangles ordered by candidate error
+	void QueuePush(int t);
+	int QueuePop();
+	void QueueRemove(int t);
+	bool QueueLess(int i, int j) const;
+	void QueueSwap(int i, int j);
+	void QueueUp(int i);
+	bool QueueDown(int i, int n);
+
+	const float* Heights;
+	int GridWidth;
+	glm::ivec2 Min;
+	glm::ivec2 Max;
+
+	std::vector<glm::ivec2> Points;
+	std::vector<int> Triangles;		// three point indices per triangle
+	std::vector<int> Halfedges;		// opposite half edge, -1 on the tile border
+	std::vector<glm::ivec2> Candidates;	// cached worst point per triangle
+	std::vector<float> Errors;
+	std::vector<int> QueueIndexes;
+	std::vector<int> Queue;
+	std::vector<int> Pending;		// triangles whose candidate has to be recomputed
+};
+
+class TerrainTIN
+{
+public:
+	TerrainTIN(const std::vector<float>& Heights, int GridSize);
+	~TerrainTIN();
+
+	// triangulates the tiles on worker threads and merges them
+	// outputs grid coordinates (x, y pairs) of the used samples and the triangle indices into them
+	void Build(float MaxError, int TileSize, std::vector<GLuint>& GridCoords, std::vector<GLuint>& Triangles);
+
+private:
+	void SimplifyBorder(glm::ivec2 Start, glm::ivec2 Step, int Length, float MaxError, std::vector<glm::ivec2>& Output) const;
+
+	const std::vector<float>& Heights;
+	int GridSize;
+};
@@ -0,0 +1,107 @@
+# Bachelor of Software Engineering
+# Media Design School
+# Auckland
+# New Zealand
+#
+# (c) 2022 Media Design School
+#
+# File Name      : GenerateCameraPaths.py
+# Description    : writes the canonical flythroughs in Resources/CameraPaths, in the format CameraPath::Load reads
+# Author         : Lera Blokhina
+# Mail           : valeriia.blokhina@mds.ac.nz
+#
+# run from the project folder: python Tools/GenerateCameraPaths.py
+# positions are in world units, the keys are half a second apart and CameraPath interpolates between them
+
+import math
+import os
+import struct
+
+VERSION = 1
+KEY_SPACING = 0.5
+
+# same bits as CameraPath.h
+PATH_FLAG_WIREFRAME = 0x01
+PATH_FLAG_STENCIL = 0x02
+PATH_FLAG_SCISSOR = 0x04
+PATH_FLAG_FACECULL = 0x08
+PATH_FLAG_DEFERRED = 0x10
+
+SPHERES_CENTRE = (0.5, 0.5, -2.0)	# middle of the lit spheres
+
+
+def Normalize(v):
+	length = math.sqrt(sum(c * c for c in v))
+	return [c / length for c in v]
+
+
+def Write(name, keys):
+	# "CPTH", version and key count, then per key: time, position, look direction as snorm16, flags and segment
+	path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Resources", "CameraPaths", name)
+	with open(path, "wb") as output:
+		output.write(b"CPTH")
+		output.write(struct.pack("<II", VERSION, len(keys)))
+		for time, position, look, flags, segment in keys:
+			look = [int(round(max(-1.0, min(1.0, c)) * 32767)) for c in Normalize(look)]
+			output.write(struct.pack("<f3f3hBB", time, *(position + look + [flags, segment])))
+	print("wrote %s (%d keys, %.1f s)" % (os.path.normpath(path), len(keys), keys[-1][0]))
+
+
+def Overview():
+	# high orbit around the terrain, then a spiral down towards the middle
+	keys = []
+	time = 0.0
+	for i in range(21):
+		angle = i / 20 * math.pi * 2
+		position = [math.cos(angle) * 70, 45, math.sin(angle) * 70]
+		keys.append((time, position, [-position[0], -40, -position[2]], 0, 0))
+		time += KEY_SPACING
+	for i in range(1, 21):
+		angle = i / 20 * math.pi * 2
+		radius = 70 - i * 2.5
+		height = 45 - i * 1.9
+		position = [math.cos(angle) * radius, height, math.sin(angle) * radius]
+		keys.append((time, position, [-position[0], -height + 2, -position[2]], 0, 1))
+		time += KEY_SPACING
+	return keys
+
+
+def Valley():
+	# two low passes, along the diagonal and back along the bend (GenerateHeightmap keeps both flat)
+	keys = []
+	time = 0.0
+	for i in range(21):
+		s = i / 20
+		position = [-60 + 120 * s, 6 + 2 * math.sin(s * math.pi * 3), -60 + 120 * s]
+		keys.append((time, position, [1, -0.15, 1], 0, 0))
+		time += KEY_SPACING
+	for i in range(1, 21):
+		s = i / 20
+		position = [60 - 120 * s, 6 + 2 * math.sin(s * math.pi * 3), 60 - 20 * math.sin(s * math.pi)]
+		keys.append((time, position, [-1, -0.15, -0.6 * math.cos(s * math.pi)], 0, 1))
+		time += KEY_SPACING
+	return keys
+
+
+def Spheres():
+	# close orbit of the lit spheres, forward, then with outlines, then deferred
+	keys = []
+	time = 0.0
+	centre = SPHERES_CENTRE
+	for segment, flags in ((0, 0), (1, PATH_FLAG_STENCIL), (2, PATH_FLAG_DEFERRED | PATH_FLAG_STENCIL)):
+		for i in range(13):
+			angle = (segment * 12 + i) / 36 * math.pi * 2
+			position = [centre[0] + math.cos(angle) * 8, 2.5, centre[2] + math.sin(angle) * 8]
+			keys.append((time, position, [centre[c] - position[c] for c in range(3)], flags, segment))
+			time += KEY_SPACING
+	return keys
+
+
+def main():
+	Write("Overview.campath", Overview())
+	Write("Valley.campath", Valley())
+	Write("Spheres.campath", Spheres())
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,108 @@
+# Bachelor of Software Engineering
+# Media Design School
+# Auckland
+# New Zealand
+#
+# (c) 2022 Media Design School
+#
+# File Name      : GenerateHeightmap.py
+# Description    : writes Resources/Heightmaps/Terrain.raw, the 8 bit heightmap Terrain loads
+# Author         : Lera Blokhina
+# Mail           : valeriia.blokhina@mds.ac.nz
+#
+# run from the project folder: python Tools/GenerateHeightmap.py
+# the output is the same every run (fixed seed), so the terrain mesh cache stays warm
+
+import math
+import os
+
+SIZE = 128			# samples per side, Terrain's GridSize
+SPACING = 2.0		# model units between samples, Terrain's Spacing
+SEED = 1337
+OCTAVES = 5
+
+# flat ground the camera paths and the scene need, in model units (the terrain is drawn at half scale)
+BASIN_RADIUS = 40.0					# lit spheres and the reflection sphere around the origin
+VALLEY_HALF_WIDTH = 16.0			# Valley.campath flies low along these two lines
+RAMP = 36.0							# distance over which the hills rise to full height
+
+
+def Hash(x, y):
+	# integer lattice hash to [0, 1]
+	n = (x * 374761393 + y * 668265263 + SEED * 2147483647) & 0xffffffff
+	n = ((n ^ (n >> 13)) * 1274126177) & 0xffffffff
+	return ((n ^ (n >> 16)) & 0xffff) / 65535.0
+
+
+def Smooth(t):
+	return t * t * (3.0 - 2.0 * t)
+
+
+def ValueNoise(x, y):
+	x0 = int(math.floor(x))
+	y0 = int(math.floor(y))
+	tx = Smooth(x - x0)
+	ty = Smooth(y - y0)
+	top = Hash(x0, y0) + (Hash(x0 + 1, y0) - Hash(x0, y0)) * tx
+	bottom = Hash(x0, y0 + 1) + (Hash(x0 + 1, y0 + 1) - Hash(x0, y0 + 1)) * tx
+	return top + (bottom - top) * ty
+
+
+def Fbm(x, y):
+	total = 0.0
+	amplitude = 1.0
+	frequency = 1.0 / 48.0
+	norm = 0.0
+	for _ in range(OCTAVES):
+		total += ValueNoise(x * frequency, y * frequency) * amplitude
+		norm += amplitude
+		amplitude *= 0.5
+		frequency *= 2.0
+	return total / norm
+
+
+def DistanceToSegment(px, pz, ax, az, bx, bz):
+	dx = bx - ax
+	dz = bz - az
+	t = max(0.0, min(1.0, ((px - ax) * dx + (pz - az) * dz) / (dx * dx + dz * dz)))
+	return math.hypot(px - (ax + dx * t), pz - (az + dz * t))
+
+
+def ValleyPoints():
+	# the second Valley.campath pass, world x = 60 - 120s, z = 60 - 20 sin(s pi), doubled to model units
+	points = []
+	for i in range(41):
+		s = i / 40.0
+		points.append((2.0 * (60.0 - 120.0 * s), 2.0 * (60.0 - 20.0 * math.sin(s * math.pi))))
+	return points
+
+
+def FlatDistance(x, z, curve):
+	# distance outside the flat areas, 0 inside them
+	basin = math.hypot(x, z) - BASIN_RADIUS
+	diagonal = DistanceToSegment(x, z, -120.0, -120.0, 120.0, 120.0) - VALLEY_HALF_WIDTH
+	bend = min(DistanceToSegment(x, z, curve[i][0], curve[i][1], curve[i + 1][0], curve[i + 1][1]) for i in range(len(curve) - 1)) - VALLEY_HALF_WIDTH
+	return max(0.0, min(basin, diagonal, bend))
+
+
+def main():
+	curve = ValleyPoints()
+	half = (SIZE - 1) * SPACING * 0.5
+	samples = bytearray(SIZE * SIZE)
+	for i in range(SIZE):
+		for j in range(SIZE):
+			# same layout as Terrain::BuildMesh, row i runs along z and column j along x
+			x = -half + SPACING * j
+			z = -half + SPACING * i
+			hills = Smooth(min(FlatDistance(x, z, curve) / RAMP, 1.0))
+			height = Fbm(x + 1000.0, z + 1000.0) * (0.25 + 0.75 * hills) * hills
+			samples[(i * SIZE) + j] = max(0, min(255, int(round(height * 255.0))))
+
+	path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Resources", "Heightmaps", "Terrain.raw")
+	with open(path, "wb") as output:
+		output.write(samples)
+	print("wrote %s (%d x %d, heights %d - %d)" % (os.path.normpath(path), SIZE, SIZE, min(samples), max(samples)))
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,565 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : TransformSystem.cpp
+// Description    : builds model, normal and PVM matrices for every transform, scalar and avx2 kernels
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "TransformSystem.h"
+#include "NormalMatrix.h"
+#include "CPUProfiler.h"
+#include "WorkerPool.h"
+#include <gtc/matrix_transform.hpp>
+#include <gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+// the avx2 kernel is only built for x86, the cpu is asked at runtime whether it can run it
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TRANSFORM_SYSTEM_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TRANSFORM_AVX2
+#else
+#include <cpuid.h>
+#define TRANSFORM_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#else
+#define TRANSFORM_SYSTEM_X86 0
+#endif
+
+// below this many transforms per chunk waking the workers costs more than it saves
+#define TRANSFORM_SYSTEM_MIN_PER_THREAD 16384
+
+// component arrays and outputs for one kernel call
+struct TransformArrays
+{
+	const float* PositionX;
+	const float* PositionY;
+	const float* PositionZ;
+	const float* RotationX;
+	const float* RotationY;
+	const float* RotationZ;
+	const float* RotationW;
+	const float* ScaleX;
+	const float* ScaleY;
+	const float* ScaleZ;
+
+	glm::mat4* Models;
+	glm::mat4* Normals;
+	glm::mat4* PVMs;		// null when no view projection was given
+	const float* ViewProj;
+};
+
+// model = translate * rotate * scale from a unit quaternion, normal = rotate * inverse scale
+static void ComposeScalar(const TransformArrays& Arrays, size_t Begin, size_t End)
+{
+	for (size_t i = Begin; i < End; i++)
+	{
+		float X = Arrays.RotationX[i];
+		float Y = Arrays.RotationY[i];
+		float Z = Arrays.RotationZ[i];
+		float W = Arrays.RotationW[i];
+
+		// rotation columns
+		float Rotation[3][3] =
+		{
+			{ 1.0f - 2.0f * (Y * Y + Z * Z), 2.0f * (X * Y + W * Z), 2.0f * (X * Z - W * Y) },
+			{ 2.0f * (X * Y - W * Z), 1.0f - 2.0f * (X * X + Z * Z), 2.0f * (Y * Z + W * X) },
+			{ 2.0f * (X * Z + W * Y), 2.0f * (Y * Z - W * X), 1.0f - 2.0f * (X * X + Y * Y) },
+		};
+		float Scale[3] = { Arrays.ScaleX[i], Arrays.ScaleY[i], Arrays.ScaleZ[i] };
+
+		float* Model = glm::value_ptr(Arrays.Models[i]);
+		float* Normal = glm::value_ptr(Arrays.Normals[i]);
+		for (int c = 0; c < 3; c++)
+		{
+			// a zero scale gives a zero column, the same as the cofactors NormalMatrix falls back to
+			float InverseScale = (Scale[c] != 0.0f) ? 1.0f / Scale[c] : 0.0f;
+			for (int r = 0; r < 3; r++)
+			{
+				Model[(c * 4) + r] = Rotation[c][r] * Scale[c];
+				Normal[(c * 4) + r] = Rotation[c][r] * InverseScale;
+			}
+			Model[(c * 4) + 3] = 0.0f;
+			Normal[(c * 4) + 3] = 0.0f;
+		}
+		Model[12] = Arrays.PositionX[i];
+		Model[13] = Arrays.PositionY[i];
+		Model[14] = Arrays.PositionZ[i];
+		Model[15] = 1.0f;
+		Normal[12] = 0.0f;
+		Normal[13] = 0.0f;
+		Normal[14] = 0.0f;
+		Normal[15] = 1.0f;
+
+		if (Arrays.PVMs != nullptr)
+		{
+			float* PVM = glm::value_ptr(Arrays.PVMs[i]);
+			for (int c = 0; c < 4; c++)
+			{
+				for (int r = 0; r < 4; r++)
+				{
+					PVM[(c * 4) + r] = (Arrays.ViewProj[r] * Model[c * 4]) + (Arrays.ViewProj[4 + r] * Model[(c * 4) + 1])
+						+ (Arrays.ViewProj[8 + r] * Model[(c * 4) + 2]) + (Arrays.ViewProj[12 + r] * Model[(c * 4) + 3]);
+				}
+			}
+		}
+	}
+}
+
+#if TRANSFORM_SYSTEM_X86
+// Rows[e] holds element e of eight matrices, afterwards Rows[o] holds the eight elements of matrix o
+TRANSFORM_AVX2 static inline void Transpose8x8(__m256* Rows)
+{
+	__m256 T0 = _mm256_unpacklo_ps(Rows[0], Rows[1]);
+	__m256 T1 = _mm256_unpackhi_ps(Rows[0], Rows[1]);
+	__m256 T2 = _mm256_unpacklo_ps(Rows[2], Rows[3]);
+	__m256 T3 = _mm256_unpackhi_ps(Rows[2], Rows[3]);
+	__m256 T4 = _mm256_unpacklo_ps(Rows[4], Rows[5]);
+	__m256 T5 = _mm256_unpackhi_ps(Rows[4], Rows[5]);
+	__m256 T6 = _mm256_unpacklo_ps(Rows[6], Rows[7]);
+	__m256 T7 = _mm256_unpackhi_ps(Rows[6], Rows[7]);
+
+	__m256 S0 = _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 S1 = _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256 S2 = _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 S3 = _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256 S4 = _mm256_shuffle_ps(T4, T6, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 S5 = _mm256_shuffle_ps(T4, T6, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256 S6 = _mm256_shuffle_ps(T5, T7, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 S7 = _mm256_shuffle_ps(T5, T7, _MM_SHUFFLE(3, 2, 3, 2));
+
+	Rows[0] = _mm256_permute2f128_ps(S0, S4, 0x20);
+	Rows[1] = _mm256_permute2f128_ps(S1, S5, 0x20);
+	Rows[2] = _mm256_permute2f128_ps(S2, S6, 0x20);
+	Rows[3] = _mm256_permute2f128_ps(S3, S7, 0x20);
+	Rows[4] = _mm256_permute2f128_ps(S0, S4, 0x31);
+	Rows[5] = _mm256_permute2f128_ps(S1, S5, 0x31);
+	Rows[6] = _mm256_permute2f128_ps(S2, S6, 0x31);
+	Rows[7] = _mm256_permute2f128_ps(S3, S7, 0x31);
+}
+
+// 16 element registers (one lane per matrix) back to eight glm matrices
+TRANSFORM_AVX2 static inline void StoreMatrices(__m256* Elements, glm::mat4* Output)
+{
+	Transpose8x8(Elements);
+	Transpose8x8(Elements + 8);
+	for (int o = 0; o < 8; o++)
+	{
+		float* Matrix = glm::value_ptr(Output[o]);
+		_mm256_storeu_ps(Matrix, Elements[o]);
+		_mm256_storeu_ps(Matrix + 8, Elements[8 + o]);
+	}
+}
+
+// same maths as ComposeScalar on eight transforms at a time, the rest goes through the scalar kernel
+TRANSFORM_AVX2 static void ComposeAVX2(const TransformArrays& Arrays, size_t Begin, size_t End)
+{
+	const __m256 Zero = _mm256_setzero_ps();
+	const __m256 One = _mm256_set1_ps(1.0f);
+	const __m256 Two = _mm256_set1_ps(2.0f);
+
+	__m256 ViewProj[16];
+	for (int k = 0; k < 16; k++)
+	{
+		ViewProj[k] = (Arrays.PVMs != nullptr) ? _mm256_set1_ps(Arrays.ViewProj[k]) : Zero;
+	}
+
+	size_t i = Begin;
+	for (; i + 8 <= End; i += 8)
+	{
+		__m256 X = _mm256_loadu_ps(Arrays.RotationX + i);
+		__m256 Y = _mm256_loadu_ps(Arrays.RotationY + i);
+		__m256 Z = _mm256_loadu_ps(Arrays.RotationZ + i);
+		__m256 W = _mm256_loadu_ps(Arrays.RotationW + i);
+		__m256 ScaleX = _mm256_loadu_ps(Arrays.ScaleX + i);
+		__m256 ScaleY = _mm256_loadu_ps(Arrays.ScaleY + i);
+		__m256 ScaleZ = _mm256_loadu_ps(Arrays.ScaleZ + i);
+		__m256 PositionX = _mm256_loadu_ps(Arrays.PositionX + i);
+		__m256 PositionY = _mm256_loadu_ps(Arrays.PositionY + i);
+		__m256 PositionZ = _mm256_loadu_ps(Arrays.PositionZ + i);
+
+		__m256 XX = _mm256_mul_ps(X, X);
+		__m256 YY = _mm256_mul_ps(Y, Y);
+		__m256 ZZ = _mm256_mul_ps(Z, Z);
+		__m256 XY = _mm256_mul_ps(X, Y);
+		__m256 XZ = _mm256_mul_ps(X, Z);
+		__m256 YZ = _mm256_mul_ps(Y, Z);
+		__m256 WX = _mm256_mul_ps(W, X);
+		__m256 WY = _mm256_mul_ps(W, Y);
+		__m256 WZ = _mm256_mul_ps(W, Z);
+
+		// rotation columns
+		__m256 R00 = _mm256_fnmadd_ps(Two, _mm256_add_ps(YY, ZZ), One);
+		__m256 R01 = _mm256_mul_ps(Two, _mm256_add_ps(XY, WZ));
+		__m256 R02 = _mm256_mul_ps(Two, _mm256_sub_ps(XZ, WY));
+		__m256 R10 = _mm256_mul_ps(Two, _mm256_sub_ps(XY, WZ));
+		__m256 R11 = _mm256_fnmadd_ps(Two, _mm256_add_ps(XX, ZZ), One);
+		__m256 R12 = _mm256_mul_ps(Two, _mm256_add_ps(YZ, WX));
+		__m256 R20 = _mm256_mul_ps(Two, _mm256_add_ps(XZ, WY));
+		__m256 R21 = _mm256_mul_ps(Two, _mm256_sub_ps(YZ, WX));
+		__m256 R22 = _mm256_fnmadd_ps(Two, _mm256_add_ps(XX, YY), One);
+
+		// a zero scale gives a zero column instead of infinities
+		__m256 InverseX = _mm256_and_ps(_mm256_div_ps(One, ScaleX), _mm256_cmp_ps(ScaleX, Zero, _CMP_NEQ_OQ));
+		__m256 InverseY = _mm256_and_ps(_mm256_div_ps(One, ScaleY), _mm256_cmp_ps(ScaleY, Zero, _CMP_NEQ_OQ));
+		__m256 InverseZ = _mm256_and_ps(_mm256_div_ps(One, ScaleZ), _mm256_cmp_ps(ScaleZ, Zero, _CMP_NEQ_OQ));
+
+		__m256 Model[16] =
+		{
+			_mm256_mul_ps(R00, ScaleX), _mm256_mul_ps(R01, ScaleX), _mm256_mul_ps(R02, ScaleX), Zero,
+			_mm256_mul_ps(R10, ScaleY), _mm256_mul_ps(R11, ScaleY), _mm256_mul_ps(R12, ScaleY), Zero,
+			_mm256_mul_ps(R20, ScaleZ), _mm256_mul_ps(R21, ScaleZ), _mm256_mul_ps(R22, ScaleZ), Zero,
+			PositionX, PositionY, PositionZ, One,
+		};
+		__m256 Normal[16] =
+		{
+			_mm256_mul_ps(R00, InverseX), _mm256_mul_ps(R01, InverseX), _mm256_mul_ps(R02, InverseX), Zero,
+			_mm256_mul_ps(R10, InverseY), _mm256_mul_ps(R11, InverseY), _mm256_mul_ps(R12, InverseY), Zero,
+			_mm256_mul_ps(R20, InverseZ), _mm256_mul_ps(R21, InverseZ), _mm256_mul_ps(R22, InverseZ), Zero,
+			Zero, Zero, Zero, One,
+		};
+
+		// the w row of the model matrix is 0 0 0 1, so each PVM column needs three (or four) terms
+		if (Arrays.PVMs != nullptr)
+		{
+			__m256 PVM[16];
+			for (int c = 0; c < 3; c++)
+			{
+				for (int r = 0; r < 4; r++)
+				{
+					__m256 Sum = _mm256_mul_ps(ViewProj[r], Model[c * 4]);
+					Sum = _mm256_fmadd_ps(ViewProj[4 + r], Model[(c * 4) + 1], Sum);
+					PVM[(c * 4) + r] = _mm256_fmadd_ps(ViewProj[8 + r], Model[(c * 4) + 2], Sum);
+				}
+			}
+			for (int r = 0; r < 4; r++)
+			{
+				__m256 Sum = _mm256_fmadd_ps(ViewProj[r], PositionX, ViewProj[12 + r]);
+				Sum = _mm256_fmadd_ps(ViewProj[4 + r], PositionY, Sum);
+				PVM[12 + r] = _mm256_fmadd_ps(ViewProj[8 + r], PositionZ, Sum);
+			}
+			StoreMatrices(PVM, Arrays.PVMs + i);
+		}
+		StoreMatrices(Model, Arrays.Models + i);
+		StoreMatrices(Normal, Arrays.Normals + i);
+	}
+
+	ComposeScalar(Arrays, i, End);
+}
+
+static void CPUID(int Leaf, int SubLeaf, unsigned int Registers[4])
+{
+#ifdef _MSC_VER
+	int Values[4];
+	__cpuidex(Values, Leaf, SubLeaf);
+	for (int i = 0; i < 4; i++)
+	{
+		Registers[i] = (unsigned int)Values[i];
+	}
+#else
+	__cpuid_count(Leaf, SubLeaf, Registers[0], Registers[1], Registers[2], Registers[3]);
+#endif
+}
+#endif
+
+TransformSystem::TransformSystem()
+{
+	UseAVX2 = HasAVX2();
+	ThreadCount = WorkerPool::GetThreadCount();
+}
+
+TransformSystem::~TransformSystem()
+{
+}
+
+bool TransformSystem::HasAVX2()
+{
+#if TRANSFORM_SYSTEM_X86
+	static int Supported = -1;
+	if (Supported < 0)
+	{
+		unsigned int Registers[4];
+		CPUID(0, 0, Registers);
+		unsigned int MaxLeaf = Registers[0];
+
+		// fma, osxsave and avx (leaf 1, ecx), then the os has to save the ymm registers (xcr0)
+		CPUID(1, 0, Registers);
+		bool Available = ((Registers[2] & (1u << 12)) != 0) && ((Registers[2] & (1u << 27)) != 0) && ((Registers[2] & (1u << 28)) != 0);
+		if (Available)
+		{
+#ifdef _MSC_VER
+			unsigned long long Enabled = _xgetbv(0);
+#else
+			unsigned int Low, High;
+			__asm__ volatile ("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+			unsigned long long Enabled = ((unsigned long long)High << 32) | Low;
+#endif
+			Available = ((Enabled & 0x6) == 0x6);
+		}
+
+		// avx2 (leaf 7, ebx)
+		if (Available && MaxLeaf >= 7)
+		{
+			CPUID(7, 0, Registers);
+			Available = ((Registers[1] & (1u << 5)) != 0);
+		}
+		else
+		{
+			Available = false;
+		}
+		Supported = Available ? 1 : 0;
+	}
+	return (Supported == 1);
+#else
+	return false;
+#endif
+}
+
+TransformHandle TransformSystem::Add(const glm::vec3& Position, const glm::quat& Rotation, const glm::vec3& Scale)
+{
+	TransformHandle Transform;
+	if (FreeList.empty() == false)
+	{
+		Transform = FreeList.back();
+		FreeList.pop_back();
+	}
+	else
+	{
+		Transform = (TransformHandle)Models.size();
+		PositionX.push_back(0.0f); PositionY.push_back(0.0f); PositionZ.push_back(0.0f);
+		RotationX.push_back(0.0f); RotationY.push_back(0.0f); RotationZ.push_back(0.0f); RotationW.push_back(1.0f);
+		ScaleX.push_back(1.0f); ScaleY.push_back(1.0f); ScaleZ.push_back(1.0f);
+		Models.push_back(glm::mat4());
+		Normals.push_back(glm::mat4());
+		PVMs.push_back(glm::mat4());
+	}
+
+	SetPosition(Transform, Position);
+	SetRotation(Transform, Rotation);
+	SetScale(Transform, Scale);
+
+	// usable before the next Update
+	Compose(Transform, Transform + 1, nullptr);
+	return Transform;
+}
+
+void TransformSystem::Remove(TransformHandle Transform)
+{
+	// the slot is reused by the next Add, until then it is composed like any other
+	FreeList.push_back(Transform);
+}
+
+void TransformSystem::SetPosition(TransformHandle Transform, const glm::vec3& Position)
+{
+	PositionX[Transform] = Position.x;
+	PositionY[Transform] = Position.y;
+	PositionZ[Transform] = Position.z;
+}
+
+void TransformSystem::SetRotation(TransformHandle Transform, const glm::quat& Rotation)
+{
+	RotationX[Transform] = Rotation.x;
+	RotationY[Transform] = Rotation.y;
+	RotationZ[Transform] = Rotation.z;
+	RotationW[Transform] = Rotation.w;
+}
+
+void TransformSystem::SetScale(TransformHandle Transform, const glm::vec3& Scale)
+{
+	ScaleX[Transform] = Scale.x;
+	ScaleY[Transform] = Scale.y;
+	ScaleZ[Transform] = Scale.z;
+}
+
+void TransformSystem::Update()
+{
+	PROFILE_FUNCTION();
+	ComposeAll(nullptr);
+}
+
+void TransformSystem::Update(const glm::mat4& ViewProj)
+{
+	PROFILE_FUNCTION();
+	ComposeAll(&ViewProj);
+}
+
+void TransformSystem::ComposeAll(const glm::mat4* ViewProj)
+{
+	ComposeAll(ViewProj, std::min(ThreadCount, (unsigned int)(Models.size() / TRANSFORM_SYSTEM_MIN_PER_THREAD)));
+}
+
+void TransformSystem::ComposeAll(const glm::mat4* ViewProj, unsigned int Chunks)
+{
+	size_t Count = Models.size();
+	if (Chunks <= 1)
+	{
+		Compose(0, Count, ViewProj);
+		return;
+	}
+
+	// chunk size rounded up to a multiple of eight so only the last chunk has a scalar tail, the last chunk always ends at Count
+	size_t Chunk = ((Count + Chunks - 1) / Chunks + 7) & ~(size_t)7;
+	auto ComposeChunk = [this, Count, Chunks, Chunk, ViewProj](int Index)
+	{
+		size_t Begin = Index * Chunk;
+		size_t End = (Index == (int)Chunks - 1) ? Count : std::min(Begin + Chunk, Count);
+		if (Begin < End)
+		{
+			Compose(Begin, End, ViewProj);
+		}
+	};
+	WorkerPool::ParallelFor((int)Chunks, ComposeChunk);
+}
+
+void TransformSystem::Compose(size_t Begin, size_t End, const glm::mat4* ViewProj)
+{
+	TransformArrays Arrays;
+	Arrays.PositionX = PositionX.data();
+	Arrays.PositionY = PositionY.data();
+	Arrays.PositionZ = PositionZ.data();
+	Arrays.RotationX = RotationX.data();
+	Arrays.RotationY = RotationY.data();
+	Arrays.RotationZ = RotationZ.data();
+	Arrays.RotationW = RotationW.data();
+	Arrays.ScaleX = ScaleX.data();
+	Arrays.ScaleY = ScaleY.data();
+	Arrays.ScaleZ = ScaleZ.data();
+	Arrays.Models = Models.data();
+	Arrays.Normals = Normals.data();
+	Arrays.PVMs = (ViewProj != nullptr) ? PVMs.data() : nullptr;
+	Arrays.ViewProj = (ViewProj != nullptr) ? glm::value_ptr(*ViewProj) : nullptr;
+
+#if TRANSFORM_SYSTEM_X86
+	if (UseAVX2 == true)
+	{
+		ComposeAVX2(Arrays, Begin, End);
+		return;
+	}
+#endif
+	ComposeScalar(Arrays, Begin, End);
+}
+
+const glm::mat4& TransformSystem::GetModel(TransformHandle Transform) const
+{
+	return Models[Transform];
+}
+
+const glm::mat4& TransformSystem::GetNormal(TransformHandle Transform) const
+{
+	return Normals[Transform];
+}
+
+const glm::mat4& TransformSystem::GetPVM(TransformHandle Transform) const
+{
+	return PVMs[Transform];
+}
+
+void TransformSystem::SetThreadCount(unsigned int ThreadCount)
+{
+	this->ThreadCount = std::max(ThreadCount, 1u);
+}
+
+size_t TransformSystem::GetCount() const
+{
+	return Models.size();
+}
+
+void TransformSystem::Benchmark(int Count)
+{
+	// the old path: one heap object per sphere, translate, rotate and scale built and multiplied one object at a time
+	struct LegacyObject
+	{
+		glm::vec3 Position;
+		float Angle;
+		glm::vec3 Scale;
+		glm::mat4 Model;
+		glm::mat4 Normal;
+		glm::mat4 PVM;
+	};
+
+	std::mt19937 Random(42);
+	std::uniform_real_distribution<float> Spread(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> Angles(0.0f, 360.0f);
+	std::uniform_real_distribution<float> Scales(0.25f, 2.0f);
+
+	std::vector<LegacyObject*> Objects(Count);
+	TransformSystem System;
+	for (int i = 0; i < Count; i++)
+	{
+		Objects[i] = new LegacyObject();
+		Objects[i]->Position = glm::vec3(Spread(Random), Spread(Random), Spread(Random));
+		Objects[i]->Angle = Angles(Random);
+		Objects[i]->Scale = glm::vec3(Scales(Random), Scales(Random), Scales(Random));
+		System.Add(Objects[i]->Position, glm::angleAxis(glm::radians(Objects[i]->Angle), glm::vec3(0.0f, 1.0f, 0.0f)), Objects[i]->Scale);
+	}
+	glm::mat4 ViewProj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 500.0f) * glm::lookAt(glm::vec3(0.0f, 20.0f, 60.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	// about half a million transforms per measurement whatever the count
+	const int Runs = std::max(500000 / Count, 3);
+
+	std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+	for (int Run = 0; Run < Runs; Run++)
+	{
+		for (int i = 0; i < Count; i++)
+		{
+			LegacyObject* Object = Objects[i];
+			glm::mat4 TranslationMat = glm::translate(glm::mat4(), Object->Position);
+			glm::mat4 RotationMat = glm::rotate(glm::mat4(), glm::radians(Object->Angle), glm::vec3(0.0f, 1.0f, 0.0f));
+			glm::mat4 ScaleMat = glm::scale(glm::mat4(), Object->Scale);
+			Object->Model = TranslationMat * RotationMat * ScaleMat;
+			Object->Normal = NormalMatrix::Compute(Object->Model);
+			Object->PVM = ViewProj * Object->Model;
+		}
+	}
+	double LegacyTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count() / Runs;
+
+	// the same work through the system, one kernel and thread setup at a time
+	const bool AVX2 = HasAVX2();
+	const unsigned int HardwareThreads = WorkerPool::GetThreadCount();
+	double Times[3] = { 0.0, 0.0, 0.0 };
+	for (int Mode = 0; Mode < 3; Mode++)
+	{
+		System.UseAVX2 = (Mode > 0) && AVX2;
+		System.SetThreadCount((Mode == 2) ? HardwareThreads : 1);
+
+		StartTime = std::chrono::high_resolution_clock::now();
+		for (int Run = 0; Run < Runs; Run++)
+		{
+			System.Update(ViewProj);
+		}
+		Times[Mode] = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count() / Runs;
+	}
+
+	// the chunks have to cover every transform when the count is not a multiple of the chunk count, so the outputs
+	// are cleared and rebuilt in seven chunks (forced past the minimum chunk size, the pool runs it even on one core)
+	std::fill(System.Normals.begin(), System.Normals.end(), glm::mat4(0.0f));
+	std::fill(System.PVMs.begin(), System.PVMs.end(), glm::mat4(0.0f));
+	System.ComposeAll(&ViewProj, 7);
+
+	// both paths have to agree before the times mean anything
+	float MaxDifference = 0.0f;
+	for (int i = 0; i < Count; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			glm::vec4 Difference = glm::abs(System.GetPVM(i)[c] - Objects[i]->PVM[c]) + glm::abs(System.GetNormal(i)[c] - Objects[i]->Normal[c]);
+			MaxDifference = std::max(MaxDifference, std::max(std::max(Difference.x, Difference.y), std::max(Difference.z, Difference.w)));
+		}
+		delete Objects[i];
+	}
+
+	std::cout << "Transforms (" << Count << " objects): per object " << LegacyTime << " ms | soa scalar " << Times[0] << " ms | "
+		<< (AVX2 ? "avx2 " : "scalar (no avx2) ") << Times[1] << " ms | " << HardwareThreads << " threads " << Times[2] << " ms"
+		<< " | max difference " << MaxDifference << std::endl;
+}
@@ -0,0 +1,76 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : TransformSystem.h
+// Description    : class file for the transform store, positions, rotations and scales in structure of arrays layout
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glm.hpp>
+#include <gtc/quaternion.hpp>
+#include <vector>
+
+// index of one transform, stays valid until it is removed
+typedef int TransformHandle;
+
+// every object writes its position, rotation and scale here, Update builds all the matrices in one pass
+// (avx2 on cpus that have it, eight transforms per step, the scalar kernel otherwise)
+class TransformSystem
+{
+public:
+	TransformSystem();
+	~TransformSystem();
+
+	TransformHandle Add(const glm::vec3& Position, const glm::quat& Rotation, const glm::vec3& Scale);
+	void Remove(TransformHandle Transform);
+
+	void SetPosition(TransformHandle Transform, const glm::vec3& Position);
+	void SetRotation(TransformHandle Transform, const glm::quat& Rotation);
+	void SetScale(TransformHandle Transform, const glm::vec3& Scale);
+
+	// model and normal matrices of every transform, plus ViewProj * Model with the second version
+	void Update();
+	void Update(const glm::mat4& ViewProj);
+
+	// the matrices from the last Update (Add builds the new transform's ones straight away)
+	const glm::mat4& GetModel(TransformHandle Transform) const;
+	const glm::mat4& GetNormal(TransformHandle Transform) const;
+	const glm::mat4& GetPVM(TransformHandle Transform) const;
+
+	// large updates are split into this many chunks on the shared worker pool, 1 keeps it on the calling thread
+	void SetThreadCount(unsigned int ThreadCount);
+	size_t GetCount() const;
+
+	// true when the cpu and the os support avx2 and fma, checked once
+	static bool HasAVX2();
+
+	// times the per object glm path (Sphere::Update before this class) against the scalar, avx2 and threaded kernels
+	static void Benchmark(int Count);
+
+private:
+	TransformSystem(const TransformSystem&);
+	TransformSystem& operator=(const TransformSystem&);
+
+	void ComposeAll(const glm::mat4* ViewProj);
+	void ComposeAll(const glm::mat4* ViewProj, unsigned int Chunks);	// Benchmark forces the chunk count with this one
+	void Compose(size_t Begin, size_t End, const glm::mat4* ViewProj);
+
+	// one array per component, the kernels load eight of each at a time
+	std::vector<float> PositionX, PositionY, PositionZ;
+	std::vector<float> RotationX, RotationY, RotationZ, RotationW;
+	std::vector<float> ScaleX, ScaleY, ScaleZ;
+
+	std::vector<glm::mat4> Models;
+	std::vector<glm::mat4> Normals;	// inverse transpose of the model matrix, same layout as NormalMatrix::Compute
+	std::vector<glm::mat4> PVMs;
+	std::vector<TransformHandle> FreeList;
+
+	unsigned int ThreadCount = 1;
+	bool UseAVX2 = false;
+};
@@ -0,0 +1,431 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Vegetation.cpp
+// Description    : poisson disk scattering on worker threads, per cell culling and instanced rendering of vegetation
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "Vegetation.h"
+#include "Frustum.h"
+#include "MeshCache.h"
+#include "CPUProfiler.h"
+#include "WorkerPool.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// splitmix64, used instead of the std engines so the placement is identical on every platform
+static uint64_t NextRandom(uint64_t& State)
+{
+	uint64_t Result = (State += 0x9E3779B97F4A7C15ull);
+	Result = (Result ^ (Result >> 30)) * 0xBF58476D1CE4E5B9ull;
+	Result = (Result ^ (Result >> 27)) * 0x94D049BB133111EBull;
+	return Result ^ (Result >> 31);
+}
+
+// random float in [0, 1)
+static float NextFloat(uint64_t& State)
+{
+	return (float)(NextRandom(State) >> 40) / (float)(1ull << 24);
+}
+
+Vegetation::Vegetation(Terrain* Ground, ShaderProgram* Program, RingBuffer* Ring)
+{
+	this->Ground = Ground;
+	this->Ring = Ring;
+	this->Program = Program;
+
+	ModelMatHandle = Program->GetUniform("Model");
+	NormalMatHandle = Program->GetUniform("NormalMatrix");
+	TextureHandle = Program->GetUniform("ImageTexture0");
+}
+
+Vegetation::~Vegetation()
+{
+}
+
+int Vegetation::AddSpecies(const VegetationSpecies& Desc)
+{
+	SpeciesData NewSpecies;
+	NewSpecies.Desc = Desc;
+
+	// the sphere mesh comes from the shared cache, only the instance buffer and its VAO belong to the species
+	const CachedMesh& Mesh = MeshCache::GetSphere(Desc.Radius, Desc.Fidelity);
+	NewSpecies.IndexCount = Mesh.IndexCount;
+	glGenBuffers(1, &NewSpecies.InstanceVBO);
+	NewSpecies.VAO = MeshCache::CreateInstancedVAO(Mesh, NewSpecies.InstanceVBO);
+
+	Species.push_back(NewSpecies);
+	return (int)Species.size() - 1;
+}
+
+void Vegetation::Scatter(uint32_t Seed)
+{
+	PROFILE_FUNCTION();
+	std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+
+	// split the terrain into square tiles
+	float HalfExtent = Ground->GetHalfExtent();
+	float TileSize = (2.0f * HalfExtent) / TilesPerSide;
+	Cells.assign(TilesPerSide * TilesPerSide, Cell());
+	for (int z = 0; z < TilesPerSide; z++)
+	{
+		for (int x = 0; x < TilesPerSide; x++)
+		{
+			Cell& Tile = Cells[(z * TilesPerSide) + x];
+			Tile.TileMin = glm::vec2(-HalfExtent + (x * TileSize), -HalfExtent + (z * TileSize));
+			Tile.TileMax = Tile.TileMin + glm::vec2(TileSize);
+			Tile.Instances.resize(Species.size());
+		}
+	}
+	for (size_t s = 0; s < Species.size(); s++)
+	{
+		if (Species[s].Desc.MinSpacing > TileSize)
+		{
+			std::cout << "Vegetation: " << Species[s].Desc.Name << " spacing is wider than a tile, it only holds against the next tiles" << std::endl;
+		}
+	}
+
+	// four passes of every other tile in x and z: the tiles of one pass never touch, so their jobs run in parallel,
+	// and each one checks its spacing against the neighbours of the earlier passes (the result does not depend on the threads)
+	int SpeciesCount = (int)Species.size();
+	for (int Pass = 0; Pass < 4; Pass++)
+	{
+		std::vector<int> PassCells;
+		for (int z = 0; z < TilesPerSide; z++)
+		{
+			for (int x = 0; x < TilesPerSide; x++)
+			{
+				if (((z % 2) * 2) + (x % 2) == Pass)
+				{
+					PassCells.push_back((z * TilesPerSide) + x);
+				}
+			}
+		}
+
+		// one job per tile and species, each job only writes into its own list so no locking is needed
+		auto ScatterJob = [this, &PassCells, SpeciesCount, Seed](int Job)
+		{
+			PROFILE_SCOPE("Scatter cell");
+			ScatterCell(PassCells[Job / SpeciesCount], Job % SpeciesCount, Seed);
+		};
+		WorkerPool::ParallelFor((int)PassCells.size() * SpeciesCount, ScatterJob);
+	}
+
+	// cell bounds enclose every instance of every species in the tile
+	size_t InstanceCount = 0;
+	for (size_t c = 0; c < Cells.size(); c++)
+	{
+		Cell& Tile = Cells[c];
+		Tile.BoundsMin = glm::vec3(Tile.TileMin.x, 0.0f, Tile.TileMin.y);
+		Tile.BoundsMax = glm::vec3(Tile.TileMax.x, 0.0f, Tile.TileMax.y);
+		bool First = true;
+
+		for (size_t s = 0; s < Species.size(); s++)
+		{
+			const VegetationSpecies& Desc = Species[s].Desc;
+			float Reach = Desc.Radius * glm::max(Desc.Scale.x, glm::max(Desc.Scale.y, Desc.Scale.z)) * (1.0f + Desc.ScaleJitter);
+
+			for (size_t i = 0; i < Tile.Instances[s].size(); i++)
+			{
+				glm::vec3 Position = glm::vec3(Tile.Instances[s][i].Model[3]);
+				if (First)
+				{
+					Tile.BoundsMin = Position - glm::vec3(Reach);
+					Tile.BoundsMax = Position + glm::vec3(Reach);
+					First = false;
+				}
+				Tile.BoundsMin = glm::min(Tile.BoundsMin, Position - glm::vec3(Reach));
+				Tile.BoundsMax = glm::max(Tile.BoundsMax, Position + glm::vec3(Reach));
+			}
+			InstanceCount += Tile.Instances[s].size();
+		}
+	}
+
+	UploadInstances();
+
+	double ScatterTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+	std::cout << "Vegetation scattered " << InstanceCount << " instances over " << Cells.size() << " cells in " << ScatterTime << " ms ("
+		<< WorkerPool::GetThreadCount() << " threads)" << std::endl;
+}
+
+void Vegetation::ScatterCell(int CellIndex, int SpeciesIndex, uint32_t Seed)
+{
+	Cell& Tile = Cells[CellIndex];
+	const VegetationSpecies& Desc = Species[SpeciesIndex].Desc;
+	std::vector<InstanceTransform>& Output = Tile.Instances[SpeciesIndex];
+	Output.clear();
+
+	// seed from the tile position and species so the result does not depend on which thread runs the job
+	uint64_t State = ((uint64_t)Seed << 32) ^ ((uint64_t)(SpeciesIndex + 1) << 48);
+	State ^= (uint64_t)(int64_t)(Tile.TileMin.x * 16.0f) * 0x9E3779B1ull;
+	State ^= (uint64_t)(int64_t)(Tile.TileMin.y * 16.0f) * 0x85EBCA77ull;
+	NextRandom(State);
+
+	// bridson poisson disk sampling inside the tile, the grid reaches one radius past the tile edges
+	const int Attempts = 30;
+	float Radius = Desc.MinSpacing;
+	float GridCell = Radius / sqrt(2.0f);
+	glm::vec2 TileSize = Tile.TileMax - Tile.TileMin;
+	glm::vec2 GridMin = Tile.TileMin - glm::vec2(Radius);
+	glm::vec2 GridMax = Tile.TileMax + glm::vec2(Radius);
+	int GridWidth = (int)ceil((GridMax.x - GridMin.x) / GridCell);
+	int GridHeight = (int)ceil((GridMax.y - GridMin.y) / GridCell);
+	std::vector<int> Grid(GridWidth * GridHeight, -1);
+	std::vector<glm::vec2> Points;
+	std::vector<int> Active;
+
+	auto GridIndex = [&](glm::vec2 Point)
+	{
+		int GridX = glm::clamp((int)((Point.x - GridMin.x) / GridCell), 0, GridWidth - 1);
+		int GridY = glm::clamp((int)((Point.y - GridMin.y) / GridCell), 0, GridHeight - 1);
+		return (GridY * GridWidth) + GridX;
+	};
+
+	// the instances the neighbouring tiles already have go into the border (the ones of later passes are still empty)
+	int CellX = CellIndex % TilesPerSide;
+	int CellZ = CellIndex / TilesPerSide;
+	for (int z = glm::max(CellZ - 1, 0); z <= glm::min(CellZ + 1, TilesPerSide - 1); z++)
+	{
+		for (int x = glm::max(CellX - 1, 0); x <= glm::min(CellX + 1, TilesPerSide - 1); x++)
+		{
+			const std::vector<InstanceTransform>& Neighbours = Cells[(z * TilesPerSide) + x].Instances[SpeciesIndex];
+			for (size_t i = 0; i < Neighbours.size() && (x != CellX || z != CellZ); i++)
+			{
+				glm::vec2 Point = glm::vec2(Neighbours[i].Model[3].x, Neighbours[i].Model[3].z);
+				if (Point.x >= GridMin.x && Point.y >= GridMin.y && Point.x < GridMax.x && Point.y < GridMax.y)
+				{
+					Grid[GridIndex(Point)] = (int)Points.size();
+					Points.push_back(Point);
+				}
+			}
+		}
+	}
+	size_t NeighbourCount = Points.size();
+
+	// true when nothing in the neighbouring grid cells is closer than the radius
+	auto Fits = [&](glm::vec2 Candidate)
+	{
+		if (Candidate.x < Tile.TileMin.x || Candidate.y < Tile.TileMin.y || Candidate.x >= Tile.TileMax.x || Candidate.y >= Tile.TileMax.y)
+		{
+			return false;
+		}
+		int Index = GridIndex(Candidate);
+		int GridX = Index % GridWidth;
+		int GridY = Index / GridWidth;
+		for (int y = glm::max(GridY - 2, 0); y <= glm::min(GridY + 2, GridHeight - 1); y++)
+		{
+			for (int x = glm::max(GridX - 2, 0); x <= glm::min(GridX + 2, GridWidth - 1); x++)
+			{
+				int Neighbour = Grid[(y * GridWidth) + x];
+				if (Neighbour >= 0 && glm::distance(Points[Neighbour], Candidate) < Radius)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+	auto Place = [&](glm::vec2 Point)
+	{
+		Grid[GridIndex(Point)] = (int)Points.size();
+		Active.push_back((int)Points.size());
+		Points.push_back(Point);
+	};
+
+	// the first point is anywhere in the tile that keeps its distance to the neighbours
+	for (int k = 0; k < Attempts && Active.empty(); k++)
+	{
+		glm::vec2 Candidate = Tile.TileMin + glm::vec2(NextFloat(State), NextFloat(State)) * TileSize;
+		if (Fits(Candidate))
+		{
+			Place(Candidate);
+		}
+	}
+
+	while (!Active.empty())
+	{
+		int ActiveSlot = (int)(NextFloat(State) * Active.size());
+		glm::vec2 Origin = Points[Active[ActiveSlot]];
+		bool Placed = false;
+
+		for (int k = 0; k < Attempts; k++)
+		{
+			float Angle = NextFloat(State) * 2.0f * (float)M_PI;
+			float Distance = Radius * (1.0f + NextFloat(State));
+			glm::vec2 Candidate = Origin + glm::vec2(cos(Angle), sin(Angle)) * Distance;
+			if (Fits(Candidate))
+			{
+				Place(Candidate);
+				Placed = true;
+				break;
+			}
+		}
+
+		if (!Placed)
+		{
+			Active[ActiveSlot] = Active.back();
+			Active.pop_back();
+		}
+	}
+
+	// keep the points of this tile that pass the height and slope rules
+	for (size_t i = NeighbourCount; i < Points.size(); i++)
+	{
+		float Height = Ground->GetHeight(Points[i].x, Points[i].y);
+		float Yaw = NextFloat(State) * 360.0f;
+		float ScaleFactor = 1.0f + (Desc.ScaleJitter * ((2.0f * NextFloat(State)) - 1.0f));
+		if (Height < Desc.MinHeight || Height > Desc.MaxHeight || Ground->GetSlope(Points[i].x, Points[i].y) > Desc.MaxSlope)
+		{
+			continue;
+		}
+
+		InstanceTransform Instance;
+		Instance.Model = glm::translate(glm::mat4(), glm::vec3(Points[i].x, Height, Points[i].y));
+		Instance.Model = glm::rotate(Instance.Model, glm::radians(Yaw), glm::vec3(0.0f, 1.0f, 0.0f));
+		Instance.Model = glm::scale(Instance.Model, Desc.Scale * ScaleFactor);
+		Output.push_back(Instance);
+	}
+
+	// the instances never move, their normal matrices are computed once for the whole tile
+	NormalMatrix::ComputeBatch(Output.data(), Output.size());
+}
+
+void Vegetation::UploadInstances()
+{
+	// the instances never move, every species buffer is written once with the tiles one after another
+	std::vector<InstanceTransform> All;
+	for (size_t s = 0; s < Species.size(); s++)
+	{
+		All.clear();
+		for (size_t c = 0; c < Cells.size(); c++)
+		{
+			Cell& Tile = Cells[c];
+			Tile.First.resize(Species.size());
+			Tile.Count.resize(Species.size());
+			Tile.First[s] = (GLuint)All.size();
+			Tile.Count[s] = (GLuint)Tile.Instances[s].size();
+			All.insert(All.end(), Tile.Instances[s].begin(), Tile.Instances[s].end());
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, Species[s].InstanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, All.size() * sizeof(InstanceTransform), All.data(), GL_STATIC_DRAW);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// the gpu has its copy, the lists were only needed for the bounds and the neighbour checks
+	for (size_t c = 0; c < Cells.size(); c++)
+	{
+		std::vector<std::vector<InstanceTransform>>().swap(Cells[c].Instances);
+	}
+}
+
+void Vegetation::Render(const glm::mat4& CameraPV, glm::vec3 CameraPos)
+{
+	// cull in terrain space so the cell bounds never need transforming
+	glm::mat4 ModelMat = Ground->GetModelMatrix();
+	Frustum ViewFrustum;
+	ViewFrustum.Extract(CameraPV * ModelMat);
+	glm::vec3 LocalCameraPos = glm::vec3(glm::inverse(ModelMat) * glm::vec4(CameraPos, 1.0f));
+
+	GLState::UseProgram(Program->GetID());
+	Program->SetMat4(ModelMatHandle, ModelMat);
+	Program->SetMat4(NormalMatHandle, Ground->GetNormalMatrix());
+	Program->SetInt(TextureHandle, 0);
+
+	VisibleCount = 0;
+	for (size_t s = 0; s < Species.size(); s++)
+	{
+		SpeciesData& Current = Species[s];
+		Current.Commands.clear();
+
+		for (size_t c = 0; c < Cells.size(); c++)
+		{
+			const Cell& Tile = Cells[c];
+			if (Tile.Count[s] == 0 || !ViewFrustum.IntersectsBox(Tile.BoundsMin, Tile.BoundsMax))
+			{
+				continue;
+			}
+
+			// distance from the camera to the closest point of the cell
+			glm::vec3 Closest = glm::clamp(LocalCameraPos, Tile.BoundsMin, Tile.BoundsMax);
+			if (glm::distance(Closest, LocalCameraPos) > Current.Desc.DrawDistance)
+			{
+				continue;
+			}
+
+			// the instances stay in the buffer, a visible tile is only a range of it (neighbours in the buffer share one)
+			if (!Current.Commands.empty() && Current.Commands.back().BaseInstance + Current.Commands.back().InstanceCount == Tile.First[s])
+			{
+				Current.Commands.back().InstanceCount += Tile.Count[s];
+			}
+			else
+			{
+				DrawElementsIndirectCommand Command = { (GLuint)Current.IndexCount, Tile.Count[s], 0, 0, Tile.First[s] };
+				Current.Commands.push_back(Command);
+			}
+			VisibleCount += Tile.Count[s];
+		}
+
+		if (Current.Commands.empty())
+		{
+			continue;
+		}
+
+		GLState::BindTexture(0, GL_TEXTURE_2D, Current.Desc.TextureID);
+		GLState::BindVertexArray(Current.VAO);
+
+		// the ranges go into this frame's part of the ring, one multi draw per species
+		GLsizeiptr Bytes = Current.Commands.size() * sizeof(DrawElementsIndirectCommand);
+		RingAllocation Commands = { nullptr, 0, Bytes };
+		if (Ring != nullptr)
+		{
+			Commands = Ring->Allocate(Bytes, sizeof(GLuint));
+			if (Commands.Data == nullptr && RingOverflowReported == false)
+			{
+				// the frame region is full (the other systems took it), said once
+				std::cout << "Vegetation: " << Current.Desc.Name << " needs " << Bytes << " bytes, more than is left in the upload ring, drawing every range on its own" << std::endl;
+				RingOverflowReported = true;
+			}
+		}
+		if (Commands.Data != nullptr)
+		{
+			memcpy(Commands.Data, Current.Commands.data(), Bytes);
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, Ring->GetBufferID());
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)Commands.Offset, (GLsizei)Current.Commands.size(), 0);
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+			continue;
+		}
+
+		// no ring or it overflowed: the same ranges, one draw each
+		for (size_t i = 0; i < Current.Commands.size(); i++)
+		{
+			const DrawElementsIndirectCommand& Command = Current.Commands[i];
+			glDrawElementsInstancedBaseInstance(GL_TRIANGLES, Current.IndexCount, GL_UNSIGNED_INT, 0, Command.InstanceCount, Command.BaseInstance);
+		}
+	}
+}
+
+size_t Vegetation::GetInstanceCount() const
+{
+	size_t Count = 0;
+	for (size_t c = 0; c < Cells.size(); c++)
+	{
+		for (size_t s = 0; s < Cells[c].Count.size(); s++)
+		{
+			Count += Cells[c].Count[s];
+		}
+	}
+	return Count;
+}
+
+size_t Vegetation::GetVisibleCount() const
+{
+	return VisibleCount;
+}
@@ -0,0 +1,91 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : Vegetation.h
+// Description    : class file for instanced trees, rocks and grass scattered over the terrain
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <glew.h>
+#include <glfw3.h>
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <gtc/type_ptr.hpp>
+#include <vector>
+#include "Terrain.h"
+#include "RingBuffer.h"
+#include "GPUScene.h"
+
+// placement rules and look of one kind of object, distances are in terrain (model) space
+struct VegetationSpecies
+{
+	const char* Name;
+	float Radius;
+	int Fidelity;
+	glm::vec3 Scale;
+	float ScaleJitter;	// random scale variation (0.2 = +-20%)
+	float MinSpacing;	// poisson disk radius
+	float MinHeight;
+	float MaxHeight;
+	float MaxSlope;		// degrees
+	float DrawDistance;
+	GLuint TextureID;
+};
+
+class Vegetation
+{
+public:
+	// the draw commands of the visible tiles go into the ring, without one (nullptr) every tile range is drawn on its own
+	Vegetation(Terrain* Ground, ShaderProgram* Program, RingBuffer* Ring);
+	~Vegetation();
+	int AddSpecies(const VegetationSpecies& Species);
+	void Scatter(uint32_t Seed);
+	void Render(const glm::mat4& CameraPV, glm::vec3 CameraPos);
+	size_t GetInstanceCount() const;
+	size_t GetVisibleCount() const;
+
+private:
+	// gpu mesh and instances of one species, the visible tiles are one multi draw
+	struct SpeciesData
+	{
+		VegetationSpecies Desc;
+		GLuint VAO;
+		GLuint InstanceVBO;		// every instance, tile after tile, uploaded once by Scatter
+		int IndexCount;
+		std::vector<DrawElementsIndirectCommand> Commands;	// this frame's visible ranges
+	};
+
+	// one terrain tile, its instances are culled as a group
+	struct Cell
+	{
+		glm::vec2 TileMin;
+		glm::vec2 TileMax;
+		glm::vec3 BoundsMin;
+		glm::vec3 BoundsMax;
+		std::vector<std::vector<InstanceTransform>> Instances;	// per species, only kept while scattering
+		std::vector<GLuint> First;		// per species, the tile's range in the instance buffer
+		std::vector<GLuint> Count;
+	};
+
+	void ScatterCell(int CellIndex, int SpeciesIndex, uint32_t Seed);
+	void UploadInstances();
+
+	Terrain* Ground;
+	RingBuffer* Ring;
+	ShaderProgram* Program;
+	UniformHandle ModelMatHandle;
+	UniformHandle NormalMatHandle;
+	UniformHandle TextureHandle;
+
+	std::vector<SpeciesData> Species;
+	std::vector<Cell> Cells;
+	int TilesPerSide = 16;
+	size_t VisibleCount = 0;
+	bool RingOverflowReported = false;
+};
@@ -0,0 +1,153 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : WorkerPool.cpp
+// Description    : persistent worker threads, each ParallelFor wakes them instead of creating new ones
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#include "WorkerPool.h"
+#include "CPUProfiler.h"
+#include <algorithm>
+
+// set on the worker threads (and while the caller runs jobs), nested ParallelFor calls then run inline
+static thread_local bool InsideJob = false;
+
+WorkerPool::WorkerPool()
+{
+	Next.store(0);
+}
+
+WorkerPool::~WorkerPool()
+{
+	Stop();
+}
+
+WorkerPool& WorkerPool::Get()
+{
+	static WorkerPool Pool;
+	return Pool;
+}
+
+void WorkerPool::Start()
+{
+	// the calling thread is one of the workers of every job
+	// the new workers start at the current generation, after a Shutdown the last job is still stored there
+	// (called with SubmitMutex held, nothing changes Generation meanwhile)
+	unsigned int ThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	for (unsigned int i = 1; i < ThreadCount; i++)
+	{
+		Workers.push_back(std::thread(&WorkerPool::WorkerLoop, this, Generation));
+	}
+}
+
+void WorkerPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Stopping = true;
+	}
+	WakeCondition.notify_all();
+	for (size_t i = 0; i < Workers.size(); i++)
+	{
+		Workers[i].join();
+	}
+	Workers.clear();
+	Stopping = false;
+}
+
+void WorkerPool::ParallelFor(int Count, JobFunction Job, void* Context)
+{
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	WorkerPool& Pool = Get();
+	if (InsideJob == true || Count == 1)
+	{
+		for (int i = 0; i < Count; i++)
+		{
+			Job(Context, i);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> Submit(Pool.SubmitMutex);
+	if (Pool.Workers.empty())
+	{
+		Pool.Start();
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(Pool.Mutex);
+		Pool.Job = Job;
+		Pool.Context = Context;
+		Pool.Count = Count;
+		Pool.Next.store(0);
+		Pool.Busy = (unsigned int)Pool.Workers.size();
+		Pool.Generation++;
+	}
+	Pool.WakeCondition.notify_all();
+
+	InsideJob = true;
+	Pool.RunJobs();
+	InsideJob = false;
+
+	// every worker has to check in, it may still be reading the job
+	std::unique_lock<std::mutex> Lock(Pool.Mutex);
+	Pool.DoneCondition.wait(Lock, [&Pool]() { return Pool.Busy == 0; });
+}
+
+unsigned int WorkerPool::GetThreadCount()
+{
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void WorkerPool::Shutdown()
+{
+	WorkerPool& Pool = Get();
+	std::lock_guard<std::mutex> Submit(Pool.SubmitMutex);
+	Pool.Stop();
+}
+
+void WorkerPool::WorkerLoop(unsigned long long Seen)
+{
+	PROFILE_THREAD_NAME("Worker");
+	InsideJob = true;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			WakeCondition.wait(Lock, [this, Seen]() { return Stopping || Generation != Seen; });
+			if (Stopping)
+			{
+				return;
+			}
+			Seen = Generation;
+		}
+
+		RunJobs();
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (--Busy == 0)
+		{
+			DoneCondition.notify_all();
+		}
+	}
+}
+
+void WorkerPool::RunJobs()
+{
+	// Job, Context and Count do not change until every worker has checked in
+	for (int i = Next++; i < Count; i = Next++)
+	{
+		Job(Context, i);
+	}
+}
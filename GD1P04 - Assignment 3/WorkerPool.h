@@ -0,0 +1,74 @@
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2022 Media Design School
+//
+// File Name      : WorkerPool.h
+// Description    : class file for the worker threads shared by every per frame parallel loop
+// Author         : Lera Blokhina
+// Mail           : valeriia.blokhina@mds.ac.nz
+//
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// the threads are started on first use and sleep between jobs, so a frame never pays for creating them
+class WorkerPool
+{
+public:
+	typedef void (*JobFunction)(void* Context, int Index);
+
+	// calls Job(Context, i) for every i below Count on the workers and the calling thread, returns when all are done
+	// a call from inside a job runs on the calling thread only
+	static void ParallelFor(int Count, JobFunction Job, void* Context);
+
+	// same for anything callable as Body(int), the body is passed by pointer so nothing is allocated
+	template<typename T>
+	static void ParallelFor(int Count, T& Body)
+	{
+		ParallelFor(Count, &CallBody<T>, &Body);
+	}
+
+	// workers plus the calling thread
+	static unsigned int GetThreadCount();
+
+	// joins the workers, the next ParallelFor starts them again
+	static void Shutdown();
+
+private:
+	WorkerPool();
+	~WorkerPool();
+
+	template<typename T>
+	static void CallBody(void* Context, int Index)
+	{
+		(*static_cast<T*>(Context))(Index);
+	}
+
+	static WorkerPool& Get();
+	void Start();
+	void Stop();
+	void WorkerLoop(unsigned long long Seen);
+	void RunJobs();
+
+	std::vector<std::thread> Workers;
+	std::mutex SubmitMutex;		// one ParallelFor at a time
+	std::mutex Mutex;
+	std::condition_variable WakeCondition;
+	std::condition_variable DoneCondition;
+
+	// the current job, guarded by Mutex (Next is taken without it)
+	JobFunction Job = nullptr;
+	void* Context = nullptr;
+	int Count = 0;
+	std::atomic<int> Next;
+	unsigned int Busy = 0;
+	unsigned long long Generation = 0;
+	bool Stopping = false;
+};
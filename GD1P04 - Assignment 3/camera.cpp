@@ -18,7 +18,7 @@ camera::camera()
 {
 
 	// calculate orthographic projection matrix - anchor point (0, 0) at center
-	ProjectionMat = glm::perspective(glm::radians(45.0f), (float)Utilities::WindowWidth / (float)Utilities::WindowHeight, 0.1f, 4000.0f);
+	ProjectionMat = glm::perspective(glm::radians(45.0f), (float)Utilities::WindowWidth / (float)Utilities::WindowHeight, NearPlane, FarPlane);
 
 	// calculate the view matrix from  camera variable
 	ViewMat = glm::lookAt(CameraPos, (CameraPos + CameraLookDir), CameraUpDir);
@@ -46,6 +46,25 @@ glm::vec3 camera::GetPosition()
 	return CameraPos;
 }
 
+glm::vec3 camera::GetLookDir()
+{
+	return CameraLookDir;
+}
+
+void camera::SetView(glm::vec3 Position, glm::vec3 LookDir)
+{
+	CameraPos = Position;
+	CameraLookDir = glm::normalize(LookDir);
+	ViewMat = glm::lookAt(CameraPos, (CameraPos + CameraLookDir), CameraUpDir);
+	CalculateMatrixPV();
+}
+
+void camera::SetAspectRatio(float AspectRatio)
+{
+	ProjectionMat = glm::perspective(glm::radians(45.0f), AspectRatio, NearPlane, FarPlane);
+	CalculateMatrixPV();
+}
+
 void camera::Update(GLFWwindow* Window, float DeltaTime)
 {
 	// query GLFW key states (normalizing vectors)
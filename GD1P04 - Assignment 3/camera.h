@@ -34,6 +34,8 @@ public:
 	glm::mat4 ViewMat;
 	glm::mat4 ProjectionMat;
 	glm::mat4 PVMMat;
+	float NearPlane = 0.1f;
+	float FarPlane = 4000.0f;
 
 	// freecam variables
 	//glm::vec3 Position; // similar to GetPosition() but separate to avoid effect on the rest of the code
@@ -45,6 +47,11 @@ public:
 	bool firstClick = true;
 	void Update(GLFWwindow* Window, float DeltaTime);
 
+	// for scripted cameras (benchmark), sets the pose directly instead of reading input
+	void SetView(glm::vec3 Position, glm::vec3 LookDir);
+	void SetAspectRatio(float AspectRatio);
+	glm::vec3 GetLookDir();
+
 private:
 
 	// camera variables
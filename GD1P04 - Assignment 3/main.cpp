@@ -21,6 +21,7 @@
 #include <glew.h>
 #include <glfw3.h>
 #include "ShaderLoader.h"
+#include "ProgramRegistry.h"
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <gtc/type_ptr.hpp>
@@ -30,17 +31,42 @@
 #include "Sphere.h"
 #include "Skybox.h"
 #include "Terrain.h"
+#include "Vegetation.h"
+#include "Grass.h"
 #include "LightManager.h"
+#include "LightClusters.h"
+#include "DeferredRenderer.h"
+#include "GLState.h"
+#include "RenderQueue.h"
+#include "SphereInstances.h"
+#include "GPUScene.h"
+#include "RingBuffer.h"
+#include "FrameConstants.h"
+#include "GPUProfiler.h"
+#include "CPUProfiler.h"
+#include "Benchmark.h"
+#include "CameraPath.h"
+#include "ShaderWatcher.h"
+#include "TransformSystem.h"
+#include "WorkerPool.h"
+#include <chrono>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h> // check properties for release version
 
 // adding variables for programs, textures and window
 GLFWwindow* Window = nullptr;
-GLuint Program_Light;
-GLuint Program_DirLight;
-GLuint Program_PointLight;
-GLuint Program_Reflection;
-GLuint Program_Color;
+ShaderProgram* Program_DirLight = nullptr;
+ShaderProgram* Program_PointLight = nullptr;
+ShaderProgram* Program_Reflection = nullptr;
+ShaderProgram* Program_Color = nullptr;
+ShaderProgram* Program_Vegetation = nullptr;
+ShaderProgram* Program_Instanced = nullptr;
+ShaderProgram* Program_ColorInstanced = nullptr;
+
+// uniform handles used directly in Render()
+UniformHandle Reflection_ModelMat;
+UniformHandle Reflection_NormalMat;
+UniformHandle Reflection_Texture0;
 float CurrentTime;
 GLuint Texture_Gas;
 GLuint Texture_Terrain;
@@ -50,6 +76,7 @@ bool scissor = false;
 bool stencil = false;
 bool wireframe = false;
 bool facecull = false;
+bool deferredMode = false;
 
 struct RGBData
 {
@@ -58,24 +85,61 @@ struct RGBData
 
 // variables for delta time and objects
 float PreviousTimeStep; // delta time
+float StatsTimer = 0.0f; // time since the last stats print
+int StatsFrames = 0;
 camera ortho;
 Sphere* sphere = nullptr;
 Skybox* environment = nullptr;
 LightManager* light = nullptr;
+LightClusters* clusters = nullptr;
+DeferredRenderer* deferred = nullptr;
+RenderQueue* queue = nullptr;
+SphereInstances* crowd = nullptr;
+GPUScene* gpuScene = nullptr;
+RingBuffer* ring = nullptr;
+FrameConstants* frame = nullptr;
+GPUProfiler* gpuProfiler = nullptr;
+
+// benchmark mode (--benchmark), fixed step frames into an offscreen target instead of the window
+BenchmarkSettings benchmarkSettings;
+Benchmark* benchmark = nullptr;
+int renderWidth = Utilities::WindowWidth;
+int renderHeight = Utilities::WindowHeight;
+
+// camera path recorded with F5 (F6 starts a new segment), F8 replays it
+CameraPath* cameraPath = nullptr;
+bool replaying = false;
+float replayTime = 0.0f;
+
+// shader files saved while running are hot reloaded
+ShaderWatcher* shaderWatcher = nullptr;
+
+// field of static spheres drawn either per object or with multi draw indirect, for comparing the submission cost
+std::vector<Sphere*> fieldSpheres;
+int fieldMeshes[3];
+int fieldMaterials[2];
+bool fieldIndirect = true;
+double fieldSubmitTime = 0.0;
 Terrain* terrainMap = nullptr;
+TransformSystem* transforms = nullptr;
+Vegetation* vegetation = nullptr;
+Grass* grass = nullptr;
 RGBData* imageColours = nullptr;
 
 // variables for matrices
 glm::mat4 ObjModelMat;
-glm::mat4 PVMMat;
 
-// array of spheres
-Sphere* manyBalls[10];
-Sphere* StencilBalls[10];
+// the lit spheres and their outlines, one instanced draw each (their transforms are in the transform system)
+SphereInstances* sceneBalls = nullptr;
+SphereInstances* sceneOutlines = nullptr;
+TransformHandle sceneBallTransforms[10];
+float sceneBallAngle = 0.0f;
 
 // load the image data 
 void ImageLoad(const char* FilePath, GLuint& TextureID)
 {
+	PROFILE_FUNCTION();
+
 	int ImageWidth;
 	int ImageHeight;
 	int ImageComponents;
@@ -84,7 +148,7 @@ void ImageLoad(const char* FilePath, GLuint& TextureID)
 
 	// create and bind a new texture template
 	glGenTextures(1, &TextureID);
-	glBindTexture(GL_TEXTURE_2D, TextureID);
+	GLState::BindTexture(0, GL_TEXTURE_2D, TextureID);
 
 	// setting the filtering and mipmap parameters for this texture ID
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -123,10 +187,37 @@ void ImageLoad(const char* FilePath, GLuint& TextureID)
 		}
 	}
 
-	// generate the mipmaps, free the memory and unbind the texture
+	// generate the mipmaps and free the memory
 	glGenerateMipmap(GL_TEXTURE_2D);
 	stbi_image_free(ImageData);
-	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// switch the lit spheres between forward and deferred shading
+void SetDeferredMode(bool Enabled)
+{
+	if (deferredMode == Enabled)
+	{
+		return;
+	}
+	deferredMode = Enabled;
+	sceneBalls->SetProgram(deferredMode ? deferred->GetGeometryProgram() : Program_Instanced);
+	std::cout << "Shading: " << (deferredMode ? "deferred" : "forward") << std::endl;
+}
+
+// the KeyInput toggles a camera path records with every frame
+uint8_t GetRenderFlags()
+{
+	return (wireframe ? PATH_FLAG_WIREFRAME : 0) | (stencil ? PATH_FLAG_STENCIL : 0) | (scissor ? PATH_FLAG_SCISSOR : 0)
+		| (facecull ? PATH_FLAG_FACECULL : 0) | (deferredMode ? PATH_FLAG_DEFERRED : 0);
+}
+
+void SetRenderFlags(uint8_t Flags)
+{
+	wireframe = (Flags & PATH_FLAG_WIREFRAME) != 0;
+	stencil = (Flags & PATH_FLAG_STENCIL) != 0;
+	scissor = (Flags & PATH_FLAG_SCISSOR) != 0;
+	facecull = (Flags & PATH_FLAG_FACECULL) != 0;
+	SetDeferredMode((Flags & PATH_FLAG_DEFERRED) != 0);
 }
 
 // calllback function called in response to keyboard input, processed during glfwPollEvents()
@@ -152,6 +243,142 @@ void KeyInput(GLFWwindow* InputWindow, int Key, int ScanCode, int Action, int Mo
 	{
 		facecull = !facecull;
 	}
+	if (Key == GLFW_KEY_T && Action == GLFW_PRESS)
+	{
+		// toggle between the full terrain grid and the adaptive mesh
+		terrainMap->SetMaxError((terrainMap->GetMaxError() > 0.0f) ? 0.0f : 0.5f);
+	}
+	if (Key == GLFW_KEY_Y && Action == GLFW_PRESS)
+	{
+		// toggle between the full terrain grid and the static (delaunay TIN) mesh
+		if (terrainMap->GetMaxError() > 0.0f)
+		{
+			terrainMap->SetMaxError(0.0f);
+		}
+		else
+		{
+			terrainMap->UseStaticMesh(0.5f);
+		}
+	}
+	if (Key == GLFW_KEY_L && Action == GLFW_PRESS)
+	{
+		// double the point lights around the spheres, back to the two scene lights after 4096
+		if (light->GetPointLightCount() >= 4096)
+		{
+			std::vector<PointLight> SceneLights(light->GetPointLights().begin(), light->GetPointLights().begin() + 2);
+			light->ClearPointLights();
+			light->AddPointLight(SceneLights[0]);
+			light->AddPointLight(SceneLights[1]);
+		}
+		else
+		{
+			int NewLights = light->GetPointLightCount();
+			for (int i = 0; i < NewLights; i++)
+			{
+				PointLight Extra;
+				Extra.Position = glm::vec3((rand() % 600) / 10.0f - 30.0f, (rand() % 200) / 10.0f - 5.0f, (rand() % 600) / 10.0f - 30.0f);
+				Extra.Color = glm::vec3((rand() % 100) / 100.0f, (rand() % 100) / 100.0f, (rand() % 100) / 100.0f);
+				Extra.AmbientStrength = 0.0f;
+				Extra.LightSpecularStrength = 1.0f;
+				Extra.AttenuationConstant = 1.0f;
+				Extra.AttenuationLinear = 0.7f;
+				Extra.AttenuationExponent = 1.8f;
+				light->AddPointLight(Extra);
+			}
+		}
+		std::cout << "Point lights: " << light->GetPointLightCount() << std::endl;
+	}
+	if (Key == GLFW_KEY_G && Action == GLFW_PRESS)
+	{
+		SetDeferredMode(!deferredMode);
+	}
+	if (Key == GLFW_KEY_F5 && Action == GLFW_PRESS)
+	{
+		// start recording the camera, or stop and save the recording
+		if (cameraPath->IsRecording())
+		{
+			cameraPath->EndRecording();
+			cameraPath->Save("Resources/CameraPaths/Recorded.campath");
+		}
+		else
+		{
+			replaying = false;
+			cameraPath->BeginRecording();
+			std::cout << "Recording camera path (F6 new segment, F5 stop)" << std::endl;
+		}
+	}
+	if (Key == GLFW_KEY_F6 && Action == GLFW_PRESS)
+	{
+		cameraPath->MarkSegment();
+	}
+	if (Key == GLFW_KEY_F8 && Action == GLFW_PRESS && cameraPath->IsRecording() == false)
+	{
+		// replay the last recording in a loop, the live camera is back when it is stopped
+		replaying = !replaying && cameraPath->IsEmpty() == false;
+		replayTime = 0.0f;
+		std::cout << "Camera path replay: " << (replaying ? "on" : "off") << std::endl;
+	}
+	if (Key == GLFW_KEY_K && Action == GLFW_PRESS)
+	{
+		// toggle a block of 100k instanced spheres above the terrain, still a single draw
+		if (crowd->GetInstanceCount() > 0)
+		{
+			crowd->Clear();
+		}
+		else
+		{
+			for (int x = 0; x < 100; x++)
+			{
+				for (int y = 0; y < 10; y++)
+				{
+					for (int z = 0; z < 100; z++)
+					{
+						crowd->Add(glm::translate(glm::mat4(), glm::vec3(x * 1.5f - 75.0f, y * 1.5f + 20.0f, z * 1.5f - 75.0f)));
+					}
+				}
+			}
+		}
+		std::cout << "Instanced spheres: " << crowd->GetInstanceCount() << std::endl;
+	}
+	if (Key == GLFW_KEY_N && Action == GLFW_PRESS)
+	{
+		// double the static sphere field (3 meshes, 2 textures), back to empty after 16384
+		size_t Count = fieldSpheres.empty() ? 256 : fieldSpheres.size() * 2;
+		for (size_t i = 0; i < fieldSpheres.size(); i++)
+		{
+			delete fieldSpheres[i];
+		}
+		fieldSpheres.clear();
+		gpuScene->ClearObjects();
+
+		const float Radii[3] = { 0.4f, 0.6f, 0.8f };
+		const int Fidelities[3] = { 8, 12, 16 };
+		const GLuint Textures[2] = { Texture_Gas, Texture_Terrain };
+		for (size_t i = 0; Count <= 16384 && i < Count; i++)
+		{
+			int MeshIndex = (int)(i % 3);
+			int MaterialIndex = (int)(i % 2);
+			glm::vec3 Position = glm::vec3((rand() % 800) / 10.0f - 40.0f, (rand() % 200) / 10.0f + 40.0f, (rand() % 800) / 10.0f - 40.0f);
+
+			Sphere* FieldSphere = new Sphere(Radii[MeshIndex], Fidelities[MeshIndex], Textures[MaterialIndex], Program_PointLight, transforms);
+			FieldSphere->SetPosition(Position);
+			fieldSpheres.push_back(FieldSphere);
+		}
+
+		// the field never moves, both paths draw the matrices the transform system builds for the spheres
+		transforms->Update();
+		for (size_t i = 0; i < fieldSpheres.size(); i++)
+		{
+			gpuScene->AddObject(fieldMeshes[i % 3], fieldMaterials[i % 2], fieldSpheres[i]->GetModelMatrix());
+		}
+		std::cout << "Sphere field: " << fieldSpheres.size() << " objects" << std::endl;
+	}
+	if (Key == GLFW_KEY_M && Action == GLFW_PRESS)
+	{
+		// switch the sphere field between one draw per object and multi draw indirect
+		fieldIndirect = !fieldIndirect;
+		std::cout << "Sphere field: " << (fieldIndirect ? "multi draw indirect" : "one draw per object") << std::endl;
+	}
 	if (Key == GLFW_KEY_R && Action == GLFW_PRESS)
 	{
 		//reset the scene
@@ -162,26 +389,66 @@ void KeyInput(GLFWwindow* InputWindow, int Key, int ScanCode, int Action, int Mo
 	}
 }
 
+// the window changed size, the viewport, the projection and the g-buffer follow it
+void FramebufferResize(GLFWwindow* window, int Width, int Height)
+{
+	// a minimised window reports 0 x 0
+	if (Width <= 0 || Height <= 0)
+	{
+		return;
+	}
+
+	renderWidth = Width;
+	renderHeight = Height;
+	GLState::Viewport(0, 0, Width, Height);
+	ortho.SetAspectRatio((float)Width / (float)Height);
+	deferred->Resize(Width, Height);
+}
+
 //setup the initial elements of the program
 void InitialSetup()
 {
+	PROFILE_FUNCTION();
+
 	//set the colour of the window for when the buffer is cleared
 	glClearColor(1.0f, 0.0f, 1.0f, 1.0f); // red, green, blue, alpha
 
-	// random seed
-	srand((unsigned int)time(NULL));
+	// random seed, fixed for benchmark runs so every run draws the same scene
+	srand(benchmarkSettings.Enabled ? 1u : (unsigned int)time(NULL));
 
-	glEnable(GL_DEPTH_TEST);
+	GLState::Enable(GL_DEPTH_TEST);
 
-	glDepthFunc(GL_LESS);
+	GLState::DepthFunc(GL_LESS);
 
 	// maps the range of the window size to NDC (-1 -> 1
-	glViewport(0, 0, 800, 800);
+	GLState::Viewport(0, 0, 800, 800);
+
+	cameraPath = new CameraPath();
+
+	// the benchmark draws into its own target at its own resolution
+	if (benchmarkSettings.Enabled == true)
+	{
+		benchmark = new Benchmark(benchmarkSettings);
+		renderWidth = benchmarkSettings.Width;
+		renderHeight = benchmarkSettings.Height;
+		ortho.SetAspectRatio((float)renderWidth / (float)renderHeight);
+	}
 
 	// create mapping
 	std::map<std::string, GLuint> ShaderMap; //can be initialized globally or in main based where map access is needed
 
-	// calling skybox
+	// every program of the scene starts compiling now, the textures below load while the driver works
+	ProgramRegistry::BeginAll(ShaderMap);
+
+	// inverting vertical image
+	stbi_set_flip_vertically_on_load(true);
+
+	// load the image data (and back texture for gif)
+
+	ImageLoad("Resources/Textures/Gas.png", Texture_Gas);
+	ImageLoad("Resources/Textures/Terrain.jpg", Texture_Terrain);
+
+	// calling skybox (its faces are loaded unflipped)
 	environment = new Skybox(ShaderMap, &ortho);
 
 	environment->ImageLoad();
@@ -190,53 +457,109 @@ void InitialSetup()
 
 	// calling lights
 	light = new LightManager();
+	// per frame uploads (cluster tables, visible vegetation) are written into a triple buffered persistent ring
+	ring = new RingBuffer(8 * 1024 * 1024, 3);
+	frame = new FrameConstants(ring);
+	clusters = new LightClusters(16, 16, 24, ring);
+	deferred = new DeferredRenderer(renderWidth, renderHeight, ShaderMap);
+	if (benchmark != nullptr)
+	{
+		deferred->SetOutputFramebuffer(benchmark->GetFramebuffer());
+	}
 
-	// create the program
-	Program_DirLight = ShaderLoader::CreateProgram("Resources/Shaders/3D_Normals.vs",
-		"Resources/Shaders/Directional_Light.fs",
-		ShaderMap);
-	Program_PointLight = ShaderLoader::CreateProgram("Resources/Shaders/3D_Normals.vs",
-		"Resources/Shaders/3DLight_Phong.fs",
-		ShaderMap);
-	Program_Reflection = ShaderLoader::CreateProgram("Resources/Shaders/3D_Normals.vs",
-		"Resources/Shaders/Reflection.fs",
-		ShaderMap);
-	Program_Color = ShaderLoader::CreateProgram("Resources/Shaders/3D_Normals.vs",
-		"Resources/Shaders/FixedColor.fs",
-		ShaderMap);
-	
-	// inverting vertical image
-	stbi_set_flip_vertically_on_load(true);
+	// per frame render queue
+	queue = new RenderQueue();
 
-	// load the image data (and back texture for gif)
+	// gpu time per pass, read back three frames late so the queries never stall the frame
+	gpuProfiler = new GPUProfiler(3, std::max(600, (benchmark != nullptr) ? benchmark->GetSettings().Frames : 0));
+	queue->SetProfiler(gpuProfiler);
 
-	ImageLoad("Resources/Textures/Gas.png", Texture_Gas);
+	// positions, rotations and scales of the spheres and the terrain, their matrices are built in one batch per frame
+	transforms = new TransformSystem();
+	std::cout << "Transform system: " << (TransformSystem::HasAVX2() ? "avx2" : "scalar") << " kernel" << std::endl;
+	if (benchmark != nullptr)
+	{
+		// the sort report and the old per object path against the batch kernels, only in benchmark runs as they take about a second
+		RenderQueue::Benchmark(10000);
+		TransformSystem::Benchmark(1000);
+		TransformSystem::Benchmark(10000);
+		TransformSystem::Benchmark(100000);
+	}
+
+	// create the program
+	Program_DirLight = ProgramRegistry::Get(PROGRAM_DIRECTIONAL_LIGHT, ShaderMap);
+	Program_PointLight = ProgramRegistry::Get(PROGRAM_POINT_LIGHT, ShaderMap);
+	Program_Reflection = ProgramRegistry::Get(PROGRAM_REFLECTION, ShaderMap);
+	Program_Color = ProgramRegistry::Get(PROGRAM_COLOR, ShaderMap);
+	Reflection_ModelMat = Program_Reflection->GetUniform("Model");
+	Reflection_NormalMat = Program_Reflection->GetUniform("NormalMatrix");
+	Reflection_Texture0 = Program_Reflection->GetUniform("Texture0");
 
 	//calling terrain
-	ImageLoad("Resources/Textures/Terrain.jpg", Texture_Terrain);
-	terrainMap = new Terrain(Texture_Terrain, Program_Color);
+	terrainMap = new Terrain("Resources/Heightmaps/Terrain.raw", Texture_Terrain, Program_Color, transforms);
+	terrainMap->ReportAdaptiveMesh();
 
 	//terrainMap->SetPosition(glm::vec3(1.0f, 0.0f, 1.0f));
 
+	// scattering vegetation over the terrain (one instanced draw per species)
+	Program_Vegetation = ProgramRegistry::Get(PROGRAM_VEGETATION, ShaderMap);
+	vegetation = new Vegetation(terrainMap, Program_Vegetation, ring);
+	//                        name     radius fidelity scale                       jitter spacing height range      slope  distance texture
+	vegetation->AddSpecies({ "Tree",  1.0f,  12,      glm::vec3(0.8f, 3.0f, 0.8f), 0.3f,  6.0f,   -1000.0f, 1000.0f, 30.0f, 400.0f, Texture_Terrain });
+	vegetation->AddSpecies({ "Rock",  1.0f,  6,       glm::vec3(1.0f, 0.6f, 1.0f), 0.4f,  8.0f,   -1000.0f, 1000.0f, 60.0f, 200.0f, Texture_Gas });
+	vegetation->AddSpecies({ "Grass", 0.15f, 4,       glm::vec3(1.0f, 2.5f, 1.0f), 0.3f,  0.6f,   -1000.0f, 1000.0f, 40.0f, 60.0f,  Texture_Terrain });
+	vegetation->Scatter(1234);
+
+	// gpu generated grass, density taken from the green channel of the terrain texture
+	grass = new Grass(terrainMap, Texture_Terrain, ShaderMap);
+
+	// instanced spheres, filled with the K key
+	Program_Instanced = ProgramRegistry::Get(PROGRAM_INSTANCED, ShaderMap);
+	crowd = new SphereInstances(0.5f, 8, Texture_Gas, Program_Instanced);
+
+	// gpu driven scene for the sphere field (filled with the N key)
+	gpuScene = new GPUScene(ShaderMap);
+	const float FieldRadii[3] = { 0.4f, 0.6f, 0.8f };
+	const int FieldFidelities[3] = { 8, 12, 16 };
+	for (int i = 0; i < 3; i++)
+	{
+		std::vector<GLfloat> Vertices;
+		std::vector<GLuint> Indices;
+		Sphere::BuildGeometry(FieldRadii[i], FieldFidelities[i], Vertices, Indices);
+		fieldMeshes[i] = gpuScene->AddMesh(Vertices, Indices);
+	}
+	fieldMaterials[0] = gpuScene->AddMaterial(Texture_Gas);
+	fieldMaterials[1] = gpuScene->AddMaterial(Texture_Terrain);
+
 	// sphere object called
-	sphere = new Sphere(0.25f, 50, Texture_Gas, Program_Reflection, light);
+	sphere = new Sphere(0.25f, 50, Texture_Gas, Program_Reflection, transforms);
+	Program_ColorInstanced = ProgramRegistry::Get(PROGRAM_COLOR_INSTANCED, ShaderMap);
+	sceneBalls = new SphereInstances(0.7f, 50, Texture_Gas, Program_Instanced);
+	sceneOutlines = new SphereInstances(0.8f, 50, NULL, Program_ColorInstanced);
 	for (size_t i = 0; i < 10; i++)
 	{
 		glm::vec3 pos = glm::vec3(rand() % 2, rand() % 2, -(rand() % 5));
 
-		manyBalls[i] = new Sphere(0.7f, 50, Texture_Gas, Program_PointLight, light);
-		manyBalls[i]->SetPosition(pos);
-
-		StencilBalls[i] = new Sphere(0.8f, 50, NULL, Program_Color, light);
-		StencilBalls[i]->SetPosition(pos);
+		sceneBallTransforms[i] = transforms->Add(pos, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(0.5f, 0.5f, 0.5f));
+		sceneBalls->Add(transforms->GetModel(sceneBallTransforms[i]));
+		sceneOutlines->Add(transforms->GetModel(sceneBallTransforms[i]));
 	}
+	std::cout << "Mesh cache: " << MeshCache::GetMeshCount() << " meshes for " << MeshCache::GetRequestCount() << " requests" << std::endl;
 	// callback for the key input (needed for ESC button)
 	glfwSetKeyCallback(Window, KeyInput);
+
+	// the benchmark target keeps its size, only the window is followed
+	if (benchmark == nullptr)
+	{
+		glfwSetFramebufferSizeCallback(Window, FramebufferResize);
+	}
 	
 }
 
 void Update()
 {
+	PROFILE_FUNCTION();
+
 	glfwPollEvents();
 
 	// get the current time
@@ -247,126 +570,381 @@ void Update()
 	float DeltaTime = CurrentTimeStep - PreviousTimeStep;
 	PreviousTimeStep = CurrentTimeStep;
 
-	// calling freecam
-	ortho.Update(Window, DeltaTime);
-	// manyBalls update
+	// calling freecam, the benchmark uses its fixed step and camera path instead of the clock and input
+	uint8_t PathFlags = 0;
+	if (benchmark != nullptr)
+	{
+		CurrentTime = benchmark->GetTime();
+		DeltaTime = benchmark->GetSettings().Step;
+		if (benchmark->UpdateCamera(ortho, PathFlags))
+		{
+			SetRenderFlags(PathFlags);
+		}
+	}
+	else if (replaying == true)
+	{
+		int Segment = 0;
+		replayTime = (replayTime > cameraPath->GetDuration()) ? 0.0f : replayTime;
+		cameraPath->Apply(replayTime, ortho, PathFlags, Segment);
+		SetRenderFlags(PathFlags);
+		replayTime += DeltaTime;
+	}
+	else
+	{
+		ortho.Update(Window, DeltaTime);
+	}
+	cameraPath->Record(DeltaTime, ortho, GetRenderFlags());
+	// the lit spheres spin half a degree per frame
+	sceneBallAngle += 0.5f;
+	if (sceneBallAngle > 360.0f)
+	{
+		sceneBallAngle -= 360.0f;
+	}
 	for (size_t i = 0; i < 10; i++)
 	{
-		manyBalls[i]->Update(DeltaTime, ortho.GetMatrixPV());
-		StencilBalls[i]->Update(DeltaTime, ortho.GetMatrixPV());
+		transforms->SetRotation(sceneBallTransforms[i], glm::angleAxis(glm::radians(sceneBallAngle), glm::vec3(0.0f, 1.0f, 0.0f)));
 	}
 	// reflection sphere update
-	sphere->Update(DeltaTime, ortho.GetMatrixPV());
+	sphere->Update(DeltaTime);
 
-	terrainMap->Update(DeltaTime, ortho.GetMatrixPV());
+	terrainMap->Update(DeltaTime);
+
+	// every object above only wrote its position / rotation / scale, the matrices are built here in one pass
+	transforms->Update();
+
+	// the lit spheres and their outlines draw the composed matrices
+	for (size_t i = 0; i < 10; i++)
+	{
+		sceneBalls->SetTransform(i, transforms->GetModel(sceneBallTransforms[i]));
+		sceneOutlines->SetTransform(i, transforms->GetModel(sceneBallTransforms[i]));
+	}
 
 	// skybox update
 	environment->Update(DeltaTime);
 
+	// print the grass blade count against the average frame time every couple of seconds
+	// (not in benchmark runs, reading the blade count back stalls the gpu)
+	StatsTimer += DeltaTime;
+	StatsFrames++;
+	if (StatsTimer >= 2.0f && benchmark == nullptr)
+	{
+		std::cout << "Grass blades: " << grass->ReadInstanceCount() << " / " << grass->GetCandidateCount()
+			<< " | frame time: " << (StatsTimer * 1000.0f / StatsFrames) << " ms ("
+			<< (deferredMode ? "deferred" : "forward") << ")" << std::endl;
+
+		// uniforms are set through handles (lookups only happen for new names), a value that is already set is not sent again
+		std::cout << "Uniform calls per frame: " << ShaderProgram::GetFrameUniformCalls() / StatsFrames
+			<< " | skipped (same value): " << ShaderProgram::GetFrameSkippedCalls() / StatsFrames
+			<< " | location lookups per frame: " << ShaderProgram::GetFrameNameLookups() / StatsFrames
+			<< " | light block uploads: " << light->GetUploadCount() << std::endl;
+		std::cout << "Point lights: " << light->GetPointLightCount() << " | cluster build: " << clusters->GetBuildTime()
+			<< " ms | cluster light indices: " << clusters->GetIndexCount() << std::endl;
+		std::cout << "GL state calls per frame: " << GLState::GetFrameIssuedCalls() / StatsFrames
+			<< " issued | " << GLState::GetFrameFilteredCalls() / StatsFrames << " filtered" << std::endl;
+		std::cout << "Render queue: " << queue->GetItemCount() << " items | sort: " << queue->GetSortTime()
+			<< " ms | state changes: " << queue->GetStateChanges() << " | instanced spheres: " << crowd->GetInstanceCount() << " (1 draw)" << std::endl;
+		std::cout << "Sphere field: " << fieldSpheres.size() << " objects | "
+			<< (fieldIndirect ? "multi draw indirect, " : "per object, ")
+			<< (fieldIndirect ? gpuScene->GetDrawCalls() : (int)fieldSpheres.size()) << " draws | cpu submit: " << fieldSubmitTime << " ms" << std::endl;
+		std::cout << "Upload ring: " << (ring->GetBytesUploaded() / StatsFrames) / 1024 << " KB per frame | stalls: "
+			<< ring->GetStallCount() << " | overflows: " << ring->GetOverflowCount() << std::endl;
+		gpuProfiler->PrintStats();
+		ShaderProgram::ResetFrameStats();
+		GLState::ResetFrameStats();
+		ring->ResetStats();
+		StatsTimer = 0.0f;
+		StatsFrames = 0;
+	}
+
+}
+// camera values the vegetation and grass draws need, lives on the stack of Render until the queue has run
+struct FrameView
+{
+	glm::mat4 CameraPV;
+	glm::vec3 CameraPos;
+};
+
+// draws of the queue items with their own draw path
+void DrawVegetation(void* Context)
+{
+	const FrameView* View = (const FrameView*)Context;
+	vegetation->Render(View->CameraPV, View->CameraPos);
+}
+
+void DrawGrass(void* Context)
+{
+	const FrameView* View = (const FrameView*)Context;
+	grass->Render(View->CameraPV, View->CameraPos);
+}
+
+void DrawSphereInstances(void* Context)
+{
+	((SphereInstances*)Context)->Render();
 }
+
+// only the cpu side of the submission is timed
+void DrawSphereField(void* Context)
+{
+	std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+	if (fieldIndirect == true)
+	{
+		gpuScene->Render();
+	}
+	else
+	{
+		for (size_t i = 0; i < fieldSpheres.size(); i++)
+		{
+			fieldSpheres[i]->Render();
+		}
+	}
+	fieldSubmitTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+void DrawSkybox(void* Context)
+{
+	((Skybox*)Context)->Render();
+}
+
 //render all the objects
 void Render()
 {
+	PROFILE_FUNCTION();
+
+	gpuProfiler->BeginFrame((benchmark != nullptr) ? benchmark->GetFrameName() : "Frame");
+	if (benchmark != nullptr)
+	{
+		benchmark->BindTarget();
+	}
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-	//bind vertex array for sphere
-	glUseProgram(Program_Reflection);
+	// this frame's part of the upload ring, waits only if the gpu is three frames behind
+	ring->BeginFrame();
 
-	// send variables to shaders with uniform
-	GLint CurrentTimeLoc = glGetUniformLocation(Program_DirLight, "CurrentTime");
-	glUniform1f(CurrentTimeLoc, CurrentTime);
+	// camera, time and viewport are written once and read by every program through FrameBlock
+	frame->Update(ortho, CurrentTime, glm::vec2(renderWidth, renderHeight));
 
-	//send variables to shaders via uniform (reflection)
-	GLint ModelMatLoc = glGetUniformLocation(Program_Reflection, "Model");
-	glUniformMatrix4fv(ModelMatLoc, 1, GL_FALSE, glm::value_ptr(ObjModelMat));
-	GLint PVMMatLoc = glGetUniformLocation(Program_Reflection, "PVM");
-	glUniformMatrix4fv(PVMMatLoc, 1, GL_FALSE, glm::value_ptr(PVMMat));
+	//bind vertex array for sphere
+	GLState::UseProgram(Program_Reflection->GetID());
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, environment->GetTextureID());
-	glUniform1i(glGetUniformLocation(Program_Reflection, "Texture0"), 0);
+	//send variables to shaders via uniform (reflection)
+	Program_Reflection->SetMat4(Reflection_ModelMat, ObjModelMat);
+	Program_Reflection->SetMat4(Reflection_NormalMat, NormalMatrix::Compute(ObjModelMat));
 
-	GLint CameraPosLoc = glGetUniformLocation(Program_Reflection, "CameraPos");
-	glUniform3fv(CameraPosLoc, 1, glm::value_ptr(ortho.GetPosition()));
+	GLState::BindTexture(0, GL_TEXTURE_CUBE_MAP, environment->GetTextureID());
+	Program_Reflection->SetInt(Reflection_Texture0, 0);
 	
-	// mirror sphere render
-	//sphere->Render();
-
-	// terrain render
-	terrainMap->Render();
+	// lights are shared by every lit program through one uniform buffer
+	light->Bind();
 
-	// environment render
-	environment->Render();
+	// sort the point lights into the view clusters, the lit shaders only read the lights of their own cluster
+	clusters->Build(ortho.ViewMat, ortho.ProjectionMat, ortho.NearPlane, ortho.FarPlane,
+		glm::vec2(renderWidth, renderHeight), light->GetPointLights());
 
-	//scissor test
-	if (scissor == true)
+	// deferred mode: the lit spheres go into the g-buffer and get lit once per pixel before the forward objects
+	if (deferredMode == true)
 	{
-		glEnable(GL_SCISSOR_TEST);
-		glScissor(200, 200, 400, 400);
+		gpuProfiler->BeginScope("Deferred geometry");
+		deferred->BeginGeometryPass();
+		GLState::SetEnabled(GL_SCISSOR_TEST, scissor);
+		GLState::Scissor(200, 200, 400, 400);
+		GLState::PolygonMode(wireframe ? GL_LINE : GL_FILL);
+		sceneBalls->SetFaceCulling(facecull);
+		sceneBalls->Render();
+		GLState::Disable(GL_SCISSOR_TEST);
+		deferred->EndGeometryPass();
+		gpuProfiler->EndScope();
+
+		gpuProfiler->BeginScope("Deferred lighting");
+		deferred->LightingPass(ortho.GetMatrixPV());
+		gpuProfiler->EndScope();
 	}
 
-	// wireframe/faceculling toggle
-	if (wireframe == true)
+	// everything else is queued, sorted by pass and state and then drawn front to back
+	glm::vec3 CameraPos = ortho.GetPosition();
+	FrameView View = { ortho.GetMatrixPV(), CameraPos };
+	queue->Begin();
+
+	// mirror sphere render
+	//sphere->Submit(queue, PASS_OPAQUE, CameraPos);
+
+	// terrain, vegetation (instanced) and grass (generated on the gpu)
+	terrainMap->Submit(queue, PASS_OPAQUE, CameraPos).Scope = "Terrain";
+	queue->SubmitCustom(PASS_OPAQUE, 0, 0.0f, DrawVegetation, &View).Scope = "Vegetation";
+	queue->SubmitCustom(PASS_OPAQUE, 0, 0.0f, DrawGrass, &View).Scope = "Grass";
+	queue->SubmitCustom(PASS_OPAQUE, crowd->GetProgramID(), 0.0f, DrawSphereInstances, crowd).Scope = "Instanced spheres";
+
+	queue->SubmitCustom(PASS_OPAQUE, 0, 0.0f, DrawSphereField, nullptr).Scope = "Sphere field";
+
+	// environment render, after the opaque objects so only the uncovered pixels are shaded
+	queue->SubmitCustom(PASS_SKY, 0, 0.0f, DrawSkybox, environment).Scope = "Skybox";
+
+	// spheres mark the stencil buffer (already shaded in deferred mode), the outlines are drawn after all of them
+	sceneBalls->SetFaceCulling(facecull);
+	sceneBalls->Submit(queue, deferredMode ? PASS_STENCIL_ONLY : PASS_STENCIL).Scissor = scissor;
+	if (stencil == true)
 	{
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		sceneOutlines->Submit(queue, PASS_OUTLINE).Scissor = scissor;
 	}
-	else
+
+	//scissor box and wireframe toggle
+	GLState::Scissor(200, 200, 400, 400);
+	GLState::PolygonMode(wireframe ? GL_LINE : GL_FILL);
+
+	queue->Execute();
+	ring->EndFrame();
+	gpuProfiler->EndFrame();
+
+	// nothing is shown in benchmark runs, the ring fences keep the cpu from running ahead
+	if (benchmark == nullptr)
 	{
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		glfwSwapBuffers(Window);
 	}
+}
 
-	// render lights
-	light->Render(Program_DirLight);
+// forward against deferred shading of the same spheres while the point lights and the overdraw grow (--shading-sweep)
+// the walls are drawn back to front, so forward shading pays for every layer and deferred only for its g-buffer writes
+void ShadingSweep()
+{
+	PROFILE_FUNCTION();
 
-	for (size_t i = 0; i < 10; i++)
-	{
-		//faceculling toggle
-		manyBalls[i]->SetFaceCulling(facecull);
+	const int LightCounts[] = { 2, 32, 256, 1024 };
+	const int LayerCounts[] = { 1, 4, 16 };
+	const int Frames = 10;
 
-		// stencil test enabled
-		glEnable(GL_STENCIL_TEST);
-		glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+	// a fixed camera in front of the walls, the scene keeps its own camera and lights
+	camera SweepCamera;
+	SweepCamera.SetAspectRatio((float)renderWidth / (float)renderHeight);
+	SweepCamera.SetView(glm::vec3(0.0f, 0.0f, 12.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+	std::vector<PointLight> SceneLights = light->GetPointLights();
 
-		// stencil test, set value, 1st pass
-		glStencilFunc(GL_ALWAYS, 1, 0xFF);
-		glStencilMask(0xFF); // enable writing to stencil buffer
-		manyBalls[i]->Render();// render regular sized shape and fill stencil buffer
+	SphereInstances* Walls = new SphereInstances(0.5f, 12, Texture_Gas, Program_Instanced);
+	GLuint Query;
+	glGenQueries(1, &Query);
 
-		if (stencil == true)
+	std::cout << "Shading sweep (gpu ms, forward / deferred):" << std::endl;
+	for (size_t l = 0; l < sizeof(LayerCounts) / sizeof(LayerCounts[0]); l++)
+	{
+		// 16 x 16 spheres per wall, each wall 0.5 further away and covering the whole view
+		Walls->Clear();
+		for (int Layer = LayerCounts[l] - 1; Layer >= 0; Layer--)
 		{
-			// stencil test, 2nd pass
-			glStencilFunc(GL_NOTEQUAL, 1, 0xFF); //write to areas where value is not equal to 1
-			glStencilMask(0x00); // disable writing to stencil buffer
-			StencilBalls[i]->Render();// render scaled up shape
-
-			glStencilMask(0x00); // disable writing to stencil mask
-			glDisable(GL_STENCIL_TEST); //disable test
+			for (int y = 0; y < 16; y++)
+			{
+				for (int x = 0; x < 16; x++)
+				{
+					glm::vec3 Position = glm::vec3((x - 7.5f) * 0.8f, (y - 7.5f) * 0.8f, -Layer * 0.5f);
+					Walls->Add(glm::translate(glm::mat4(), Position));
+				}
+			}
+		}
 
-			glStencilMask(0xFF); // enable stencil test for the next time
-		}			
-	}
+		for (size_t c = 0; c < sizeof(LightCounts) / sizeof(LightCounts[0]); c++)
+		{
+			light->ClearPointLights();
+			for (int i = 0; i < LightCounts[c]; i++)
+			{
+				PointLight Extra;
+				Extra.Position = glm::vec3((rand() % 140) / 10.0f - 7.0f, (rand() % 140) / 10.0f - 7.0f, (rand() % 40) / 10.0f - 2.0f);
+				Extra.Color = glm::vec3((rand() % 100) / 100.0f, (rand() % 100) / 100.0f, (rand() % 100) / 100.0f);
+				Extra.AmbientStrength = 0.0f;
+				Extra.LightSpecularStrength = 1.0f;
+				Extra.AttenuationConstant = 1.0f;
+				Extra.AttenuationLinear = 0.7f;
+				Extra.AttenuationExponent = 1.8f;
+				light->AddPointLight(Extra);
+			}
 
-	//disable scissor test
-	glDisable(GL_SCISSOR_TEST);
+			ShadingSample Sample = { LightCounts[c], LayerCounts[l], 0.0f, 0.0f };
+			for (int Mode = 0; Mode < 2; Mode++)
+			{
+				Walls->SetProgram((Mode == 0) ? Program_Instanced : deferred->GetGeometryProgram());
+
+				// the first frame uploads the instances and the lights, it is not measured
+				double Total = 0.0;
+				for (int f = 0; f <= Frames; f++)
+				{
+					ring->BeginFrame();
+					frame->Update(SweepCamera, 0.0f, glm::vec2(renderWidth, renderHeight));
+					light->Bind();
+					clusters->Build(SweepCamera.ViewMat, SweepCamera.ProjectionMat, SweepCamera.NearPlane, SweepCamera.FarPlane,
+						glm::vec2(renderWidth, renderHeight), light->GetPointLights());
+					benchmark->BindTarget();
+					glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+					glBeginQuery(GL_TIME_ELAPSED, Query);
+					if (Mode == 0)
+					{
+						Walls->Render();
+					}
+					else
+					{
+						deferred->BeginGeometryPass();
+						Walls->Render();
+						deferred->EndGeometryPass();
+						deferred->LightingPass(SweepCamera.GetMatrixPV());
+					}
+					glEndQuery(GL_TIME_ELAPSED);
+					ring->EndFrame();
+
+					// waiting here is fine, nothing else is in flight during the sweep
+					GLuint64 Nanoseconds = 0;
+					glGetQueryObjectui64v(Query, GL_QUERY_RESULT, &Nanoseconds);
+					if (f > 0)
+					{
+						Total += Nanoseconds / 1000000.0;
+					}
+				}
+				if (Mode == 0)
+				{
+					Sample.ForwardMs = (float)(Total / Frames);
+				}
+				else
+				{
+					Sample.DeferredMs = (float)(Total / Frames);
+				}
+			}
 
-	// unbind assets (because if not they might cause a lot of errors)
-	glBindVertexArray(0);
-	glUseProgram(0);
+			std::cout << "  " << Sample.Lights << " lights, " << Sample.Layers << " layers: "
+				<< Sample.ForwardMs << " / " << Sample.DeferredMs << std::endl;
+			benchmark->AddShadingSample(Sample);
+		}
+	}
 
-	glfwSwapBuffers(Window);
+	glDeleteQueries(1, &Query);
+	delete Walls;
+	light->ClearPointLights();
+	for (size_t i = 0; i < SceneLights.size(); i++)
+	{
+		light->AddPointLight(SceneLights[i]);
+	}
 }
 
-int main()
+int main(int argc, char** argv)
 {
-	// initializing GLFW and setting the version to 4.6 with only Core functionality available
+	PROFILE_THREAD_NAME("Main");
+
+	if (Benchmark::ParseArguments(argc, argv, benchmarkSettings) == false)
+	{
+		return -1;
+	}
+	ShaderLoader::SetGlobalDefines(benchmarkSettings.ShaderDefines.c_str());
+
+	// initializing GLFW and setting the version to 4.6, benchmark runs ask for 4.5 so software drivers (llvmpipe) can run them
+	// (ShaderLoader compiles the 460 shaders as 450 with ARB_shader_draw_parameters on such a context)
 	glfwInit();
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, benchmarkSettings.Enabled ? 5 : 6);
 
 	// enabling anti-aliasing
 	glfwWindowHint(GLFW_SAMPLES, 4);
 	glEnable(GL_MULTISAMPLE);
+
+	// benchmark runs only need the context, the window stays hidden (also works with a software gl driver)
+	if (benchmarkSettings.Enabled == true)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
 	
 	//create an GLFW controlled context window
 	Window = glfwCreateWindow(800, 800, "First OpenGL Window", NULL, NULL);
@@ -374,7 +952,10 @@ int main()
 	if (Window == NULL)
 	{
 		std::cout << "GLFW failed to initialize properly. Terminating program." << std::endl;
-		system("pause");
+		if (benchmarkSettings.Enabled == false)
+		{
+			system("pause");
+		}
 
 		glfwTerminate();
 		return -1;
@@ -385,7 +966,10 @@ int main()
 	if (glewInit() != GLEW_OK)
 	{
 		std::cout << "GLEW failed to initialize properly. Terminating program." << std::endl;
-		system("pause");
+		if (benchmarkSettings.Enabled == false)
+		{
+			system("pause");
+		}
 
 		glfwTerminate();
 		return -1;
@@ -395,19 +979,79 @@ int main()
 
 	//setup the initial elements of the program
 	InitialSetup();
+	ShaderLoader::PrintStartupReport();
+	if (benchmark != nullptr && benchmarkSettings.ShadingSweep == true)
+	{
+		ShadingSweep();
+	}
+	ShaderProgram::ResetFrameStats();
+
+	// shaders saved while the app runs are rebuilt between frames (not while benchmarking, runs must be repeatable)
+	if (benchmark == nullptr)
+	{
+		shaderWatcher = new ShaderWatcher("Resources/Shaders/");
+	}
+	GLState::ResetFrameStats();
 
 	////main loop
-	while (glfwWindowShouldClose(Window) == false)
+	while (glfwWindowShouldClose(Window) == false && (benchmark == nullptr || benchmark->IsFinished() == false))
 	{
+		PROFILE_SCOPE("Frame");
+		std::chrono::high_resolution_clock::time_point FrameStart = std::chrono::high_resolution_clock::now();
+
+		// recompile the programs of any shader file that changed, on this thread before the frame uses them
+		if (shaderWatcher != nullptr)
+		{
+			std::vector<std::string> ChangedShaders = shaderWatcher->TakeChanges();
+			for (size_t i = 0; i < ChangedShaders.size(); i++)
+			{
+				ShaderLoader::ReloadShader(ChangedShaders[i]);
+			}
+			if (ChangedShaders.empty() == false)
+			{
+				// a new program can get the name of a deleted one, the cached binding is no longer trusted
+				GLState::Invalidate();
+			}
+		}
+
 		//update all objects and run the processes
 		Update();
 
 		//render all the objects
 		Render();
 
+		if (benchmark != nullptr)
+		{
+			bool WasWarmup = benchmark->IsWarmup();
+			benchmark->EndFrame(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - FrameStart).count());
+
+			// the warmup frames are left out of the gpu statistics too
+			if (WasWarmup == true && benchmark->IsWarmup() == false)
+			{
+				gpuProfiler->Flush();
+				gpuProfiler->ResetStats();
+			}
+		}
+	}
+
+	// the last frames are still in flight, the report needs them
+	int ExitCode = 0;
+	if (benchmark != nullptr)
+	{
+		gpuProfiler->Flush();
+		ExitCode = benchmark->WriteReport(gpuProfiler) ? 0 : 1;
+		delete benchmark;
 	}
 
+	// the rolling gpu statistics are kept for comparing runs
+	gpuProfiler->WriteCSV("GPUProfile.csv");
+	PROFILE_EXPORT("CPUTrace.json");
+	delete gpuProfiler;
+	delete shaderWatcher;
+	ShaderLoader::ReleasePrograms();
+	WorkerPool::Shutdown();
+
 	// ensuring correct shutdown of GLFW
 	glfwTerminate();
-	return 0;
+	return ExitCode;
 }